@@ -0,0 +1,33 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "AnimNotifyState_TraversalExitWindow.h"
+#include "TraversalComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+static UTraversalComponent* GetTraversalComponent(const USkeletalMeshComponent* MeshComp)
+{
+	const AActor* Owner = MeshComp ? MeshComp->GetOwner() : nullptr;
+	return Owner ? Owner->FindComponentByClass<UTraversalComponent>() : nullptr;
+}
+
+void UAnimNotifyState_TraversalExitWindow::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference)
+{
+	Super::NotifyBegin(MeshComp, Animation, TotalDuration, EventReference);
+
+	// The notify is shared by every mesh playing the montage, so the open window is kept on the traversal component
+	if (UTraversalComponent* TraversalComponent = GetTraversalComponent(MeshComp))
+	{
+		TraversalComponent->BeginExitWindow(Animation, BlendOutTime);
+	}
+}
+
+void UAnimNotifyState_TraversalExitWindow::NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference)
+{
+	Super::NotifyEnd(MeshComp, Animation, EventReference);
+
+	if (UTraversalComponent* TraversalComponent = GetTraversalComponent(MeshComp))
+	{
+		TraversalComponent->TryExitAction(Animation, false, BlendOutTime);
+	}
+}
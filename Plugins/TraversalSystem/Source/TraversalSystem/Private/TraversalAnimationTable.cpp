@@ -0,0 +1,375 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalAnimationTable.h"
+#include "TraversalDebug.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Unique.h"
+#include "UObject/ObjectSaveContext.h"
+#include "Misc/DataValidation.h"
+
+#if WITH_EDITOR
+#include "Animation/AnimMontage.h"
+#include "AnimNotifyState_MotionWarping.h"
+#include "RootMotionModifier.h"
+#include "AnimNotifyState_TraversalExitWindow.h"
+#endif
+
+#define LOCTEXT_NAMESPACE "TraversalAnimationTable"
+
+#if WITH_EDITOR
+// Samples per second of baked root motion
+static constexpr float BakedRootMotionSampleRate = 30.0f;
+#endif
+
+static bool DoIntervalsOverlap(const FFloatInterval& A, const FFloatInterval& B)
+{
+	// Single values, like the depth of mantles, overlap anything they fall into
+	if (A.Min == A.Max || B.Min == B.Max)
+		return A.Min <= B.Max && B.Min <= A.Max;
+
+	// Adjacent bands are authored sharing an endpoint, like 50-100 and 100-150, and only overlap if they share a range
+	return A.Min < B.Max && B.Min < A.Max;
+}
+
+void UTraversalAnimationTable::PostLoad()
+{
+	Super::PostLoad();
+
+	// Cooked assets were compiled when they were saved. In the editor the entries may have been saved before the lookup existed
+#if WITH_EDITOR
+	Compile();
+#else
+	if (EntryMins.Num() != Entries.Num())
+	{
+		Compile();
+	}
+#endif
+}
+
+void UTraversalAnimationTable::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	Compile();
+
+	TArray<TPair<int32, int32>> Overlaps;
+	FindOverlaps(Overlaps);
+	for (const TPair<int32, int32>& Overlap : Overlaps)
+	{
+		UE_LOG(LogTraversal, Warning, TEXT("%s: Entry %d overlaps entry %d and is never played where they overlap."), *GetName(), Overlap.Value, Overlap.Key);
+	}
+}
+
+void UTraversalAnimationTable::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Baked root motion is only saved into and loaded from cooked packages
+	if (Ar.IsFilterEditorOnly())
+	{
+		Ar << BakedRootMotion;
+	}
+}
+
+#if WITH_EDITOR
+void UTraversalAnimationTable::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+	Super::BeginCacheForCookedPlatformData(TargetPlatform);
+
+	// Baked before the cook saves the table, rather than while it is saved
+	BakeRootMotion();
+}
+
+void UTraversalAnimationTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	Compile();
+}
+
+EDataValidationResult UTraversalAnimationTable::IsDataValid(FDataValidationContext& Context) const
+{
+	EDataValidationResult Result = Super::IsDataValid(Context);
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		const FTraversalAnimationEntry& Entry = Entries[Index];
+
+		if (Entry.Settings.Animation.IsNull())
+		{
+			Context.AddWarning(FText::Format(LOCTEXT("MissingAnimation", "Entry {0} has no animation and is never played."), Index));
+		}
+
+		if (Entry.Settings.AnimationMinHeight > Entry.Settings.AnimationMaxHeight || Entry.Depth.Min > Entry.Depth.Max || Entry.Speed.Min > Entry.Speed.Max || Entry.ApproachAngle.Min > Entry.ApproachAngle.Max)
+		{
+			Context.AddError(FText::Format(LOCTEXT("InvalidRange", "Entry {0} has a min condition above its max."), Index));
+			Result = EDataValidationResult::Invalid;
+		}
+	}
+
+	TArray<TPair<int32, int32>> Overlaps;
+	FindOverlaps(Overlaps);
+	for (const TPair<int32, int32>& Overlap : Overlaps)
+	{
+		Context.AddWarning(FText::Format(LOCTEXT("Overlap", "Entry {0} overlaps entry {1} and is never played where they overlap."), Overlap.Value, Overlap.Key));
+	}
+
+	return Result;
+}
+
+void UTraversalAnimationTable::BakeRootMotion()
+{
+	BakedRootMotion.Reset(Entries.Num());
+
+	for (const FTraversalAnimationEntry& Entry : Entries)
+	{
+		// Entries without root motion stay empty and play their montage
+		FTraversalBakedRootMotion& RootMotion = BakedRootMotion.AddDefaulted_GetRef();
+		const UAnimMontage* Montage = Entry.Settings.Animation.LoadSynchronous();
+		if (!Montage || !Montage->HasRootMotion() || Montage->GetPlayLength() <= 0.0f)
+			continue;
+
+		// Samples are spread evenly over the montage, so the last one is at its end
+		RootMotion.PlayLength = Montage->GetPlayLength();
+		const int32 NumSamples = FMath::CeilToInt32(RootMotion.PlayLength * BakedRootMotionSampleRate) + 1;
+		RootMotion.SampleInterval = RootMotion.PlayLength / (NumSamples - 1);
+		RootMotion.Translations.Reserve(NumSamples);
+		RootMotion.Yaws.Reserve(NumSamples);
+
+		float Yaw = 0.0f;
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+		{
+			const float Time = FMath::Min(Sample * RootMotion.SampleInterval, RootMotion.PlayLength);
+			const FTransform RootTransform = Montage->ExtractRootMotionFromTrackRange(0.0f, Time, FAnimExtractContext());
+			RootMotion.Translations.Add(FVector3f(RootTransform.GetTranslation()));
+
+			Yaw += FMath::FindDeltaAngleDegrees(Yaw, static_cast<float>(RootTransform.Rotator().Yaw));
+			RootMotion.Yaws.Add(Yaw);
+		}
+
+		for (const FAnimNotifyEvent& Notify : Montage->Notifies)
+		{
+			const UAnimNotifyState_MotionWarping* WarpingNotify = Cast<UAnimNotifyState_MotionWarping>(Notify.NotifyStateClass);
+			if (const URootMotionModifier_Warp* Modifier = WarpingNotify ? Cast<URootMotionModifier_Warp>(WarpingNotify->RootMotionModifier) : nullptr)
+			{
+				FTraversalBakedWarpWindow& Window = RootMotion.WarpWindows.AddDefaulted_GetRef();
+				Window.WarpTargetName = Modifier->WarpTargetName;
+				Window.StartTime = Notify.GetTriggerTime();
+				Window.EndTime = Notify.GetEndTriggerTime();
+			}
+			else if (Cast<UAnimNotifyState_TraversalExitWindow>(Notify.NotifyStateClass))
+			{
+				RootMotion.ExitWindowStartTime = Notify.GetTriggerTime();
+				RootMotion.ExitWindowEndTime = Notify.GetEndTriggerTime();
+			}
+		}
+
+		RootMotion.WarpWindows.Sort([](const FTraversalBakedWarpWindow& A, const FTraversalBakedWarpWindow& B)
+			{
+				return A.EndTime < B.EndTime;
+			});
+	}
+}
+#endif
+
+void UTraversalAnimationTable::InitializeFromSettings(const TArray<FAnimationPropertySettings>& Settings)
+{
+	Entries.Reset(Settings.Num());
+	for (const FAnimationPropertySettings& Setting : Settings)
+	{
+		// Settings only select by height
+		FTraversalAnimationEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.Settings = Setting;
+		Entry.Depth = FFloatInterval(0.0f, TNumericLimits<float>::Max());
+		Entry.Speed = FFloatInterval(0.0f, TNumericLimits<float>::Max());
+	}
+
+	Compile();
+}
+
+void UTraversalAnimationTable::Compile()
+{
+	HeightBounds.Reset();
+	BucketStarts.Reset();
+	BucketEntries.Reset();
+	EntryMins.SetNumUninitialized(Entries.Num());
+	EntryMaxs.SetNumUninitialized(Entries.Num());
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		const FTraversalAnimationEntry& Entry = Entries[Index];
+		EntryMins[Index] = FVector4f(Entry.Settings.AnimationMinHeight, Entry.Depth.Min, Entry.Speed.Min, Entry.ApproachAngle.Min);
+		EntryMaxs[Index] = FVector4f(Entry.Settings.AnimationMaxHeight, Entry.Depth.Max, Entry.Speed.Max, Entry.ApproachAngle.Max);
+
+		if (!Entry.Settings.Animation.IsNull())
+		{
+			HeightBounds.Add(Entry.Settings.AnimationMinHeight);
+			HeightBounds.Add(Entry.Settings.AnimationMaxHeight);
+		}
+	}
+
+	if (HeightBounds.IsEmpty())
+		return;
+
+	HeightBounds.Sort();
+	HeightBounds.SetNum(Algo::Unique(HeightBounds));
+
+	// Every animation covers a single height. Use one bucket for it
+	if (HeightBounds.Num() == 1)
+	{
+		HeightBounds.Add(HeightBounds[0]);
+	}
+
+	// Buckets span from one bound to the next, including both bounds, so a height on a bound finds the entries ending there too
+	BucketStarts.Reserve(HeightBounds.Num());
+	BucketStarts.Add(0);
+	for (int32 Bucket = 0; Bucket < HeightBounds.Num() - 1; ++Bucket)
+	{
+		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		{
+			if (!Entries[Index].Settings.Animation.IsNull() && EntryMins[Index].X <= HeightBounds[Bucket + 1] && EntryMaxs[Index].X >= HeightBounds[Bucket])
+			{
+				BucketEntries.Add(Index);
+			}
+		}
+
+		BucketStarts.Add(BucketEntries.Num());
+	}
+}
+
+const FTraversalAnimationEntry* UTraversalAnimationTable::FindEntry(const FTraversalAnimationQuery& Query) const
+{
+	if (HeightBounds.Num() < 2 || Query.Height < HeightBounds[0] || Query.Height > HeightBounds.Last() || EntryMins.Num() != Entries.Num())
+		return nullptr;
+
+	const int32 Bucket = FMath::Min(static_cast<int32>(Algo::UpperBound(HeightBounds, Query.Height)) - 1, HeightBounds.Num() - 2);
+	const FVector4f Key(Query.Height, Query.Depth, Query.Speed, Query.ApproachAngle);
+
+	for (int32 Index = BucketStarts[Bucket]; Index < BucketStarts[Bucket + 1]; ++Index)
+	{
+		const int32 EntryIndex = BucketEntries[Index];
+		const FVector4f& Min = EntryMins[EntryIndex];
+		const FVector4f& Max = EntryMaxs[EntryIndex];
+
+		// Test every condition without branching on each one
+		const bool bMatches = (Key.X >= Min.X) & (Key.Y >= Min.Y) & (Key.Z >= Min.Z) & (Key.W >= Min.W)
+			& (Key.X <= Max.X) & (Key.Y <= Max.Y) & (Key.Z <= Max.Z) & (Key.W <= Max.W);
+
+		if (bMatches)
+			return &Entries[EntryIndex];
+	}
+
+	return nullptr;
+}
+
+FAnimationProperties UTraversalAnimationTable::SelectAnimation(const FTraversalAnimationQuery& Query) const
+{
+	const FTraversalAnimationEntry* Entry = FindEntry(Query);
+	if (!Entry)
+		return FAnimationProperties();
+
+	return MakeAnimationProperties(static_cast<int32>(Entry - Entries.GetData()), Query.Height);
+}
+
+FAnimationProperties UTraversalAnimationTable::MakeAnimationProperties(int32 EntryIndex, float Height) const
+{
+	FAnimationProperties Out;
+
+	if (!Entries.IsValidIndex(EntryIndex))
+		return Out;
+
+	const FAnimationPropertySettings& Settings = Entries[EntryIndex].Settings;
+	Out.Animation = Settings.Animation;
+	Out.EntryIndex = EntryIndex;
+	Out.AnimationHeightOffset = Settings.AnimationHeightOffset;
+	Out.AnimationStartingPosition = FMath::GetMappedRangeValueClamped(FVector2f(Settings.InHeightA, Settings.InHeightB), FVector2f(Settings.StartingPositionA, Settings.StartingPositionB), Height);
+	Out.AnimationEndBlendTime = Settings.AnimationEndBlendTime;
+	return Out;
+}
+
+const FTraversalBakedRootMotion* UTraversalAnimationTable::GetBakedRootMotion(int32 EntryIndex) const
+{
+	return BakedRootMotion.IsValidIndex(EntryIndex) && BakedRootMotion[EntryIndex].IsValid() ? &BakedRootMotion[EntryIndex] : nullptr;
+}
+
+bool UTraversalAnimationTable::HasBakedRootMotion() const
+{
+	if (BakedRootMotion.Num() != Entries.Num())
+		return false;
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		if (!Entries[Index].Settings.Animation.IsNull() && !BakedRootMotion[Index].IsValid())
+			return false;
+	}
+
+	return true;
+}
+
+void UTraversalAnimationTable::GetAnimations(TArray<FSoftObjectPath>& OutPaths) const
+{
+	for (const FTraversalAnimationEntry& Entry : Entries)
+	{
+		if (!Entry.Settings.Animation.IsNull())
+		{
+			OutPaths.AddUnique(Entry.Settings.Animation.ToSoftObjectPath());
+		}
+	}
+}
+
+void UTraversalAnimationTable::FindOverlaps(TArray<TPair<int32, int32>>& OutOverlaps) const
+{
+	for (int32 IndexA = 0; IndexA < Entries.Num(); ++IndexA)
+	{
+		const FTraversalAnimationEntry& A = Entries[IndexA];
+		if (A.Settings.Animation.IsNull())
+			continue;
+
+		const FFloatInterval HeightA(A.Settings.AnimationMinHeight, A.Settings.AnimationMaxHeight);
+
+		for (int32 IndexB = IndexA + 1; IndexB < Entries.Num(); ++IndexB)
+		{
+			const FTraversalAnimationEntry& B = Entries[IndexB];
+			if (B.Settings.Animation.IsNull())
+				continue;
+
+			const FFloatInterval HeightB(B.Settings.AnimationMinHeight, B.Settings.AnimationMaxHeight);
+
+			if (DoIntervalsOverlap(HeightA, HeightB) && DoIntervalsOverlap(A.Depth, B.Depth) && DoIntervalsOverlap(A.Speed, B.Speed) && DoIntervalsOverlap(A.ApproachAngle, B.ApproachAngle))
+			{
+				OutOverlaps.Emplace(IndexA, IndexB);
+			}
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FTraversalBakedWarpWindow& Window)
+{
+	return Ar << Window.WarpTargetName << Window.StartTime << Window.EndTime;
+}
+
+FArchive& operator<<(FArchive& Ar, FTraversalBakedRootMotion& RootMotion)
+{
+	return Ar << RootMotion.SampleInterval << RootMotion.Translations << RootMotion.Yaws << RootMotion.WarpWindows << RootMotion.ExitWindowStartTime << RootMotion.ExitWindowEndTime << RootMotion.PlayLength;
+}
+
+bool FTraversalBakedRootMotion::IsValid() const
+{
+	return SampleInterval > 0.0f && Translations.Num() > 1 && Yaws.Num() == Translations.Num();
+}
+
+FVector3f FTraversalBakedRootMotion::SampleTranslation(float Time) const
+{
+	const float Sample = FMath::Clamp(Time / SampleInterval, 0.0f, static_cast<float>(Translations.Num() - 1));
+	const int32 Index = FMath::Min(FMath::FloorToInt32(Sample), Translations.Num() - 2);
+	return FMath::Lerp(Translations[Index], Translations[Index + 1], Sample - Index);
+}
+
+float FTraversalBakedRootMotion::SampleYaw(float Time) const
+{
+	const float Sample = FMath::Clamp(Time / SampleInterval, 0.0f, static_cast<float>(Yaws.Num() - 1));
+	const int32 Index = FMath::Min(FMath::FloorToInt32(Sample), Yaws.Num() - 2);
+	return FMath::Lerp(Yaws[Index], Yaws[Index + 1], Sample - Index);
+}
+
+#undef LOCTEXT_NAMESPACE
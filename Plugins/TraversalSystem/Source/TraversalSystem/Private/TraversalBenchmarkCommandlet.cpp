@@ -0,0 +1,792 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalBenchmarkCommandlet.h"
+#include "TraversalAnimationTable.h"
+#include "TraversalConfig.h"
+#include "TraversalMovementComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogTraversalBenchmark, Log, All);
+
+// Spacing between the centers of the grid cells.
+static constexpr float CellSize = 800.0f;
+
+// Where fuzz boxes that aren't part of a case are moved to.
+static const FVector FuzzHiddenLocation(0.0f, 0.0f, -100000.0f);
+
+// Margins within which a fuzz case is too close to a threshold to tell whether the check should pass.
+static constexpr double FuzzDistanceTolerance = 5.0;
+static constexpr double FuzzAngleTolerance = 2.0;
+
+// The climbable trace starts behind the character and sweeps a sphere, so reach is less precise than other distances.
+static constexpr double FuzzReachTolerance = 15.0;
+
+// Distance behind the edge of an obstacle where the character steps onto its top.
+static constexpr double FuzzLedgeInset = 15.0;
+
+// Number of wrong checks logged with their case, to reproduce them.
+static constexpr int32 FuzzMaxLoggedCases = 20;
+
+/**
+* Forwards to the allocator it replaces and counts the allocations made on the game thread.
+*/
+class FTraversalCountingMalloc final : public FMalloc
+{
+public:
+	explicit FTraversalCountingMalloc(FMalloc* InInnerMalloc)
+		: InnerMalloc(InInnerMalloc)
+	{
+	}
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->Malloc(Count, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->Realloc(Original, Count, Alignment);
+	}
+
+	virtual void Free(void* Original) override
+	{
+		InnerMalloc->Free(Original);
+	}
+
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+	{
+		return InnerMalloc->GetAllocationSize(Original, SizeOut);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+	{
+		return InnerMalloc->QuantizeSize(Count, Alignment);
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return InnerMalloc->IsInternallyThreadSafe();
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return TEXT("TraversalCountingMalloc");
+	}
+
+	int64 GetNumAllocations() const { return NumAllocations.load(std::memory_order_relaxed); }
+
+	FMalloc* GetInnerMalloc() const { return InnerMalloc; }
+
+private:
+	void CountAllocation()
+	{
+		// Worker threads allocate for unrelated reasons while the checks run
+		if (IsInGameThread())
+		{
+			NumAllocations.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	FMalloc* InnerMalloc;
+	std::atomic<int64> NumAllocations = 0;
+};
+
+static FTraversalCountingMalloc* CountingMalloc = nullptr;
+
+static int64 GetNumAllocations()
+{
+	return CountingMalloc ? CountingMalloc->GetNumAllocations() : 0;
+}
+
+UTraversalBenchmarkCommandlet::UTraversalBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UTraversalBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 NumCharacters = 8;
+	int32 NumIterations = 200;
+	int32 GridSize = 10;
+	int32 Seed = 0;
+	int32 NumCases = 2000;
+	const bool bFuzz = FParse::Param(*Params, TEXT("Fuzz"));
+	FString CharacterClassPath = TEXT("/Game/Blueprints/BP_TraversalCharacter.BP_TraversalCharacter_C");
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Profiling") / (bFuzz ? TEXT("TraversalFuzz.csv") : TEXT("TraversalBenchmark.csv"));
+
+	FParse::Value(*Params, TEXT("Characters="), NumCharacters);
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	FParse::Value(*Params, TEXT("Grid="), GridSize);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Cases="), NumCases);
+	FParse::Value(*Params, TEXT("Character="), CharacterClassPath);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	bWarmCache = FParse::Param(*Params, TEXT("WarmCache"));
+
+	UClass* CharacterClass = LoadClass<ACharacter>(nullptr, *CharacterClassPath);
+	if (!CharacterClass)
+	{
+		UE_LOG(LogTraversalBenchmark, Error, TEXT("Character class %s could not be loaded."), *CharacterClassPath);
+		return 1;
+	}
+
+	// Game world without rendering that only exists for the benchmark
+	const FURL URL;
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("TraversalBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	auto DestroyWorld = [World]()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	};
+
+	FRandomStream Random(Seed);
+	TArray<FObstacle> Obstacles;
+
+	// Fuzz cases spawn their own obstacles and only need one character
+	if (bFuzz)
+	{
+		NumCharacters = 1;
+	}
+	else
+	{
+		SpawnCourse(World, Random, FMath::Max(GridSize, 1), Obstacles);
+	}
+
+	TArray<FObstacle> Ramps = Obstacles.FilterByPredicate([](const FObstacle& Obstacle) { return Obstacle.Type == EObstacleType::Ramp; });
+	Obstacles.RemoveAllSwap([](const FObstacle& Obstacle) { return Obstacle.Type == EObstacleType::Ramp; });
+
+	TArray<UTraversalComponent*> TraversalComponents;
+	for (int32 Index = 0; Index < NumCharacters; ++Index)
+	{
+		ACharacter* Character = World->SpawnActor<ACharacter>(CharacterClass, FTransform(FVector(0.0f, 0.0f, 200.0f)));
+		UTraversalComponent* TraversalComponent = Character ? Character->FindComponentByClass<UTraversalComponent>() : nullptr;
+		if (!TraversalComponent)
+		{
+			UE_LOG(LogTraversalBenchmark, Error, TEXT("%s has no traversal component."), *CharacterClassPath);
+			DestroyWorld();
+			return 1;
+		}
+
+		TraversalComponent->Initialize(Character);
+		TraversalComponents.Add(TraversalComponent);
+	}
+
+	// Let the physics scene and the characters settle
+	for (int32 Frame = 0; Frame < 10; ++Frame)
+	{
+		World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+	}
+
+	TArray<FCheckResults> Results;
+
+	// Count allocations while measuring. The allocator is swapped back before anything else runs
+	CountingMalloc = new FTraversalCountingMalloc(GMalloc);
+	GMalloc = CountingMalloc;
+
+	if (bFuzz)
+	{
+		RunFuzz(World, TraversalComponents[0], Random, FMath::Max(NumCases, 1), Results);
+	}
+	else
+	{
+		Results.SetNum(5);
+		Results[0].Name = TEXT("VaultCheck");
+		Results[1].Name = TEXT("MantleCheck");
+		Results[2].Name = TEXT("EvaluateTraversal");
+		Results[3].Name = TEXT("WallClimbCheck");
+		Results[4].Name = TEXT("SlideUpdate");
+
+		const ETraversalState CheckActions[] = { ETraversalState::Vaulting, ETraversalState::Mantling, ETraversalState::None, ETraversalState::WallClimbing };
+
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (UTraversalComponent* TraversalComponent : TraversalComponents)
+			{
+				ACharacter* Character = TraversalComponent->PlayerCharacter;
+
+				if (!Obstacles.IsEmpty())
+				{
+					const FObstacle& Obstacle = Obstacles[Random.RandHelper(Obstacles.Num())];
+					for (int32 CheckIndex = 0; CheckIndex < static_cast<int32>(UE_ARRAY_COUNT(CheckActions)); ++CheckIndex)
+					{
+						PlaceCharacter(Character, Obstacle, Random);
+						Results[CheckIndex].Samples.Add(MeasureCheck(TraversalComponent, CheckActions[CheckIndex]));
+					}
+				}
+
+				if (!Ramps.IsEmpty())
+				{
+					PlaceCharacter(Character, Ramps[Random.RandHelper(Ramps.Num())], Random);
+					Results[4].Samples.Add(MeasureSlideUpdate(TraversalComponent));
+				}
+			}
+		}
+	}
+
+	// Steady-state checks must not allocate
+	bool bNoAllocations = true;
+	if (!bFuzz && !Obstacles.IsEmpty())
+	{
+		for (UTraversalComponent* TraversalComponent : TraversalComponents)
+		{
+			PlaceCharacter(TraversalComponent->PlayerCharacter, Obstacles[Random.RandHelper(Obstacles.Num())], Random);
+			bNoAllocations &= CheckSteadyStateAllocations(TraversalComponent);
+		}
+	}
+
+	GMalloc = CountingMalloc->GetInnerMalloc();
+
+	const bool bWritten = WriteReport(OutputPath, Results);
+	DestroyWorld();
+
+	// Other threads may still be inside the proxy, so it is never deleted
+	return bWritten && bNoAllocations ? 0 : 1;
+}
+
+AStaticMeshActor* UTraversalBenchmarkCommandlet::SpawnBox(UWorld* World, const FVector& Center, const FRotator& Rotation, const FVector& Size) const
+{
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+
+	AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Center, Rotation);
+	UStaticMeshComponent* MeshComponent = Box->GetStaticMeshComponent();
+	MeshComponent->SetMobility(EComponentMobility::Movable);
+	MeshComponent->SetStaticMesh(CubeMesh);
+	MeshComponent->SetWorldScale3D(Size / 100.0f);
+	MeshComponent->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	return Box;
+}
+
+void UTraversalBenchmarkCommandlet::MoveBox(AStaticMeshActor* Box, const FVector& Center, const FRotator& Rotation, const FVector& Size) const
+{
+	UStaticMeshComponent* MeshComponent = Box->GetStaticMeshComponent();
+	MeshComponent->SetWorldScale3D(Size / 100.0f);
+	MeshComponent->SetWorldLocationAndRotation(Center, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void UTraversalBenchmarkCommandlet::SpawnCourse(UWorld* World, FRandomStream& Random, int32 GridSize, TArray<FObstacle>& OutObstacles) const
+{
+	// Floor with its top at Z 0
+	const float CourseSize = GridSize * CellSize;
+	SpawnBox(World, FVector(CourseSize * 0.5f, CourseSize * 0.5f, -50.0f), FRotator::ZeroRotator, FVector(CourseSize + CellSize, CourseSize + CellSize, 100.0f));
+
+	for (int32 X = 0; X < GridSize; ++X)
+	{
+		for (int32 Y = 0; Y < GridSize; ++Y)
+		{
+			const FVector CellCenter((X + 0.5f) * CellSize, (Y + 0.5f) * CellSize, 0.0f);
+			const FRotator Rotation(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f);
+
+			FObstacle& Obstacle = OutObstacles.AddDefaulted_GetRef();
+			Obstacle.Type = static_cast<EObstacleType>(Random.RandHelper(4));
+			Obstacle.Facing = Rotation.Vector();
+
+			// Depth along the approach direction, width and height of the obstacle
+			FVector Size;
+			switch (Obstacle.Type)
+			{
+			case EObstacleType::Box:
+				Size = FVector(Random.FRandRange(20.0f, 150.0f), Random.FRandRange(150.0f, 300.0f), Random.FRandRange(40.0f, 120.0f));
+				break;
+			case EObstacleType::Ledge:
+				Size = FVector(Random.FRandRange(150.0f, 400.0f), Random.FRandRange(150.0f, 400.0f), Random.FRandRange(80.0f, 250.0f));
+				break;
+			case EObstacleType::Wall:
+				Size = FVector(50.0f, Random.FRandRange(300.0f, 500.0f), Random.FRandRange(400.0f, 700.0f));
+				break;
+			case EObstacleType::Ramp:
+			{
+				// Tilted slab the characters slide down
+				const float Length = 600.0f;
+				const float Pitch = Random.FRandRange(10.0f, 25.0f);
+				const float Rise = Length * FMath::Sin(FMath::DegreesToRadians(Pitch));
+				const FRotator RampRotation(Pitch, Rotation.Yaw, 0.0f);
+				SpawnBox(World, CellCenter + FVector(0.0f, 0.0f, Rise * 0.5f), RampRotation, FVector(Length, 300.0f, 20.0f));
+				Obstacle.Front = CellCenter + Obstacle.Facing * (Length * 0.25f) + FVector(0.0f, 0.0f, Rise * 0.75f + 10.0f);
+				continue;
+			}
+			}
+
+			SpawnBox(World, CellCenter + FVector(0.0f, 0.0f, Size.Z * 0.5f), Rotation, Size);
+			Obstacle.Front = CellCenter - Obstacle.Facing * (Size.X * 0.5f);
+		}
+	}
+}
+
+void UTraversalBenchmarkCommandlet::PrepareCharacter(ACharacter* Character, const FVector& Location, const FVector& Facing) const
+{
+	UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+	UCharacterMovementComponent* CharacterMovement = Character->GetCharacterMovement();
+
+	Character->SetActorLocationAndRotation(Location, Facing.Rotation(), false, nullptr, ETeleportType::TeleportPhysics);
+
+	CharacterMovement->SetMovementMode(MOVE_Walking);
+	CharacterMovement->Velocity = Facing * CharacterMovement->MaxWalkSpeed;
+	CharacterMovement->FindFloor(Capsule->GetComponentLocation(), CharacterMovement->CurrentFloor, false);
+
+	// Checks read the movement input of the last update
+	Character->AddMovementInput(Facing, 1.0f, true);
+	Character->ConsumeMovementInputVector();
+}
+
+void UTraversalBenchmarkCommandlet::PlaceCharacter(ACharacter* Character, const FObstacle& Obstacle, FRandomStream& Random) const
+{
+	UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+	const float HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+
+	FVector Facing = Obstacle.Facing;
+	FVector Location;
+
+	if (Obstacle.Type == EObstacleType::Ramp)
+	{
+		// Stand on the ramp facing downhill. Facing points uphill, towards the high end
+		Facing = -Facing;
+		Location = Obstacle.Front + FVector(0.0f, 0.0f, HalfHeight);
+	}
+	else
+	{
+		// Approach from a random distance and angle
+		Facing = Facing.RotateAngleAxis(Random.FRandRange(-30.0f, 30.0f), FVector::UpVector);
+		Location = Obstacle.Front - Facing * (Capsule->GetScaledCapsuleRadius() + Random.FRandRange(10.0f, 120.0f)) + FVector(0.0f, 0.0f, HalfHeight + 1.0f);
+	}
+
+	PrepareCharacter(Character, Location, Facing);
+}
+
+UTraversalBenchmarkCommandlet::FSample UTraversalBenchmarkCommandlet::MeasureCheck(UTraversalComponent* TraversalComponent, ETraversalState Action) const
+{
+	if (!bWarmCache)
+	{
+		TraversalComponent->InvalidateCheckCache();
+	}
+
+	FSample Sample;
+	const int64 StartAllocations = GetNumAllocations();
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	FTraversalCheck Check = TraversalComponent->BeginCheck(Action);
+	Sample.bSucceeded = TraversalComponent->RunCheck(Check);
+
+	Sample.Time = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	Sample.NumAllocations = GetNumAllocations() - StartAllocations;
+	Sample.NumTraces = Check.NumTraces;
+	return Sample;
+}
+
+bool UTraversalBenchmarkCommandlet::CheckSteadyStateAllocations(UTraversalComponent* TraversalComponent) const
+{
+	const ETraversalState CheckActions[] = { ETraversalState::Vaulting, ETraversalState::Mantling, ETraversalState::None, ETraversalState::WallClimbing };
+	const TCHAR* CheckNames[] = { TEXT("VaultCheck"), TEXT("MantleCheck"), TEXT("EvaluateTraversal"), TEXT("WallClimbCheck") };
+
+	bool bNoAllocations = true;
+	for (int32 CheckIndex = 0; CheckIndex < static_cast<int32>(UE_ARRAY_COUNT(CheckActions)); ++CheckIndex)
+	{
+		int64 NumAllocations = 0;
+		for (int32 Run = 0; Run < 2; ++Run)
+		{
+			// Both runs trace, so the second one goes through the same path as the first
+			TraversalComponent->InvalidateCheckCache();
+
+			const int64 StartAllocations = GetNumAllocations();
+			FTraversalCheck Check = TraversalComponent->BeginCheck(CheckActions[CheckIndex]);
+			TraversalComponent->RunCheck(Check);
+			NumAllocations = GetNumAllocations() - StartAllocations;
+		}
+
+		if (NumAllocations > 0)
+		{
+			UE_LOG(LogTraversalBenchmark, Error, TEXT("%s allocated %lld times in steady state."), CheckNames[CheckIndex], NumAllocations);
+			bNoAllocations = false;
+		}
+	}
+
+	return bNoAllocations;
+}
+
+UTraversalBenchmarkCommandlet::FSample UTraversalBenchmarkCommandlet::MeasureSlideUpdate(UTraversalComponent* TraversalComponent) const
+{
+	TraversalComponent->SlideStart();
+
+	FSample Sample;
+	const int64 StartAllocations = GetNumAllocations();
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	// The traversal movement component slides in its movement update, and the component doesn't tick
+	UTraversalMovementComponent* TraversalMovement = TraversalComponent->TraversalMovement;
+	if (TraversalMovement)
+	{
+		TraversalMovement->PhysSlide(1.0f / 60.0f, 0);
+	}
+	else
+	{
+		TraversalComponent->SlideUpdate();
+	}
+
+	Sample.Time = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	Sample.NumAllocations = GetNumAllocations() - StartAllocations;
+	Sample.bSucceeded = TraversalMovement ? TraversalMovement->GetTraversalMode() == ETraversalState::Sliding : TraversalComponent->TraversalState == ETraversalState::Sliding;
+
+	if (Sample.bSucceeded || TraversalComponent->TraversalState == ETraversalState::Sliding)
+	{
+		TraversalComponent->SlideStop();
+	}
+
+	return Sample;
+}
+
+void UTraversalBenchmarkCommandlet::RunFuzz(UWorld* World, UTraversalComponent* TraversalComponent, FRandomStream& Random, int32 NumCases, TArray<FCheckResults>& OutResults) const
+{
+	ACharacter* Character = TraversalComponent->PlayerCharacter;
+	const float HalfHeight = TraversalComponent->PlayerCapsule->GetScaledCapsuleHalfHeight();
+
+	// Floor with its top at Z 0. The obstacle and the wall behind it are moved into place for every case
+	const AStaticMeshActor* Floor = SpawnBox(World, FVector(0.0f, 0.0f, -50.0f), FRotator::ZeroRotator, FVector(4000.0f, 4000.0f, 100.0f));
+	AStaticMeshActor* Obstacle = SpawnBox(World, FuzzHiddenLocation, FRotator::ZeroRotator, FVector(100.0f));
+	AStaticMeshActor* Wall = SpawnBox(World, FuzzHiddenLocation, FRotator::ZeroRotator, FVector(100.0f));
+
+	const ETraversalState CheckActions[] = { ETraversalState::Vaulting, ETraversalState::Mantling, ETraversalState::WallClimbing };
+	OutResults.SetNum(UE_ARRAY_COUNT(CheckActions));
+	OutResults[0].Name = TEXT("VaultCheck");
+	OutResults[1].Name = TEXT("MantleCheck");
+	OutResults[2].Name = TEXT("WallClimbCheck");
+
+	int32 NumLogged = 0;
+
+	for (int32 CaseIndex = 0; CaseIndex < NumCases; ++CaseIndex)
+	{
+		for (int32 CheckIndex = 0; CheckIndex < static_cast<int32>(UE_ARRAY_COUNT(CheckActions)); ++CheckIndex)
+		{
+			const ETraversalState Action = CheckActions[CheckIndex];
+			const FFuzzCase Case = MakeFuzzCase(TraversalComponent, Action, Random);
+			const bool bHasWall = Case.LandingRoom >= 0.0f;
+
+			MoveBox(Obstacle, FVector(Case.Distance + Case.Depth * 0.5f, Case.Lateral, Case.Height * 0.5f), FRotator(0.0f, 0.0f, Case.Slope), FVector(Case.Depth, Case.Width, Case.Height));
+
+			const FVector WallSize(50.0f, Case.Width + 400.0f, Case.Height + 400.0f);
+			const FVector WallCenter(Case.Distance + Case.Depth + Case.LandingRoom + WallSize.X * 0.5f, Case.Lateral, WallSize.Z * 0.5f);
+			MoveBox(Wall, bHasWall ? WallCenter : FuzzHiddenLocation, FRotator::ZeroRotator, WallSize);
+
+			PrepareCharacter(Character, FVector(0.0f, 0.0f, HalfHeight + 1.0f), FRotator(0.0f, Case.ApproachAngle, 0.0f).Vector());
+
+			// The boxes moved since the last check, so a warm cache would hold results for another case
+			TraversalComponent->InvalidateCheckCache();
+			const FSample Sample = MeasureCheck(TraversalComponent, Action);
+
+			TArray<FTransform, TInlineAllocator<2>> Surroundings;
+			Surroundings.Add(Floor->GetStaticMeshComponent()->GetComponentTransform());
+			if (bHasWall)
+			{
+				Surroundings.Add(Wall->GetStaticMeshComponent()->GetComponentTransform());
+			}
+
+			const FFuzzTruth Truth = EvaluateFuzzCase(TraversalComponent, Action, Case, Obstacle->GetStaticMeshComponent()->GetComponentTransform(), Surroundings);
+
+			FCheckResults& Result = OutResults[CheckIndex];
+			Result.Samples.Add(Sample);
+
+			if (Truth.IsAmbiguous())
+			{
+				++Result.NumAmbiguous;
+				continue;
+			}
+
+			if (Sample.bSucceeded == Truth.ShouldPass())
+				continue;
+
+			++(Sample.bSucceeded ? Result.NumFalsePositives : Result.NumFalseNegatives);
+
+			if (NumLogged++ < FuzzMaxLoggedCases)
+			{
+				UE_LOG(LogTraversalBenchmark, Warning, TEXT("%s %s: height %.1f depth %.1f width %.1f lateral %.1f distance %.1f angle %.1f slope %.1f landing room %.1f"),
+					*Result.Name, Sample.bSucceeded ? TEXT("false positive") : TEXT("false negative"),
+					Case.Height, Case.Depth, Case.Width, Case.Lateral, Case.Distance, Case.ApproachAngle, Case.Slope, Case.LandingRoom);
+			}
+		}
+	}
+}
+
+UTraversalBenchmarkCommandlet::FFuzzCase UTraversalBenchmarkCommandlet::MakeFuzzCase(const UTraversalComponent* TraversalComponent, ETraversalState Action, FRandomStream& Random) const
+{
+	const UTraversalConfig* Config = TraversalComponent->GetConfig();
+	const float Radius = TraversalComponent->PlayerCapsule->GetScaledCapsuleRadius();
+	const float HalfHeight = TraversalComponent->PlayerCapsule->GetScaledCapsuleHalfHeight();
+
+	// Land on either side of one of two thresholds
+	auto Around = [&Random](float ThresholdA, float ThresholdB, float Spread)
+	{
+		return (Random.FRand() < 0.5f ? ThresholdA : ThresholdB) + Random.FRandRange(-Spread, Spread);
+	};
+
+	// Ledge heights are measured from the bottom of the capsule, which stands 1 unit above the floor
+	auto ToObstacleHeight = [Config](float LedgeHeight)
+	{
+		return FMath::Max(LedgeHeight - Config->GlobalHeightOffsetZ + 1.0f, 5.0f);
+	};
+
+	FFuzzCase Case;
+	Case.Width = Random.FRandRange(200.0f, 400.0f);
+	Case.ApproachAngle = Random.FRandRange(-60.0f, 60.0f);
+	Case.Slope = Random.FRand() < 0.3f ? Random.FRandRange(0.0f, 60.0f) : 0.0f;
+
+	switch (Action)
+	{
+	case ETraversalState::Vaulting:
+		Case.Height = ToObstacleHeight(Around(Config->VaultMinLedgeHeight, Config->VaultMaxLedgeHeight, 30.0f));
+		Case.Depth = Random.FRand() < 0.75f ? Around(Config->VaultMinDepth, Config->VaultMaxDepth, 30.0f) : Random.FRandRange(5.0f, Config->VaultMaxDepth * 2.0f);
+		Case.Distance = Radius + Random.FRandRange(0.0f, Config->VaultReachDistance + 40.0f);
+		Case.LandingRoom = Random.FRand() < 0.5f ? Random.FRandRange(0.0f, 2.0f * (Config->VaultLandDistance + 2.0f * Radius)) : -1.0f;
+		break;
+	case ETraversalState::Mantling:
+		Case.Height = ToObstacleHeight(Around(Config->MantleMinLedgeHeight, Config->MantleMaxLedgeHeight, 30.0f));
+		Case.Depth = Random.FRandRange(5.0f, 300.0f);
+		Case.Distance = Radius + Random.FRandRange(0.0f, Config->MantleReachDistance + 40.0f);
+		Case.LandingRoom = Random.FRand() < 0.5f ? Random.FRandRange(0.0f, 3.0f * Radius) : -1.0f;
+		break;
+	default:
+	{
+		// Walls around the size the room traces need, with the character near their edges
+		const float TraceDistance = Config->DirectionalTraceDistance;
+		Case.Height = FMath::Max(HalfHeight + 1.0f + TraceDistance + Random.FRandRange(-60.0f, 60.0f), 5.0f);
+		Case.Width = FMath::Max(2.0f * TraceDistance + Random.FRandRange(-60.0f, 60.0f), 5.0f);
+		Case.Lateral = Random.FRandRange(-60.0f, 60.0f);
+		Case.Depth = Random.FRandRange(20.0f, 200.0f);
+		Case.Distance = Radius + Random.FRandRange(0.0f, Config->WallDetectionDistance + 40.0f);
+		break;
+	}
+	}
+
+	Case.Depth = FMath::Max(Case.Depth, 5.0f);
+	return Case;
+}
+
+// Intersect a segment with a box spawned from the engine cube, grown by Inflate on every side. Negative values shrink it.
+static bool IntersectSegmentBox(const FTransform& Box, const FVector& Start, const FVector& End, double Inflate, double& OutTime)
+{
+	const FVector Scale = Box.GetScale3D();
+	const FVector LocalStart = Box.InverseTransformPosition(Start);
+	const FVector LocalDelta = Box.InverseTransformPosition(End) - LocalStart;
+
+	double EnterTime = 0.0;
+	double ExitTime = 1.0;
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const double Extent = 50.0 + Inflate / FMath::Max(FMath::Abs(Scale[Axis]), UE_SMALL_NUMBER);
+		if (Extent <= 0.0)
+			return false;
+
+		if (FMath::IsNearlyZero(LocalDelta[Axis]))
+		{
+			if (FMath::Abs(LocalStart[Axis]) > Extent)
+				return false;
+
+			continue;
+		}
+
+		double Time0 = (-Extent - LocalStart[Axis]) / LocalDelta[Axis];
+		double Time1 = (Extent - LocalStart[Axis]) / LocalDelta[Axis];
+		if (Time0 > Time1)
+		{
+			Swap(Time0, Time1);
+		}
+
+		EnterTime = FMath::Max(EnterTime, Time0);
+		ExitTime = FMath::Min(ExitTime, Time1);
+		if (EnterTime > ExitTime)
+			return false;
+	}
+
+	OutTime = EnterTime;
+	return true;
+}
+
+static bool DoesSegmentHitAnyBox(TConstArrayView<FTransform> Boxes, const FVector& Start, const FVector& End, double Inflate)
+{
+	double Time;
+	return Boxes.ContainsByPredicate([&](const FTransform& Box) { return IntersectSegmentBox(Box, Start, End, Inflate, Time); });
+}
+
+UTraversalBenchmarkCommandlet::FFuzzTruth UTraversalBenchmarkCommandlet::EvaluateFuzzCase(const UTraversalComponent* TraversalComponent, ETraversalState Action, const FFuzzCase& Case, const FTransform& Obstacle, TConstArrayView<FTransform> Surroundings) const
+{
+	const UTraversalConfig* Config = TraversalComponent->GetConfig();
+	const UCapsuleComponent* Capsule = TraversalComponent->PlayerCapsule;
+	const float Radius = Capsule->GetScaledCapsuleRadius();
+	const FVector Center = Capsule->GetComponentLocation();
+	const FVector Forward = TraversalComponent->PlayerCharacter->GetActorForwardVector();
+	const double BaseZ = Center.Z - Capsule->GetScaledCapsuleHalfHeight();
+
+	FFuzzTruth Truth;
+
+	if (Action == ETraversalState::WallClimbing)
+	{
+		TArray<FTransform, TInlineAllocator<3>> Boxes;
+		Boxes.Append(Surroundings.GetData(), Surroundings.Num());
+		Boxes.Add(Obstacle);
+
+		// There is wall in front of the character's center and of every side of it
+		const float TraceDistance = Config->DirectionalTraceDistance;
+		const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+		const FVector Offsets[] = { FVector::ZeroVector, FVector::UpVector * TraceDistance, FVector::UpVector * -TraceDistance, Right * TraceDistance, Right * -TraceDistance };
+
+		for (const FVector& Offset : Offsets)
+		{
+			const FVector Start = Center + Offset;
+			const FVector End = Start + Forward * Config->WallDetectionDistance;
+			Truth.RequireTest(DoesSegmentHitAnyBox(Boxes, Start, End, -FuzzDistanceTolerance), DoesSegmentHitAnyBox(Boxes, Start, End, FuzzDistanceTolerance));
+		}
+
+		return Truth;
+	}
+
+	const bool bIsVault = Action == ETraversalState::Vaulting;
+	const double Cos = FMath::Cos(FMath::DegreesToRadians(Case.ApproachAngle));
+	const double FaceDistance = Case.Distance / Cos;
+
+	// The face is within reach along the character's facing
+	Truth.Require((bIsVault ? Config->VaultReachDistance : Config->MantleReachDistance) - FaceDistance, FuzzReachTolerance);
+
+	// Same rule as IsApproachAngleVaultable, which maps the cosine of the approach angle to 0 to 90
+	if (bIsVault)
+	{
+		Truth.Require(FMath::Abs(Cos) * 90.0 - Config->VaultMaxApproachAngle, FuzzAngleTolerance);
+	}
+
+	// Top of the obstacle where the character steps onto it
+	const FVector StepPoint = Center + Forward * (FaceDistance + FuzzLedgeInset);
+	double TopTime;
+	if (!IntersectSegmentBox(Obstacle, FVector(StepPoint.X, StepPoint.Y, 100000.0), FVector(StepPoint.X, StepPoint.Y, -100000.0), 0.0, TopTime))
+	{
+		Truth.RequireTest(false, false);
+		return Truth;
+	}
+
+	const double TopZ = FMath::Lerp(100000.0, -100000.0, TopTime);
+	const float LedgeHeight = static_cast<float>(TopZ - BaseZ + Config->GlobalHeightOffsetZ);
+	Truth.Require(LedgeHeight - (bIsVault ? Config->VaultMinLedgeHeight : Config->MantleMinLedgeHeight), FuzzDistanceTolerance);
+	Truth.Require((bIsVault ? Config->VaultMaxLedgeHeight : Config->MantleMaxLedgeHeight) - LedgeHeight, FuzzDistanceTolerance);
+
+	// The top can be stood on
+	const double MaxSlope = FMath::RadiansToDegrees(FMath::Acos(TraversalComponent->PlayerCharacterMovement->GetWalkableFloorZ()));
+	Truth.Require(MaxSlope - Case.Slope, FuzzAngleTolerance);
+
+	const float Depth = static_cast<float>(Case.Depth / Cos);
+	if (bIsVault)
+	{
+		// Depth crossed along the character's facing
+		Truth.Require(Depth - Config->VaultMinDepth, FuzzDistanceTolerance);
+		Truth.Require(Config->VaultMaxDepth - Depth, FuzzDistanceTolerance);
+
+		// Room for the capsule where it lands behind the obstacle
+		if (Case.LandingRoom >= 0.0f)
+		{
+			Truth.Require(Case.LandingRoom / Cos - (Config->VaultLandDistance + 2.0f * Radius), FuzzDistanceTolerance);
+		}
+	}
+	else if (Case.LandingRoom >= 0.0f)
+	{
+		// Room for the capsule standing on the top
+		Truth.Require(Case.Depth + Case.LandingRoom - (FuzzLedgeInset * Cos + Radius), FuzzDistanceTolerance);
+	}
+
+	// An animation is played for the ledge
+	const UTraversalAnimationTable* AnimationTable = Config->GetAnimations(Action);
+	FTraversalAnimationQuery Query;
+	Query.Height = LedgeHeight;
+	Query.Depth = bIsVault ? Depth : 0.0f;
+	Query.Speed = TraversalComponent->PlayerCharacterMovement->MaxWalkSpeed;
+	Query.ApproachAngle = FMath::Abs(Case.ApproachAngle);
+
+	const bool bHasAnimation = AnimationTable && AnimationTable->FindEntry(Query);
+	Truth.RequireTest(bHasAnimation, bHasAnimation);
+	return Truth;
+}
+
+bool UTraversalBenchmarkCommandlet::WriteReport(const FString& Path, const TArray<FCheckResults>& Results) const
+{
+	const bool bJson = Path.EndsWith(TEXT(".json"));
+
+	FString Report = bJson ? TEXT("[\n") : TEXT("Check,Samples,SuccessRate,MeanUs,P50Us,P99Us,MeanTraces,MeanAllocations,FalsePositives,FalseNegatives,Ambiguous\n");
+
+	for (int32 ResultIndex = 0; ResultIndex < Results.Num(); ++ResultIndex)
+	{
+		const FCheckResults& Result = Results[ResultIndex];
+		const int32 NumSamples = Result.Samples.Num();
+
+		TArray<double> Times;
+		Times.Reserve(NumSamples);
+		double TotalTime = 0.0;
+		int64 TotalTraces = 0;
+		int64 TotalAllocations = 0;
+		int32 NumSucceeded = 0;
+
+		for (const FSample& Sample : Result.Samples)
+		{
+			Times.Add(Sample.Time * 1000000.0);
+			TotalTime += Sample.Time * 1000000.0;
+			TotalTraces += Sample.NumTraces;
+			TotalAllocations += Sample.NumAllocations;
+			NumSucceeded += Sample.bSucceeded ? 1 : 0;
+		}
+
+		Times.Sort();
+
+		auto Percentile = [&Times](double Ratio)
+		{
+			return Times.IsEmpty() ? 0.0 : Times[FMath::Clamp(FMath::CeilToInt32(Ratio * Times.Num()) - 1, 0, Times.Num() - 1)];
+		};
+
+		const double Divisor = FMath::Max(NumSamples, 1);
+		const double SuccessRate = NumSucceeded / Divisor;
+		const double MeanTime = TotalTime / Divisor;
+		const double MeanTraces = TotalTraces / Divisor;
+		const double MeanAllocations = TotalAllocations / Divisor;
+
+		UE_LOG(LogTraversalBenchmark, Display, TEXT("%-18s samples %6d  success %5.1f%%  mean %8.2fus  p50 %8.2fus  p99 %8.2fus  traces %5.2f  allocations %6.2f  false positives %d  false negatives %d  ambiguous %d"),
+			*Result.Name, NumSamples, SuccessRate * 100.0, MeanTime, Percentile(0.5), Percentile(0.99), MeanTraces, MeanAllocations, Result.NumFalsePositives, Result.NumFalseNegatives, Result.NumAmbiguous);
+
+		if (bJson)
+		{
+			Report += FString::Printf(TEXT("  { \"check\": \"%s\", \"samples\": %d, \"successRate\": %.4f, \"meanUs\": %.3f, \"p50Us\": %.3f, \"p99Us\": %.3f, \"meanTraces\": %.3f, \"meanAllocations\": %.3f, \"falsePositives\": %d, \"falseNegatives\": %d, \"ambiguous\": %d }%s\n"),
+				*Result.Name, NumSamples, SuccessRate, MeanTime, Percentile(0.5), Percentile(0.99), MeanTraces, MeanAllocations, Result.NumFalsePositives, Result.NumFalseNegatives, Result.NumAmbiguous, ResultIndex + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+		}
+		else
+		{
+			Report += FString::Printf(TEXT("%s,%d,%.4f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%d\n"),
+				*Result.Name, NumSamples, SuccessRate, MeanTime, Percentile(0.5), Percentile(0.99), MeanTraces, MeanAllocations, Result.NumFalsePositives, Result.NumFalseNegatives, Result.NumAmbiguous);
+		}
+	}
+
+	if (bJson)
+	{
+		Report += TEXT("]\n");
+	}
+
+	if (!FFileHelper::SaveStringToFile(Report, *Path))
+	{
+		UE_LOG(LogTraversalBenchmark, Error, TEXT("Failed to write %s."), *Path);
+		return false;
+	}
+
+	UE_LOG(LogTraversalBenchmark, Display, TEXT("Wrote %s."), *Path);
+	return true;
+}
@@ -0,0 +1,391 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalCapture.h"
+#include "TraversalDebug.h"
+#include "TraversalConfig.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/Queue.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/UnrealType.h"
+#include <atomic>
+
+namespace TraversalCapture
+{
+	// "TRCP"
+	static constexpr uint32 FileMagic = 0x50435254;
+	static constexpr int32 FileVersion = 3;
+
+	// Checks advance through far fewer stages. Larger step counts are read from corrupt files
+	static constexpr int32 MaxSteps = 64;
+
+	// Kind of block following the header.
+	enum class EBlock : uint8
+	{
+		Tuning,
+		Check
+	};
+
+	static std::atomic<bool> bCapturing = false;
+
+	// Checks finish on worker threads when they are batched, while the physics scene is locked for reading.
+	// Each one is serialized to memory by the thread that finished it and written to the file by the game thread at the end of the frame
+	static TQueue<TArray<uint8>, EQueueMode::Mpsc> PendingChecks;
+
+	// Only used on the game thread
+	static TUniquePtr<FArchive> Writer;
+	static FString WriterPath;
+	static int32 NumChecks = 0;
+	static FDelegateHandle EndFrameHandle;
+
+	// Tunings written so far, and the tuning of every component that began a check
+	static TArray<FTraversalCaptureTuning> Tunings;
+	static TMap<TObjectKey<UTraversalComponent>, int32> ComponentTunings;
+
+	static void SerializePose(FArchive& Ar, FTraversalPose& Pose)
+	{
+		Ar << Pose.Location << Pose.Rotation << Pose.ForwardVector << Pose.RightVector << Pose.UpVector;
+		Ar << Pose.MovementInput << Pose.Velocity << Pose.CapsuleBaseLocation;
+		Ar << Pose.CapsuleRadius << Pose.CapsuleHalfHeight;
+	}
+
+	static void SerializeQuery(FArchive& Ar, FTraversalTraceQuery& Query)
+	{
+		Ar << Query.Shape << Query.Start << Query.End << Query.Radius << Query.HalfHeight;
+	}
+
+	static void SerializeHit(FArchive& Ar, FHitResult& Hit)
+	{
+		// Only the fields the check stages read. The hit component isn't captured
+		uint8 Flags = (Hit.bBlockingHit ? 1 : 0) | (Hit.bStartPenetrating ? 2 : 0);
+		Ar << Flags;
+		Hit.bBlockingHit = (Flags & 1) != 0;
+		Hit.bStartPenetrating = (Flags & 2) != 0;
+
+		Ar << Hit.Time << Hit.Distance << Hit.PenetrationDepth;
+		Ar << Hit.Location << Hit.ImpactPoint << Hit.Normal << Hit.ImpactNormal << Hit.TraceStart << Hit.TraceEnd;
+	}
+
+	static void SerializeLedge(FArchive& Ar, FTraversalLedge& Ledge)
+	{
+		Ar << Ledge.Start << Ledge.End << Ledge.Normal << Ledge.Depth << Ledge.Height << Ledge.LandZ << Ledge.bHasLandingRoom;
+	}
+
+	static void SerializePlan(FArchive& Ar, FTraversalPlan& Plan)
+	{
+		Ar << Plan.Action << Plan.ObjectStartWarpTarget << Plan.ObjectEndWarpTarget << Plan.LandWarpTarget;
+		Ar << Plan.Height << Plan.Depth << Plan.ApproachAngle << Plan.AnimationProperties.EntryIndex;
+	}
+
+	static void SerializeCheck(FArchive& Ar, FTraversalCheckCapture& Capture)
+	{
+		Ar << Capture.Tuning << Capture.LOD << Capture.WalkableFloorZ << Capture.Time;
+
+		FTraversalCheck& Check = Capture.InitialCheck;
+		uint8 Flags = (Check.bIsUnified ? 1 : 0) | (Check.bCanVault ? 2 : 0) | (Check.bCanMantle ? 4 : 0) | (Check.bIsLookAhead ? 8 : 0);
+		Ar << Check.Action << Check.Stage << Flags;
+		Check.bIsUnified = (Flags & 1) != 0;
+		Check.bCanVault = (Flags & 2) != 0;
+		Check.bCanMantle = (Flags & 4) != 0;
+		Check.bIsLookAhead = (Flags & 8) != 0;
+		Check.Plan.Action = Check.Action;
+		SerializePose(Ar, Check.Pose);
+
+		int32 NumSteps = Capture.Steps.Num();
+		Ar << NumSteps;
+		if (Ar.IsLoading())
+		{
+			if (NumSteps < 0 || NumSteps > MaxSteps)
+			{
+				Ar.SetError();
+				return;
+			}
+
+			Capture.Steps.SetNum(NumSteps);
+		}
+
+		for (FTraversalCaptureStep& Step : Capture.Steps)
+		{
+			Ar << Step.Stage;
+			SerializeQuery(Ar, Step.Query);
+			SerializeHit(Ar, Step.Hit);
+
+			// What the stage read from the collision of the hit component
+			uint8 StepFlags = (Step.bFoundCollisionLedge ? 1 : 0) | (Step.bInWallPatch ? 2 : 0);
+			Ar << StepFlags;
+			Step.bFoundCollisionLedge = (StepFlags & 1) != 0;
+			Step.bInWallPatch = (StepFlags & 2) != 0;
+
+			if (Step.bFoundCollisionLedge)
+			{
+				SerializeLedge(Ar, Step.CollisionLedge);
+			}
+		}
+
+		Ar << Capture.FinalStage;
+		SerializePlan(Ar, Capture.FinalPlan);
+	}
+
+	static void ExportProperties(const UObject* Object, const UClass* BaseClass, TMap<FString, FString>& OutProperties)
+	{
+		// Properties of the engine base classes don't affect the checks
+		for (TFieldIterator<FProperty> It(Object->GetClass()); It; ++It)
+		{
+			const FProperty* Property = *It;
+			const UClass* OwnerClass = Property->GetOwnerClass();
+			if (!Property->HasAnyPropertyFlags(CPF_Edit) || Property->HasAnyPropertyFlags(CPF_Transient) || !OwnerClass || !OwnerClass->IsChildOf(BaseClass))
+				continue;
+
+			// The config is captured by value below, so replays don't need its asset
+			const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property);
+			if (ObjectProperty && ObjectProperty->PropertyClass->IsChildOf(UTraversalConfig::StaticClass()))
+				continue;
+
+			FString Value;
+			Property->ExportText_InContainer(0, Value, Object, nullptr, nullptr, PPF_None);
+			OutProperties.Add(Property->GetName(), MoveTemp(Value));
+		}
+	}
+
+	static void ImportProperties(UObject* Object, const TMap<FString, FString>& Properties)
+	{
+		for (const TPair<FString, FString>& Property : Properties)
+		{
+			const FProperty* ObjectProperty = Object->GetClass()->FindPropertyByName(FName(*Property.Key));
+			if (!ObjectProperty)
+			{
+				UE_LOG(LogTraversal, Warning, TEXT("%s has no property %s. The captured value is ignored."), *Object->GetClass()->GetName(), *Property.Key);
+				continue;
+			}
+
+			ObjectProperty->ImportText_InContainer(*Property.Value, Object, Object, PPF_None);
+		}
+	}
+
+	static void ExportTuning(const UTraversalComponent* Component, FTraversalCaptureTuning& OutTuning)
+	{
+		OutTuning.ClassPath = Component->GetClass()->GetPathName();
+		ExportProperties(Component, UTraversalComponent::StaticClass(), OutTuning.Properties);
+
+		if (const UTraversalConfig* Config = Component->GetConfig())
+		{
+			OutTuning.ConfigClassPath = Config->GetClass()->GetPathName();
+			ExportProperties(Config, UTraversalConfig::StaticClass(), OutTuning.ConfigProperties);
+		}
+	}
+
+	static void SerializeTuning(FArchive& Ar, FTraversalCaptureTuning& Tuning)
+	{
+		Ar << Tuning.ClassPath << Tuning.Properties << Tuning.ConfigClassPath << Tuning.ConfigProperties;
+	}
+
+	bool IsCapturing()
+	{
+		return bCapturing.load(std::memory_order_relaxed);
+	}
+
+	static void FlushChecks()
+	{
+		check(IsInGameThread());
+
+		// Checks finished after the capture stopped are dropped
+		TArray<uint8> Record;
+		while (PendingChecks.Dequeue(Record))
+		{
+			if (Writer)
+			{
+				Writer->Serialize(Record.GetData(), Record.Num());
+				++NumChecks;
+			}
+		}
+	}
+
+	static void StopCapture()
+	{
+		bCapturing = false;
+		FlushChecks();
+
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+		EndFrameHandle.Reset();
+
+		if (!Writer)
+			return;
+
+		Writer->Close();
+		Writer.Reset();
+		Tunings.Reset();
+		ComponentTunings.Reset();
+
+		UE_LOG(LogTraversal, Display, TEXT("Traversal capture stopped. Wrote %d checks to %s."), NumChecks, *WriterPath);
+	}
+
+	static void StartCapture(const TArray<FString>& Args)
+	{
+		StopCapture();
+
+		WriterPath = Args.IsEmpty() ? FPaths::ProjectSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("TraversalCapture-%s.trvcap"), *FDateTime::Now().ToString()) : Args[0];
+		Writer.Reset(IFileManager::Get().CreateFileWriter(*WriterPath));
+		if (!Writer)
+		{
+			UE_LOG(LogTraversal, Error, TEXT("Traversal capture could not create %s."), *WriterPath);
+			return;
+		}
+
+		uint32 Magic = FileMagic;
+		int32 Version = FileVersion;
+		*Writer << Magic << Version;
+
+		NumChecks = 0;
+		bCapturing = true;
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FlushChecks);
+
+		UE_LOG(LogTraversal, Display, TEXT("Traversal capture started. Writing checks to %s."), *WriterPath);
+	}
+
+	static FAutoConsoleCommand StartCaptureCommand(
+		TEXT("traversal.Capture.Start"),
+		TEXT("Write the pose, tuning and hits of every traversal check to a file, to replay them with the TraversalReplay commandlet. Usage: traversal.Capture.Start [File]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&StartCapture));
+
+	static FAutoConsoleCommand StopCaptureCommand(
+		TEXT("traversal.Capture.Stop"),
+		TEXT("Stop writing traversal checks to the capture file and close it."),
+		FConsoleCommandDelegate::CreateStatic(&StopCapture));
+
+	TSharedPtr<FTraversalCheckCapture> BeginCheck(const UTraversalComponent* Component, const FTraversalCheck& Check, int32 LOD, float WalkableFloorZ)
+	{
+		check(IsInGameThread());
+
+		if (!Writer)
+			return nullptr;
+
+		int32* TuningIndex = ComponentTunings.Find(Component);
+		if (!TuningIndex)
+		{
+			// Characters of the same class usually share their tuning, so it is only written once
+			FTraversalCaptureTuning Tuning;
+			ExportTuning(Component, Tuning);
+
+			int32 Index = Tunings.IndexOfByPredicate([&Tuning](const FTraversalCaptureTuning& Other)
+			{
+				return Other.ClassPath == Tuning.ClassPath && Other.Properties.OrderIndependentCompareEqual(Tuning.Properties)
+					&& Other.ConfigClassPath == Tuning.ConfigClassPath && Other.ConfigProperties.OrderIndependentCompareEqual(Tuning.ConfigProperties);
+			});
+
+			if (Index == INDEX_NONE)
+			{
+				Index = Tunings.Add(Tuning);
+
+				EBlock Block = EBlock::Tuning;
+				*Writer << Block << Index;
+				SerializeTuning(*Writer, Tuning);
+			}
+
+			TuningIndex = &ComponentTunings.Add(Component, Index);
+		}
+
+		TSharedPtr<FTraversalCheckCapture> Capture = MakeShared<FTraversalCheckCapture>();
+		Capture->Tuning = *TuningIndex;
+		Capture->LOD = LOD;
+		Capture->WalkableFloorZ = WalkableFloorZ;
+		Capture->Time = Component->GetWorld() ? Component->GetWorld()->GetTimeSeconds() : 0.0;
+		Capture->InitialCheck = Check;
+		return Capture;
+	}
+
+	void FinishCheck(FTraversalCheckCapture& Capture, const FTraversalCheck& Check)
+	{
+		Capture.FinalStage = Check.Stage;
+		Capture.FinalPlan = Check.Plan;
+
+		if (!IsCapturing())
+			return;
+
+		TArray<uint8> Record;
+		FMemoryWriter RecordWriter(Record, true);
+
+		EBlock Block = EBlock::Check;
+		RecordWriter << Block;
+		SerializeCheck(RecordWriter, Capture);
+
+		PendingChecks.Enqueue(MoveTemp(Record));
+	}
+
+	bool LoadFile(const FString& Path, TArray<FTraversalCaptureTuning>& OutTunings, TArray<FTraversalCheckCapture>& OutChecks)
+	{
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+		if (!Reader)
+			return false;
+
+		uint32 Magic = 0;
+		int32 Version = 0;
+		*Reader << Magic << Version;
+		if (Magic != FileMagic || Version != FileVersion)
+			return false;
+
+		while (!Reader->AtEnd() && !Reader->IsError())
+		{
+			EBlock Block;
+			*Reader << Block;
+			if (Reader->IsError())
+				break;
+
+			if (Block == EBlock::Tuning)
+			{
+				int32 Index = INDEX_NONE;
+				FTraversalCaptureTuning Tuning;
+				*Reader << Index;
+				SerializeTuning(*Reader, Tuning);
+
+				// A capture that wasn't stopped ends in the middle of a block, which is dropped
+				if (Reader->IsError())
+					break;
+
+				// Tunings are written in index order
+				if (Index != OutTunings.Num())
+					return false;
+
+				OutTunings.Add(MoveTemp(Tuning));
+			}
+			else if (Block == EBlock::Check)
+			{
+				FTraversalCheckCapture Capture;
+				SerializeCheck(*Reader, Capture);
+				if (Reader->IsError())
+					break;
+
+				OutChecks.Add(MoveTemp(Capture));
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void ApplyTuning(UTraversalComponent* Component, const FTraversalCaptureTuning& Tuning)
+	{
+		ImportProperties(Component, Tuning.Properties);
+	}
+
+	UTraversalConfig* CreateConfig(UObject* Outer, const FTraversalCaptureTuning& Tuning)
+	{
+		UClass* ConfigClass = Tuning.ConfigClassPath.IsEmpty() ? nullptr : LoadClass<UTraversalConfig>(nullptr, *Tuning.ConfigClassPath);
+		if (!ConfigClass)
+		{
+			UE_LOG(LogTraversal, Warning, TEXT("Config class %s could not be loaded. The captured component had no config or the class was removed."), *Tuning.ConfigClassPath);
+			return nullptr;
+		}
+
+		UTraversalConfig* Config = NewObject<UTraversalConfig>(Outer, ConfigClass, NAME_None, RF_Transient);
+		ImportProperties(Config, Tuning.ConfigProperties);
+		Config->CompileAnimationTables();
+		return Config;
+	}
+}
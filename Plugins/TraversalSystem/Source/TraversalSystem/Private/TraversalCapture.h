@@ -0,0 +1,131 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TraversalComponent.h"
+
+class UTraversalConfig;
+
+/**
+* Stage of a captured check and the hit it was advanced with. Hits resolved from a ledge are captured like traced hits.
+* The hit component isn't captured, so what the stage read from its collision is captured with the step instead.
+*/
+struct FTraversalCaptureStep
+{
+	ETraversalCheckStage Stage = ETraversalCheckStage::Failed;
+	FTraversalTraceQuery Query;
+	FHitResult Hit;
+
+	// Whether a ledge was found on the box collision of the hit component, and the ledge. Only set for the first stage of vaults and mantles.
+	bool bFoundCollisionLedge = false;
+	FTraversalLedge CollisionLedge;
+
+	// Whether the pose was on the wall patch built from the hit component. Only set for the first stage of wall climbs.
+	bool bInWallPatch = false;
+};
+
+/**
+* Editable properties of a traversal component and its config, exported as text so they can be imported into a component created without a world.
+*/
+struct FTraversalCaptureTuning
+{
+	// Path of the component's class.
+	FString ClassPath;
+
+	// Text value of each property declared by the traversal component class or its subclasses, by property name.
+	TMap<FString, FString> Properties;
+
+	// Path of the class of the component's config. Empty if the component had none.
+	FString ConfigClassPath;
+
+	// Text value of each editable property of the config, by property name.
+	TMap<FString, FString> ConfigProperties;
+};
+
+/**
+* Everything the decision code of a check read while it ran, captured so the check can be replayed without a world.
+*/
+struct FTraversalCheckCapture
+{
+	// Index of the tuning of the component that ran the check.
+	int32 Tuning = INDEX_NONE;
+
+	// LOD level of the component.
+	int32 LOD = 0;
+
+	// Walkable floor Z of the owning character's movement component.
+	float WalkableFloorZ = 0.0f;
+
+	// World time the check began at.
+	double Time = 0.0;
+
+	// Check as it was created by BeginCheck.
+	FTraversalCheck InitialCheck;
+
+	// Every stage the check advanced through, in order.
+	TArray<FTraversalCaptureStep> Steps;
+
+	// Stage the check finished in.
+	ETraversalCheckStage FinalStage = ETraversalCheckStage::Failed;
+
+	// Plan of the finished check.
+	FTraversalPlan FinalPlan;
+};
+
+namespace TraversalCapture
+{
+	/**
+	* Whether checks are being captured. Started and stopped with traversal.Capture.Start and traversal.Capture.Stop.
+	*
+	* @return Capture is running.
+	*/
+	bool IsCapturing();
+
+	/**
+	* Start capturing a check that was just created by BeginCheck. The tuning of the component is written to the capture the first time one of its checks is captured.
+	* Must be called on the game thread.
+	*
+	* @param Component Component that created the check.
+	* @param Check Check positioned at its first stage.
+	* @param LOD LOD level of the component.
+	* @param WalkableFloorZ Walkable floor Z of the owning character's movement component.
+	* @return Capture to add the steps of the check to, or nullptr if checks aren't being captured.
+	*/
+	TSharedPtr<FTraversalCheckCapture> BeginCheck(const UTraversalComponent* Component, const FTraversalCheck& Check, int32 LOD, float WalkableFloorZ);
+
+	/**
+	* Queue a finished check to be written to the capture file at the end of the frame. Can be called from worker threads.
+	*
+	* @param Capture Capture of the check, with all of its steps.
+	* @param Check Finished check.
+	*/
+	void FinishCheck(FTraversalCheckCapture& Capture, const FTraversalCheck& Check);
+
+	/**
+	* Read a capture file.
+	*
+	* @param Path File written by traversal.Capture.Start.
+	* @param OutTunings Tunings of the components whose checks were captured.
+	* @param OutChecks Captured checks, in the order they finished.
+	* @return File was read. False if it couldn't be opened or isn't a capture of this version.
+	*/
+	bool LoadFile(const FString& Path, TArray<FTraversalCaptureTuning>& OutTunings, TArray<FTraversalCheckCapture>& OutChecks);
+
+	/**
+	* Set the editable properties of a component to a captured tuning. The config is created separately with CreateConfig.
+	*
+	* @param Component Component to set the properties of. Must be of the captured class or a subclass of it.
+	* @param Tuning Captured tuning.
+	*/
+	void ApplyTuning(UTraversalComponent* Component, const FTraversalCaptureTuning& Tuning);
+
+	/**
+	* Create a config with a captured tuning, with its animation tables compiled.
+	*
+	* @param Outer Outer of the config.
+	* @param Tuning Captured tuning.
+	* @return Transient config, or nullptr if the captured component had no config or its class couldn't be loaded.
+	*/
+	UTraversalConfig* CreateConfig(UObject* Outer, const FTraversalCaptureTuning& Tuning);
+}
@@ -4,21 +4,44 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CapsuleComponent.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Animation/AnimMontage.h"
 #include "Animation/AnimInstance.h"
 #include "MotionWarpingComponent.h"
 #include "Kismet/GameplayStatics.h"
-#include "DrawDebugHelpers.h"
+#include "TraversalWorldSubsystem.h"
+#include "TraversalGeometry.h"
+#include "SignificanceManager.h"
+#include "TraversalStats.h"
+#include "TraversalDebug.h"
+#include "TraversalCapture.h"
+#include "TraversalAnimationTable.h"
+#include "TraversalConfig.h"
+#include "TraversalMovementComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "AnimNotifyState_TraversalExitWindow.h"
+#include "GameFramework/GameStateBase.h"
+#include "UObject/CoreNet.h"
+#include "UObject/UnrealType.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "Tasks/Task.h"
+#include "Misc/ScopeExit.h"
+#include <atomic>
+
+static const FName TraversalSignificanceTag(TEXT("Traversal"));
 
 // Sets default values for this component's properties
 UTraversalComponent::UTraversalComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
+	// Ticking is only enabled while an action that needs to be updated every frame is active.
 	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 
+	// Vaults and mantles are replicated through RPCs
+	SetIsReplicatedByDefault(true);
 }
 
 // Called when the game starts
@@ -26,6 +49,55 @@ void UTraversalComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	SetLOD(CurrentLOD);
+
+	MemoryTrimDelegateHandle = FCoreDelegates::GetMemoryTrimDelegate().AddUObject(this, &UTraversalComponent::OnMemoryTrim);
+
+	// Let the significance manager pick the LOD level
+	if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld()))
+	{
+		TWeakObjectPtr<UTraversalComponent> WeakThis(this);
+
+		SignificanceManager->RegisterObject(this, TraversalSignificanceTag,
+			[WeakThis](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& ViewTransform)
+			{
+				const UTraversalComponent* TraversalComponent = WeakThis.Get();
+				return TraversalComponent ? TraversalComponent->CalculateSignificance(ViewTransform) : 0.0f;
+			},
+			USignificanceManager::EPostSignificanceType::Sequential,
+			[WeakThis](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+			{
+				if (UTraversalComponent* TraversalComponent = WeakThis.Get())
+				{
+					TraversalComponent->SetLODFromSignificance(Significance);
+				}
+			});
+	}
+}
+
+// Called when the game ends
+void UTraversalComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelAsyncCheck();
+
+	FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimDelegateHandle);
+	GetWorld()->GetTimerManager().ClearTimer(MontagePreloadTimerHandle);
+	GetWorld()->GetTimerManager().ClearTimer(LookAheadTimerHandle);
+	for (TPair<ETraversalState, TSharedPtr<FStreamableHandle>>& MontageHandle : MontageHandles)
+	{
+		if (MontageHandle.Value.IsValid())
+		{
+			MontageHandle.Value->ReleaseHandle();
+		}
+	}
+	MontageHandles.Reset();
+
+	if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterObject(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -38,18 +110,149 @@ void UTraversalComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
 	{
 		SlideUpdate();
 	}
+	else if (ActiveAction.BakedRootMotion)
+	{
+		UpdateBakedAction(DeltaTime);
+	}
+	else if (ActiveAction.MontageInstanceID != INDEX_NONE)
+	{
+		UpdateActionExit();
+	}
 
 }
 
 void UTraversalComponent::Initialize(ACharacter* Character)
 {
+	LLM_SCOPE_BYTAG(Traversal);
+
 	PlayerCharacter = Character;
 	PlayerCharacterMovement = Character->GetCharacterMovement();
+	TraversalMovement = Cast<UTraversalMovementComponent>(PlayerCharacterMovement);
 	PlayerCapsule = Character->GetCapsuleComponent();
 
-	DefaultGravity = PlayerCharacterMovement->GravityScale;
-	DefaultGroundFriction = PlayerCharacterMovement->GroundFriction;
-	DefaultBrakingDeceleration = PlayerCharacterMovement->BrakingDecelerationWalking;
+	MovementDefaults.GroundFriction = PlayerCharacterMovement->GroundFriction;
+	MovementDefaults.BrakingDeceleration = PlayerCharacterMovement->BrakingDecelerationWalking;
+
+	AsyncTraceDelegate.BindUObject(this, &UTraversalComponent::OnAsyncCheckTraceCompleted);
+
+	// The traversal movement component runs the actions as predicted movement modes
+	if (TraversalMovement)
+	{
+		TraversalMovement->TraversalComponent = this;
+		Character->MovementModeChangedDelegate.AddUniqueDynamic(this, &UTraversalComponent::OnMovementModeChanged);
+	}
+
+	TraceContext.World = GetWorld();
+	TraceContext.Channel = UEngineTypes::ConvertToCollisionChannel(DetectionTraceChannel);
+	TraceContext.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(TraversalTrace), false, Character);
+	TraceContext.QueryParams.bReturnPhysicalMaterial = true;
+
+	// Allocate the cache up front so storing results doesn't allocate during play
+	CheckCache.Reserve(CheckCacheSize);
+
+	// Instances created before their template's tuning was moved into a config share the template's
+	if (!Config)
+	{
+		Config = CastChecked<UTraversalComponent>(GetArchetype())->Config;
+	}
+
+	if (!Config)
+	{
+		UE_LOG(LogTraversal, Error, TEXT("%s has no traversal config. Every check will fail."), *GetPathName());
+		Config = NewObject<UTraversalConfig>(this, NAME_None, RF_Transient);
+	}
+
+	// Stream the vault and mantle montages in and out with the ledges around the character
+	if (MontagePreloadDistance > 0.0f)
+	{
+		GetWorld()->GetTimerManager().SetTimer(MontagePreloadTimerHandle, this, &UTraversalComponent::UpdateMontagePreloading, MontagePreloadInterval, true, 0.0f);
+	}
+	else
+	{
+		PreloadMontages(ETraversalState::Vaulting);
+		PreloadMontages(ETraversalState::Mantling);
+	}
+
+	if (bUseLookAhead)
+	{
+		GetWorld()->GetTimerManager().SetTimer(LookAheadTimerHandle, this, &UTraversalComponent::UpdateLookAhead, GetLookAheadInterval(), true);
+	}
+}
+
+const UTraversalConfig* UTraversalComponent::GetConfig() const
+{
+	return Config;
+}
+
+void UTraversalComponent::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	// Tuning used to be saved on every component. Move the tuning of templates into a config in their package, which the instances share
+	if (Config || HasAnyFlags(RF_ClassDefaultObject))
+		return;
+
+	// Instances that overrode the tuning of their template, such as components placed in a level, get a config of their own
+	if (!IsTemplate())
+	{
+		const UObject* Archetype = GetArchetype();
+		bool bOverridesTuning = false;
+		for (TFieldIterator<FProperty> It(UTraversalComponent::StaticClass()); It && !bOverridesTuning; ++It)
+		{
+			bOverridesTuning = It->HasAnyPropertyFlags(CPF_Deprecated) && !It->Identical_InContainer(this, Archetype);
+		}
+
+		if (!bOverridesTuning)
+			return;
+	}
+
+	UPackage* Package = GetPackage();
+	Config = NewObject<UTraversalConfig>(Package, MakeUniqueObjectName(Package, UTraversalConfig::StaticClass(), FName(TEXT("TraversalConfig"))));
+	Config->GlobalHeightOffsetZ = GlobalHeightOffsetZ_DEPRECATED;
+	Config->VaultReachDistance = VaultReachDistance_DEPRECATED;
+	Config->VaultMinLedgeHeight = VaultMinLedgeHeight_DEPRECATED;
+	Config->VaultMaxLedgeHeight = VaultMaxLedgeHeight_DEPRECATED;
+	Config->VaultMinDepth = VaultMinDepth_DEPRECATED;
+	Config->VaultMaxDepth = VaultMaxDepth_DEPRECATED;
+	Config->VaultMaxApproachAngle = VaultMaxApproachAngle_DEPRECATED;
+	Config->VaultLandDistance = VaultLandDistance_DEPRECATED;
+	Config->VaultMaxLandVerticalDistance = VaultMaxLandVerticalDistance_DEPRECATED;
+	Config->VaultAnimationTable = VaultAnimationTable_DEPRECATED;
+	Config->VaultAnimationPropertySettings = VaultAnimationPropertySettings_DEPRECATED;
+	Config->VaultObjectStartWarpTargetName = VaultObjectStartWarpTargetName_DEPRECATED;
+	Config->VaultObjectEndWarpTargetName = VaultObjectEndWarpTargetName_DEPRECATED;
+	Config->VaultLandWarpTargetName = VaultLandWarpTargetName_DEPRECATED;
+	Config->MantleReachDistance = MantleReachDistance_DEPRECATED;
+	Config->MantleMinLedgeHeight = MantleMinLedgeHeight_DEPRECATED;
+	Config->MantleMaxLedgeHeight = MantleMaxLedgeHeight_DEPRECATED;
+	Config->MantleAnimationTable = MantleAnimationTable_DEPRECATED;
+	Config->MantleAnimationPropertySettings = MantleAnimationPropertySettings_DEPRECATED;
+	Config->MantleWarpTargetName = MantleWarpTargetName_DEPRECATED;
+	Config->SlidePower = SlidePower_DEPRECATED;
+	Config->SlideFloorMultiplier = SlideFloorMultiplier_DEPRECATED;
+	Config->SlideGroundFriction = SlideGroundFriction_DEPRECATED;
+	Config->SlideBrakingPower = SlideBrakingPower_DEPRECATED;
+	Config->SlideMinSpeed = SlideMinSpeed_DEPRECATED;
+	Config->SlideMaxSpeed = SlideMaxSpeed_DEPRECATED;
+	Config->SlideSubstepTime = SlideSubstepTime_DEPRECATED;
+	Config->SlideMaxSubsteps = SlideMaxSubsteps_DEPRECATED;
+	Config->WallDetectionDistance = WallDetectionDistance_DEPRECATED;
+	Config->WallClimbSpeed = WallClimbSpeed_DEPRECATED;
+	Config->WallClimbBrakingDeceleration = WallClimbBrakingDeceleration_DEPRECATED;
+	Config->InwardTurnDetectionDistance = InwardTurnDetectionDistance_DEPRECATED;
+	Config->MaxInwardTurnAngle = MaxInwardTurnAngle_DEPRECATED;
+	Config->LeftInwardTurnAnimation = LeftInwardTurnAnimation_DEPRECATED;
+	Config->RightInwardTurnAnimation = RightInwardTurnAnimation_DEPRECATED;
+	Config->DirectionalTraceDistance = DirectionalTraceDistance_DEPRECATED;
+	Config->OutwardTurnDetectionDistance = OutwardTurnDetectionDistance_DEPRECATED;
+	Config->MaxOutwardTurnAngle = MaxOutwardTurnAngle_DEPRECATED;
+	Config->LeftOutwardTurnAnimation = LeftOutwardTurnAnimation_DEPRECATED;
+	Config->RightOutwardTurnAnimation = RightOutwardTurnAnimation_DEPRECATED;
+	Config->CompileAnimationTables();
+
+	UE_LOG(LogTraversal, Warning, TEXT("Moved the tuning of %s into %s. Resave the asset, or assign a shared config asset to the component."), *GetPathName(), *Config->GetPathName());
+#endif
 }
 
 /***** General *****/
@@ -61,768 +264,2507 @@ FVector UTraversalComponent::GetCapsuleBaseLocation()
 
 FVector UTraversalComponent::GetCapsuleLocationFromBaseLocation(FVector BaseLocation)
 {
-	return BaseLocation + FVector(0.0f, 0.0f, PlayerCapsule->GetScaledCapsuleHalfHeight() + GlobalHeightOffsetZ);
+	return BaseLocation + FVector(0.0f, 0.0f, PlayerCapsule->GetScaledCapsuleHalfHeight() + Config->GlobalHeightOffsetZ);
 }
 
-bool UTraversalComponent::IsRoomForCapsule(FVector Location)
+FVector UTraversalComponent::GetPoseCapsuleLocation(const FTraversalPose& Pose, FVector BaseLocation) const
 {
-	FVector Start = Location + FVector(0.0f, 0.0f, PlayerCapsule->GetScaledCapsuleHalfHeight_WithoutHemisphere());
-	FVector End = Location - FVector(0.0f, 0.0f, PlayerCapsule->GetScaledCapsuleHalfHeight_WithoutHemisphere());
-	TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
-
-	UKismetSystemLibrary::SphereTraceSingle(GetWorld(), Start, End, PlayerCapsule->GetScaledCapsuleRadius(), DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
-	
-	return !Hit.bBlockingHit && !Hit.bStartPenetrating;
+	return BaseLocation + FVector(0.0f, 0.0f, Pose.CapsuleHalfHeight + Config->GlobalHeightOffsetZ);
 }
 
-FIsObjectClimbableOut UTraversalComponent::IsObjectClimbable(float ReachDistance, float MinLedgeHeight, float MaxLedgeHeight)
+FTraversalPose UTraversalComponent::CapturePose() const
 {
-	FVector Start = (GetCapsuleBaseLocation() + PlayerCharacter->GetLastMovementInputVector() * -15.0f) + FVector(0.0f, 0.0f, (MinLedgeHeight + MaxLedgeHeight) / 2);
-	FVector End = Start + PlayerCharacter->GetLastMovementInputVector() * ReachDistance;
-	float HalfHeight = (MaxLedgeHeight - MinLedgeHeight) / 2;
-	const TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
+	FTraversalPose Pose;
+	Pose.Location = PlayerCharacter->GetActorLocation();
+	Pose.Rotation = PlayerCharacter->GetActorRotation();
+	Pose.ForwardVector = PlayerCharacter->GetActorForwardVector();
+	Pose.RightVector = PlayerCharacter->GetActorRightVector();
+	Pose.UpVector = PlayerCharacter->GetActorUpVector();
+	Pose.MovementInput = PlayerCharacter->GetLastMovementInputVector();
+	Pose.Velocity = PlayerCharacterMovement->Velocity;
+	Pose.CapsuleRadius = PlayerCapsule->GetScaledCapsuleRadius();
+	Pose.CapsuleHalfHeight = PlayerCapsule->GetScaledCapsuleHalfHeight();
+	Pose.CapsuleBaseLocation = PlayerCapsule->GetComponentLocation() - (PlayerCapsule->GetUpVector() * Pose.CapsuleHalfHeight);
+	return Pose;
+}
 
-	bool bHit = UKismetSystemLibrary::CapsuleTraceSingle(GetWorld(), Start, End, 5.0f, HalfHeight, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
-	FIsObjectClimbableOut Out;
+bool UTraversalComponent::CanStartCheck(ETraversalState Action) const
+{
+	if (TraversalState != ETraversalState::None)
+		return false;
 
-	if (bHit && !Hit.bStartPenetrating && !PlayerCharacterMovement->IsWalkable(Hit))
-	{
-		Out.bIsNotWalkable = true;
-		Out.InitialImpactPoint = Hit.ImpactPoint;
-		Out.InitialImpactNormal = Hit.ImpactNormal;
-		return Out;
-	}
-	
-	return Out;
+	// Vaulting additionally requires the character to be on the ground
+	return Action != ETraversalState::Vaulting || !PlayerCharacterMovement->IsFalling();
 }
 
-FIsSurfaceWalkableOut UTraversalComponent::IsSurfaceWalkable(float MaxLedgeHeight, FVector InitialImpactPoint, FVector InitialImpactNormal)
+FTraversalCheck UTraversalComponent::BeginCheck(ETraversalState Action) const
 {
-	FVector End = PlayerCharacter->GetLastMovementInputVector() * 15.0f + FVector(InitialImpactPoint.X, InitialImpactPoint.Y, GetCapsuleBaseLocation().Z);
-	FVector Start = End + FVector(0.0f, 0.0f, MaxLedgeHeight + 30.0f);
-	const TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
+	INC_DWORD_STAT(STAT_TraversalChecksAttempted);
+	CSV_CUSTOM_STAT(Traversal, ChecksAttempted, 1, ECsvCustomStatOp::Accumulate);
 
-	bool bHit = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), Start, End, 5.0f, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::ForDuration, Hit, true, FLinearColor::Red);
-	FIsSurfaceWalkableOut Out;
+	FTraversalCheck Check;
+	Check.Action = Action;
+	Check.Plan.Action = Action;
+	Check.Pose = CapturePose();
 
-	if (bHit && PlayerCharacterMovement->IsWalkable(Hit))
+	switch (Action)
 	{
-		Out.bIsWalkable = true;
-		Out.WalkableImpactPoint = Hit.ImpactPoint;
-		return Out;
+	case ETraversalState::None:
+		// Evaluate vault and mantle together. The action is picked once the ledge height is known
+		Check.bIsUnified = true;
+		Check.bCanVault = !PlayerCharacterMovement->IsFalling();
+		Check.bCanMantle = true;
+		Check.Stage = ETraversalCheckStage::ObjectClimbable;
+		break;
+	case ETraversalState::Vaulting:
+	case ETraversalState::Mantling:
+		Check.Stage = ETraversalCheckStage::ObjectClimbable;
+		break;
+	case ETraversalState::WallClimbing:
+		Check.Stage = ETraversalCheckStage::WallForward;
+		break;
+	default:
+		Check.Stage = ETraversalCheckStage::Failed;
+		break;
 	}
-	
-	return Out;
+
+	// Captured before any stage runs, so replays start from the same state
+	if (TraversalCapture::IsCapturing())
+	{
+		Check.Capture = TraversalCapture::BeginCheck(this, Check, CurrentLOD, PlayerCharacterMovement->GetWalkableFloorZ());
+	}
+
+	return Check;
 }
 
-bool UTraversalComponent::IsCapsulePathClear(float Height, FVector EndTargetLocation)
+FTraversalTraceQuery UTraversalComponent::GetCheckQuery(const FTraversalCheck& Check) const
 {
-	FVector Start = PlayerCharacter->GetActorLocation() + PlayerCharacter->GetActorUpVector() * Height;
-	FVector End = GetCapsuleLocationFromBaseLocation(EndTargetLocation);
-	const TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
-	
-	bool bHit = UKismetSystemLibrary::CapsuleTraceSingle(GetWorld(), Start, End, PlayerCapsule->GetScaledCapsuleRadius(), PlayerCapsule->GetScaledCapsuleHalfHeight(), DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
+	const FTraversalPose& Pose = Check.Pose;
+	const bool bIsVault = Check.Action == ETraversalState::Vaulting;
 
-	return !bHit;
+	switch (Check.Stage)
+	{
+	case ETraversalCheckStage::ObjectClimbable:
+	{
+		float ReachDistance, MinLedgeHeight, MaxLedgeHeight;
+		GetLedgeBand(Check, ReachDistance, MinLedgeHeight, MaxLedgeHeight);
+		return MakeObjectClimbableQuery(Pose, ReachDistance, MinLedgeHeight, MaxLedgeHeight);
+	}
+	case ETraversalCheckStage::SurfaceWalkable:
+	{
+		float ReachDistance, MinLedgeHeight, MaxLedgeHeight;
+		GetLedgeBand(Check, ReachDistance, MinLedgeHeight, MaxLedgeHeight);
+		return MakeSurfaceWalkableQuery(Pose, MaxLedgeHeight, Check.InitialImpactPoint);
+	}
+	case ETraversalCheckStage::VaultReach:
+		return MakeVaultReachQuery(Pose);
+	case ETraversalCheckStage::VaultDepth:
+		return MakeVaultDepthQuery(Pose, Check.ReachImpactPoint);
+	case ETraversalCheckStage::VaultRoom:
+		return MakeRoomForCapsuleQuery(Pose, Check.Plan.ObjectEndWarpTarget + Pose.ForwardVector * (Pose.CapsuleRadius + Config->VaultLandDistance));
+	case ETraversalCheckStage::VaultLand:
+		return MakeVaultLandQuery(Pose, Check.Plan.ObjectEndWarpTarget);
+	case ETraversalCheckStage::CapsulePath:
+	{
+		const FTraversalPlan& Plan = Check.Plan;
+		const FVector EndTargetLocation = bIsVault ? Plan.LandWarpTarget + FVector(0.0f, 0.0f, Plan.Height) : Plan.ObjectStartWarpTarget;
+		return MakeCapsulePathQuery(Pose, Plan.Height, EndTargetLocation);
+	}
+	case ETraversalCheckStage::WallForward:
+		return MakeForwardQuery(Pose, FVector::ZeroVector);
+	case ETraversalCheckStage::WallRoomTop:
+		return MakeWallClimbRoomQuery(Pose, FVector(0.0f, 0.0f, 1.0f));
+	case ETraversalCheckStage::WallRoomBottom:
+		return MakeWallClimbRoomQuery(Pose, FVector(0.0f, 0.0f, -1.0f));
+	case ETraversalCheckStage::WallRoomRight:
+		return MakeWallClimbRoomQuery(Pose, Pose.RightVector);
+	case ETraversalCheckStage::WallRoomLeft:
+		return MakeWallClimbRoomQuery(Pose, Pose.RightVector * -1.0f);
+	default:
+		checkNoEntry();
+		return FTraversalTraceQuery();
+	}
 }
 
-FAnimationProperties UTraversalComponent::DetermineAnimationProperties(float Height, const TArray<FAnimationPropertySettings>& AnimationPropertySettings)
+void UTraversalComponent::AdvanceCheck(FTraversalCheck& Check, const FHitResult& Hit, const FTraversalCaptureStep* ReplayStep) const
 {
-	FAnimationProperties Out;
+	// Every hit passes through here, whether it was traced synchronously, asynchronously, in a batch or resolved from a ledge
+	FTraversalCaptureStep* CaptureStep = nullptr;
+	if (Check.Capture)
+	{
+		CaptureStep = &Check.Capture->Steps.Add_GetRef({ Check.Stage, GetCheckQuery(Check), Hit });
+	}
 
-	for (const FAnimationPropertySettings& PropertySetting : AnimationPropertySettings)
+	ON_SCOPE_EXIT
 	{
-		if (IsValid(PropertySetting.Animation) && UKismetMathLibrary::InRange_FloatFloat(Height, PropertySetting.AnimationMinHeight, PropertySetting.AnimationMaxHeight))
+		if (Check.Capture && Check.IsFinished())
 		{
-			UE_LOG(LogTemp, Warning, TEXT("DetermineProp"));
-			Out.Animation = PropertySetting.Animation;
-			Out.AnimationHeightOffset = PropertySetting.AnimationHeightOffset;
-			Out.AnimationStartingPosition = UKismetMathLibrary::MapRangeClamped(Height, PropertySetting.InHeightA, PropertySetting.InHeightB, PropertySetting.StartingPositionA, PropertySetting.StartingPositionA);
-			Out.AnimationEndBlendTime = PropertySetting.AnimationEndBlendTime;
-			return Out;
+			TraversalCapture::FinishCheck(*Check.Capture, Check);
+			Check.Capture.Reset();
 		}
-	}
-	return { nullptr };
-		/*Out.Animation = nullptr;
-		Out.AnimationHeightOffset = 0.0f;
-		Out.AnimationStartingPosition = 0.0f;
-		Out.AnimationEndBlendTime = 0.0f;
-		return Out;*/
-}
+	};
 
+	FTraversalPlan& Plan = Check.Plan;
+	const bool bIsVault = Check.Action == ETraversalState::Vaulting;
 
-/***** Vault *****/
+	switch (Check.Stage)
+	{
+	case ETraversalCheckStage::ObjectClimbable:
+	{
+		if (Hit.GetComponent())
+		{
+			Check.Obstacle = Hit.GetComponent();
+			Check.ObstacleTransform = Hit.GetComponent()->GetComponentTransform();
+		}
 
-bool UTraversalComponent::VaultCheck()
-{
-	if (TraversalState != ETraversalState::None || PlayerCharacterMovement->IsFalling())
-		return false;
+		// Check if character can't step onto object
+		if (!Hit.bBlockingHit || Hit.bStartPenetrating || PlayerCharacterMovement->IsWalkable(Hit))
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	FVector InitialTraceImpactPoint;
-	FVector InitialTraceImpactNormal;
+		Check.InitialImpactPoint = Hit.ImpactPoint;
+		Check.InitialImpactNormal = Hit.ImpactNormal;
+		Plan.ApproachAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Min(FMath::Abs(FVector::DotProduct(Hit.ImpactNormal.GetSafeNormal2D(), Check.Pose.ForwardVector.GetSafeNormal2D())), 1.0)));
 
-	// Trace forward to check if character can't step onto object
-	FIsObjectClimbableOut CheckObjectHeightReturnValue = IsObjectClimbable(VaultReachDistance, VaultMinLedgeHeight, VaultMaxLedgeHeight);
+		if (Check.bIsUnified)
+		{
+			// Check which actions the object is within reach of
+			Check.bCanVault &= Hit.Distance <= Config->VaultReachDistance && IsApproachAngleVaultable(Check.Pose, Check.InitialImpactNormal);
+			Check.bCanMantle &= Hit.Distance <= Config->MantleReachDistance;
 
-	if (CheckObjectHeightReturnValue.bIsNotWalkable)
-	{
-		InitialTraceImpactPoint = CheckObjectHeightReturnValue.InitialImpactPoint;
-		InitialTraceImpactNormal = CheckObjectHeightReturnValue.InitialImpactNormal;
+			if (!Check.bCanVault && !Check.bCanMantle)
+			{
+				FailCheck(Check);
+				return;
+			}
+		}
+		// Check if it can start the vault with current approach angle
+		else if (bIsVault && !IsApproachAngleVaultable(Check.Pose, Check.InitialImpactNormal))
+		{
+			FailCheck(Check);
+			return;
+		}
+
+		// The top and far side of a box obstacle are known from its collision
+		if (bUseCollisionLedges && !Check.bUsesBakedLedge)
+		{
+			if (ReplayStep)
+			{
+				Check.bUsesCollisionLedge = ReplayStep->bFoundCollisionLedge;
+				Check.Ledge = ReplayStep->CollisionLedge;
+			}
+			else
+			{
+				Check.bUsesCollisionLedge = FindCollisionLedge(Hit.GetComponent(), Hit.ImpactPoint, Hit.ImpactNormal, Check.Ledge);
+			}
+
+			if (CaptureStep)
+			{
+				CaptureStep->bFoundCollisionLedge = Check.bUsesCollisionLedge;
+				CaptureStep->CollisionLedge = Check.Ledge;
+			}
+		}
+
+		Check.Stage = ETraversalCheckStage::SurfaceWalkable;
+		return;
 	}
-	else
+	case ETraversalCheckStage::SurfaceWalkable:
 	{
-		return false;
-	}
+		// Determine if the hit location is walkable. If it is, set impact point as object start sync point
+		if (!Hit.bBlockingHit || !PlayerCharacterMovement->IsWalkable(Hit))
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	float ApproachAngleDotProduct = UKismetMathLibrary::Dot_VectorVector(InitialTraceImpactNormal, PlayerCharacter->GetActorForwardVector());
-	int32 ApproachAngle = UKismetMathLibrary::Round(UKismetMathLibrary::Abs(ApproachAngleDotProduct) * 90.0f);
+		Plan.ObjectStartWarpTarget = Hit.ImpactPoint;
+		Plan.Height = (GetPoseCapsuleLocation(Check.Pose, Hit.ImpactPoint) - Check.Pose.Location).Z;
 
-	// Check if it can start the vault with current approach angle
-	if (ApproachAngle < VaultMaxApproachAngle)
-		return false;
+		// Classify the ledge by the height band it falls into. Vaulting is preferred and falls back to mantling if it fails
+		if (Check.bIsUnified)
+		{
+			Check.bCanVault &= Plan.Height >= Config->VaultMinLedgeHeight && Plan.Height < Config->VaultMaxLedgeHeight;
+			Check.bCanMantle &= Plan.Height >= Config->MantleMinLedgeHeight && Plan.Height <= Config->MantleMaxLedgeHeight;
 
-	FVector WalkableImpactPoint;
+			if (!Check.bCanVault && !Check.bCanMantle)
+			{
+				FailCheck(Check);
+				return;
+			}
 
-	// Trace downward from the initial trace's impact point and determine if the hit location is walkable. If it is, set impact point as object start sync point
-	FIsSurfaceWalkableOut IsWalkableSurfaceReturnValue = IsSurfaceWalkable(VaultMaxLedgeHeight, InitialTraceImpactPoint, InitialTraceImpactNormal);
+			Check.Action = Plan.Action = Check.bCanVault ? ETraversalState::Vaulting : ETraversalState::Mantling;
+			if (Check.bCanVault)
+			{
+				Check.Stage = ETraversalCheckStage::VaultReach;
+				return;
+			}
 
-	if (IsWalkableSurfaceReturnValue.bIsWalkable)
-	{
-		WalkableImpactPoint = IsWalkableSurfaceReturnValue.WalkableImpactPoint;
-		ObjectStartWarpTarget = WalkableImpactPoint;
-		FVector VaultHeightVec = GetCapsuleLocationFromBaseLocation(WalkableImpactPoint) - PlayerCharacter->GetActorLocation();
-		VaultHeight = VaultHeightVec.Z;
+			EnterCapsulePathStage(Check);
+			return;
+		}
 
-		// Check if vault height isn't higher than the max vault ledge height
-		if (VaultHeight >= VaultMaxLedgeHeight)
-			return false;
-	}
-	else
-	{
-		return false;
-	}
+		// Check if height isn't higher than the max ledge height
+		if (bIsVault ? Plan.Height >= Config->VaultMaxLedgeHeight : Plan.Height > Config->MantleMaxLedgeHeight)
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	// Check vaulting actor depth and space behind actor.If true, set object end sync point to depth impact point.Find land sync point
-	FCanVaultOverDepthOut CanVaultOverDepthOut = CanVaultOverDepth();
-	FVector EndTargetLocation;
+		if (bIsVault)
+		{
+			Check.Stage = ETraversalCheckStage::VaultReach;
+			return;
+		}
 
-	if (CanVaultOverDepthOut.bCanVaultOverDepth)
-	{
-		ObjectEndWarpTarget = CanVaultOverDepthOut.DepthImpactPoint;
-		LandWarpTarget = GetVaultLandPoint(ObjectEndWarpTarget);
-		EndTargetLocation = FVector(LandWarpTarget.X, LandWarpTarget.Y, LandWarpTarget.Z + VaultHeight);
+		EnterCapsulePathStage(Check);
+		return;
 	}
-	else
+	case ETraversalCheckStage::VaultReach:
 	{
-		return false;
-	}
+		if (!Hit.bBlockingHit)
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	// Check if nothing is blocking the mantle path
-	bool bIsPathClear = IsCapsulePathClear(VaultHeight, EndTargetLocation);
+		Check.ReachImpactPoint = Hit.ImpactPoint;
+		Check.Stage = ETraversalCheckStage::VaultDepth;
+		return;
+	}
+	case ETraversalCheckStage::VaultDepth:
+	{
+		// Check vaulting actor depth. If it can be vaulted over, set object end sync point to depth impact point
+		const float Depth = static_cast<float>(FVector::Distance(Hit.ImpactPoint, Check.ReachImpactPoint));
+		bool bInRange = Hit.bBlockingHit && UKismetMathLibrary::InRange_FloatFloat(Depth, Config->VaultMinDepth, Config->VaultMaxDepth);
+		if (!bInRange || Hit.Distance <= 1)
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	if (!bIsPathClear)
-		return false;
+		Plan.ObjectEndWarpTarget = Hit.ImpactPoint;
+		Plan.Depth = Depth;
+		Check.Stage = ETraversalCheckStage::VaultRoom;
+		return;
+	}
+	case ETraversalCheckStage::VaultRoom:
+	{
+		// Check space behind actor
+		if (Hit.bBlockingHit || Hit.bStartPenetrating)
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	// Determine correct vault animation properties based on vault height
-	FAnimationProperties VaultAnimationProperties = DetermineAnimationProperties(VaultHeight, VaultAnimationPropertySettings);
-	
-	// Start mantle
-	if (IsValid(VaultAnimationProperties.Animation))
+		Check.Stage = ETraversalCheckStage::VaultLand;
+		return;
+	}
+	case ETraversalCheckStage::VaultLand:
 	{
-		VaultStart(VaultAnimationProperties.Animation, VaultAnimationProperties.AnimationEndBlendTime);
-		return true;
+		Plan.LandWarpTarget = Hit.bBlockingHit ? Hit.ImpactPoint : FVector(0.0f, 0.0f, 0.0f);
+		EnterCapsulePathStage(Check);
+		return;
 	}
+	case ETraversalCheckStage::CapsulePath:
+	{
+		// Check if nothing is blocking the path
+		if (Hit.bBlockingHit)
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	return false;
-}
-
-FCanVaultOverDepthOut UTraversalComponent::CanVaultOverDepth()
-{
-	FVector Start = PlayerCharacter->GetActorLocation();
-	FVector End = Start + PlayerCharacter->GetActorForwardVector() * VaultReachDistance;
-	TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
-
-	bool bReachHit = UKismetSystemLibrary::LineTraceSingle(GetWorld(), Start, End, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
-	FCanVaultOverDepthOut Out;
-
-	if (bReachHit)
+		CompletePlan(Check);
+		return;
+	}
+	case ETraversalCheckStage::WallForward:
 	{
-		FVector ReachImpactPoint = Hit.ImpactPoint;
+		if (!Hit.bBlockingHit)
+		{
+			FailCheck(Check);
+			return;
+		}
+
+		Plan.WallHit = Hit;
+		if (Hit.GetComponent())
+		{
+			Check.Obstacle = Hit.GetComponent();
+			Check.ObstacleTransform = Hit.GetComponent()->GetComponentTransform();
+		}
 
-		Start = ReachImpactPoint + PlayerCharacter->GetActorForwardVector() * VaultMaxDepth;
-		End = ReachImpactPoint;
+		Check.Stage = ETraversalCheckStage::WallRoomTop;
 
-		bool bDepthHit = UKismetSystemLibrary::LineTraceSingle(GetWorld(), Start, End, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
+		// The room traces would all hit the same face of a box wall if the character is far enough from its edges
+		const bool bInWallPatch = ReplayStep ? ReplayStep->bInWallPatch
+			: Plan.WallPatch.Build(Hit) && Plan.WallPatch.Contains(Check.Pose.Location, Config->DirectionalTraceDistance, Config->WallDetectionDistance);
 
-		if (bDepthHit)
+		if (CaptureStep)
 		{
-			FVector DepthImpactPoint = Hit.ImpactPoint;
-			bool bInRange = UKismetMathLibrary::InRange_FloatFloat(UKismetMathLibrary::Vector_Distance(DepthImpactPoint, ReachImpactPoint), VaultMinDepth, VaultMaxDepth);
-			FVector Location = DepthImpactPoint + PlayerCharacter->GetActorForwardVector() * (PlayerCapsule->GetScaledCapsuleRadius() + VaultLandDistance);
-			bool bCanVaultOverDepth = Hit.Distance > 1 && bInRange && IsRoomForCapsule(Location);
+			CaptureStep->bInWallPatch = bInWallPatch;
+		}
 
-			Out.bCanVaultOverDepth = bCanVaultOverDepth;
-			Out.DepthImpactPoint = DepthImpactPoint;
-			return Out;
+		if (bInWallPatch)
+		{
+			Check.Stage = ETraversalCheckStage::Succeeded;
 		}
+		return;
 	}
+	case ETraversalCheckStage::WallRoomTop:
+	case ETraversalCheckStage::WallRoomBottom:
+	case ETraversalCheckStage::WallRoomRight:
+	case ETraversalCheckStage::WallRoomLeft:
+	{
+		// Every side of the character needs to be on the wall
+		if (!Hit.bBlockingHit)
+		{
+			FailCheck(Check);
+			return;
+		}
 
-	return Out;
+		switch (Check.Stage)
+		{
+		case ETraversalCheckStage::WallRoomTop:		Check.Stage = ETraversalCheckStage::WallRoomBottom; break;
+		case ETraversalCheckStage::WallRoomBottom:	Check.Stage = ETraversalCheckStage::WallRoomRight; break;
+		case ETraversalCheckStage::WallRoomRight:	Check.Stage = ETraversalCheckStage::WallRoomLeft; break;
+		default:									Check.Stage = ETraversalCheckStage::Succeeded; break;
+		}
+		return;
+	}
+	default:
+		checkNoEntry();
+		return;
+	}
 }
 
-FVector UTraversalComponent::GetVaultLandPoint(FVector ObjectEndPoint)
+bool UTraversalComponent::IsApproachAngleVaultable(const FTraversalPose& Pose, FVector ImpactNormal) const
 {
-	FVector Start = ObjectEndPoint + PlayerCharacter->GetActorForwardVector() * VaultLandDistance;
-	FVector End = Start - FVector(0.0f, 0.0f, VaultMaxLandVerticalDistance);
-	TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
+	float ApproachAngleDotProduct = UKismetMathLibrary::Dot_VectorVector(ImpactNormal, Pose.ForwardVector);
+	int32 ApproachAngle = UKismetMathLibrary::Round(UKismetMathLibrary::Abs(ApproachAngleDotProduct) * 90.0f);
 
-	UKismetSystemLibrary::LineTraceSingle(GetWorld(), Start, End, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
+	return ApproachAngle >= Config->VaultMaxApproachAngle;
+}
 
-	if (Hit.bBlockingHit)
-	{
-		return Hit.ImpactPoint;
-	}
-	else
+void UTraversalComponent::EnterCapsulePathStage(FTraversalCheck& Check) const
+{
+	// Cheaper check profiles trust the path to be clear
+	if (GetLODSettings().bSkipCapsulePathCheck)
 	{
-		return FVector(0.0f, 0.0f, 0.0f);
+		CompletePlan(Check);
+		return;
 	}
+
+	Check.Stage = ETraversalCheckStage::CapsulePath;
 }
 
-void UTraversalComponent::VaultStart(UAnimMontage* VaultAnimation, float AnimationEndBlendTime)
+void UTraversalComponent::CompletePlan(FTraversalCheck& Check) const
 {
-	TraversalState = ETraversalState::Vaulting;
-
-	// Set player movement mode and add warp targets
-	PlayerCharacterMovement->SetMovementMode(MOVE_Flying);
-	UMotionWarpingComponent* PlayerMotionWarpingComponent = PlayerCharacter->FindComponentByClass<UMotionWarpingComponent>();
-	if (IsValid(PlayerMotionWarpingComponent))
+	// Determine correct animation properties based on the ledge and approach
+	Check.Plan.AnimationProperties = SelectAnimation(Check.Plan, Check.Pose);
+	if (Check.Plan.AnimationProperties.Animation.IsNull())
 	{
-		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(VaultObjectStartWarpTargetName, ObjectStartWarpTarget, PlayerCharacter->GetActorRotation());
-		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(VaultObjectEndWarpTargetName, ObjectEndWarpTarget, PlayerCharacter->GetActorRotation());
-		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(VaultLandWarpTargetName, LandWarpTarget, PlayerCharacter->GetActorRotation());
-
-		float MontageDuration = PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Play(VaultAnimation, 1.0f, EMontagePlayReturnType::Duration, 0.0f, true);
-		FTimerHandle MontageCompletedTimerHandle;
-		float MontageFinalDuration = MontageDuration - AnimationEndBlendTime;
-		GetWorld()->GetTimerManager().SetTimer(MontageCompletedTimerHandle, FTimerDelegate::CreateUObject(this, &UTraversalComponent::OnVaultMontageCompleted, AnimationEndBlendTime), MontageFinalDuration, false);
+		FailCheck(Check);
+		return;
 	}
-}
 
-void UTraversalComponent::OnVaultMontageCompleted(float AnimationEndBlendTime)
-{
-	PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Stop(0.2f, PlayerCharacter->GetMesh()->GetAnimInstance()->GetActiveMontageInstance()->Montage);
-	PlayerCharacterMovement->SetMovementMode(MOVE_Walking);
-	TraversalState = ETraversalState::None;
+	Check.Stage = ETraversalCheckStage::Succeeded;
 }
 
+void UTraversalComponent::FailCheck(FTraversalCheck& Check) const
+{
+	// A unified check that can't vault may still mantle onto the same ledge, reusing the shared hit results
+	if (Check.bIsUnified && Check.Action == ETraversalState::Vaulting && Check.bCanMantle)
+	{
+		Check.bCanVault = false;
+		Check.Action = Check.Plan.Action = ETraversalState::Mantling;
+		EnterCapsulePathStage(Check);
+		return;
+	}
 
-/***** Mantle *****/
+	Check.Stage = ETraversalCheckStage::Failed;
+}
 
-bool UTraversalComponent::MantleCheck()
+void UTraversalComponent::GetLedgeBand(const FTraversalCheck& Check, float& OutReachDistance, float& OutMinLedgeHeight, float& OutMaxLedgeHeight) const
 {
-	if (TraversalState != ETraversalState::None)
+	if (Check.bIsUnified)
 	{
-		return false;
+		// Cover the union of the vault and mantle height bands
+		OutReachDistance = FMath::Max(Config->VaultReachDistance, Config->MantleReachDistance);
+		OutMinLedgeHeight = FMath::Min(Config->VaultMinLedgeHeight, Config->MantleMinLedgeHeight);
+		OutMaxLedgeHeight = FMath::Max(Config->VaultMaxLedgeHeight, Config->MantleMaxLedgeHeight);
+		return;
 	}
 
-	FVector InitialTraceImpactPoint;
-	FVector InitialTraceImpactNormal;
+	const bool bIsVault = Check.Action == ETraversalState::Vaulting;
+	OutReachDistance = bIsVault ? Config->VaultReachDistance : Config->MantleReachDistance;
+	OutMinLedgeHeight = bIsVault ? Config->VaultMinLedgeHeight : Config->MantleMinLedgeHeight;
+	OutMaxLedgeHeight = bIsVault ? Config->VaultMaxLedgeHeight : Config->MantleMaxLedgeHeight;
+}
+
+// Fill in the hit a trace would have returned if it hit the given point
+static void SetLedgeHit(FHitResult& OutHit, const FTraversalTraceQuery& Query, const FVector& ImpactPoint, const FVector& ImpactNormal)
+{
+	OutHit.bBlockingHit = true;
+	OutHit.TraceStart = Query.Start;
+	OutHit.TraceEnd = Query.End;
+	OutHit.ImpactPoint = ImpactPoint;
+	OutHit.ImpactNormal = ImpactNormal;
+	OutHit.Normal = ImpactNormal;
+	OutHit.Location = ImpactPoint + ImpactNormal * Query.Radius;
+	OutHit.Distance = static_cast<float>(FVector::Dist(Query.Start, OutHit.Location));
+	OutHit.Time = OutHit.Distance / FMath::Max(static_cast<float>(FVector::Dist(Query.Start, Query.End)), UE_KINDA_SMALL_NUMBER);
+}
 
-	// Trace forward to check if character can't step onto object
-	FIsObjectClimbableOut IsObjectClimbableReturnValue = IsObjectClimbable(MantleReachDistance, MantleMinLedgeHeight, MantleMaxLedgeHeight);
+bool UTraversalComponent::ResolveFromLedge(FTraversalCheck& Check, FHitResult& OutHit) const
+{
+	const FTraversalLedge& Ledge = Check.Ledge;
 
-	if (IsObjectClimbableReturnValue.bIsNotWalkable)
+	switch (Check.Stage)
 	{
-		InitialTraceImpactPoint = IsObjectClimbableReturnValue.InitialImpactPoint;
-		InitialTraceImpactNormal = IsObjectClimbableReturnValue.InitialImpactNormal;
-	}
-	else
+	case ETraversalCheckStage::ObjectClimbable:
 	{
-		return false;
+		const UTraversalWorldSubsystem* TraversalSubsystem = bUseLedgeIndex ? GetWorld()->GetSubsystem<UTraversalWorldSubsystem>() : nullptr;
+		if (!TraversalSubsystem)
+			return false;
+
+		// Look for a ledge within the band covered by the climbable and walkable traces
+		const FTraversalTraceQuery Query = GetCheckQuery(Check);
+		const FVector Delta = Query.End - Query.Start;
+		const float MinZ = static_cast<float>(Query.Start.Z - Query.HalfHeight);
+		const float MaxZ = static_cast<float>(Query.Start.Z + Query.HalfHeight + 30.0f);
+		float Distance;
+		if (!TraversalSubsystem->FindLedge(Query.Start, Delta, static_cast<float>(Delta.Size2D()), MinZ, MaxZ, Check.Ledge, Distance))
+			return false;
+
+		Check.bUsesBakedLedge = true;
+		SetLedgeHit(OutHit, Query, Query.Start + Delta.GetSafeNormal2D() * Distance, FVector(Ledge.Normal));
+		return true;
 	}
+	case ETraversalCheckStage::SurfaceWalkable:
+	{
+		if (!Check.bUsesBakedLedge && !Check.bUsesCollisionLedge)
+			return false;
 
-	FVector WalkableImpactPoint;
+		// The walkable trace lands on the top surface if it comes down behind the edge
+		const FTraversalTraceQuery Query = GetCheckQuery(Check);
+		const FVector EdgePoint = FMath::ClosestPointOnSegment(Query.End, Ledge.Start, Ledge.End);
 
-	// Trace downward from the initial trace's impact point and determine if the hit location is walkable. If it is, set impact point as object start sync point
-	FIsSurfaceWalkableOut IsWalkableSurfaceReturnValue = IsSurfaceWalkable(MantleMaxLedgeHeight, InitialTraceImpactPoint, InitialTraceImpactNormal);
+		// A box taller than the trace would have the trace start inside of it. Trace it and every stage after it
+		if (Check.bUsesCollisionLedge && (EdgePoint.Z > Query.Start.Z - Query.Radius || EdgePoint.Z < Query.End.Z))
+		{
+			Check.bUsesCollisionLedge = false;
+			return false;
+		}
 
-	if (IsWalkableSurfaceReturnValue.bIsWalkable)
+		const double Inset = FVector::DotProduct(EdgePoint - Query.End, FVector(Ledge.Normal));
+		if (Inset >= 0.0 && Inset <= Ledge.Depth)
+		{
+			SetLedgeHit(OutHit, Query, FVector(Query.End.X, Query.End.Y, EdgePoint.Z), FVector::UpVector);
+		}
+		return true;
+	}
+	case ETraversalCheckStage::VaultReach:
 	{
-		WalkableImpactPoint = IsWalkableSurfaceReturnValue.WalkableImpactPoint;
-		ObjectStartWarpTarget = WalkableImpactPoint;
-		FVector MantleHeightVec = GetCapsuleLocationFromBaseLocation(WalkableImpactPoint) - PlayerCharacter->GetActorLocation();
-		MantleHeight = MantleHeightVec.Z;
-		UE_LOG(LogTemp, Display, TEXT("Mantle height: %f"), VaultHeight);
+		if (!Check.bUsesBakedLedge && !Check.bUsesCollisionLedge)
+			return false;
 
-		// Check if mantle height isn't higher than the max mantle ledge height
-		if (MantleHeight > MantleMaxLedgeHeight)
+		// The reach trace hits the face below the edge if it passes between the edge and the ground in front of it
+		const FTraversalTraceQuery Query = GetCheckQuery(Check);
+		const FVector LedgeNormal(Ledge.Normal);
+		double ReachTime, LedgeTime;
+		if (FVector::DotProduct(Query.End - Query.Start, LedgeNormal) >= 0.0 || !IntersectSegments2D(Query.Start, Query.End, Ledge.Start, Ledge.End, ReachTime, LedgeTime))
 		{
+			// Something else may be in reach. Trace it and every stage after it
+			Check.bUsesBakedLedge = false;
+			Check.bUsesCollisionLedge = false;
 			return false;
 		}
+
+		const double LedgeZ = FMath::Lerp(Ledge.Start.Z, Ledge.End.Z, LedgeTime);
+		if (Query.Start.Z <= LedgeZ && Query.Start.Z >= LedgeZ - Ledge.Height)
+		{
+			SetLedgeHit(OutHit, Query, FMath::Lerp(Query.Start, Query.End, ReachTime), LedgeNormal);
+		}
+		return true;
 	}
-	else
+	case ETraversalCheckStage::VaultDepth:
 	{
-		return false;
-	}
+		if (!Check.bUsesBakedLedge && !Check.bUsesCollisionLedge)
+			return false;
+
+		// The depth trace comes back along the forward vector and hits the far side of the obstacle, unless it starts inside of it
+		const FTraversalTraceQuery Query = GetCheckQuery(Check);
+		const FVector Forward = (Query.Start - Query.End).GetSafeNormal2D();
+		const double Across = Ledge.Depth / FMath::Max(-FVector::DotProduct(Forward, FVector(Ledge.Normal)), UE_KINDA_SMALL_NUMBER);
+		if (Across < FVector::Dist(Query.Start, Query.End))
+		{
+			SetLedgeHit(OutHit, Query, Query.End + Forward * Across, Forward);
+		}
+		return true;
+	}
+	case ETraversalCheckStage::VaultRoom:
+	{
+		if (!Check.bUsesBakedLedge)
+			return false;
+
+		if (!Ledge.bHasLandingRoom)
+		{
+			const FTraversalTraceQuery Query = GetCheckQuery(Check);
+			SetLedgeHit(OutHit, Query, Query.Start, FVector::UpVector);
+		}
+		return true;
+	}
+	case ETraversalCheckStage::VaultLand:
+	{
+		if (!Check.bUsesBakedLedge)
+			return false;
+
+		// The land trace hits the baked ground if it is within its reach
+		const FTraversalTraceQuery Query = GetCheckQuery(Check);
+		if (Ledge.bHasLandingRoom && Ledge.LandZ <= Query.Start.Z && Ledge.LandZ >= Query.End.Z)
+		{
+			SetLedgeHit(OutHit, Query, FVector(Query.Start.X, Query.Start.Y, Ledge.LandZ), FVector::UpVector);
+		}
+		return true;
+	}
+	default:
+		// The capsule path is always traced so dynamic objects in the way are detected
+		return false;
+	}
+}
+
+bool UTraversalComponent::RunCheck(FTraversalCheck& Check)
+{
+	if (FindCachedCheck(Check))
+	{
+		TRAVERSAL_DEBUG_CHECK_RESULT(GetOwner(), Check);
+		return Check.Stage == ETraversalCheckStage::Succeeded;
+	}
+
+	if (bUseParallelStages)
+	{
+		RunCheckParallel(Check);
+	}
+	else
+	{
+		while (!Check.IsFinished())
+		{
+			FHitResult Hit;
+			if (!ResolveFromLedge(Check, Hit))
+			{
+				SCOPE_CYCLE_COUNTER_STATID(GetTraversalTraceStatId(Check.Stage));
+				const FTraversalTraceQuery Query = GetCheckQuery(Check);
+				TraceSingle(Query, Hit);
+				++Check.NumTraces;
+				TRAVERSAL_DEBUG_CHECK_TRACE(GetOwner(), Check, Query, Hit);
+			}
+			AdvanceCheck(Check, Hit);
+		}
+	}
+
+	CacheCheck(Check);
+	TRAVERSAL_DEBUG_CHECK_RESULT(GetOwner(), Check);
+	return Check.Stage == ETraversalCheckStage::Succeeded;
+}
+
+// Trace of a stage run as a task.
+struct FTraversalStageTrace
+{
+	ETraversalCheckStage Stage = ETraversalCheckStage::Failed;
+	FTraversalTraceQuery Query;
+	FHitResult Hit;
+	bool bTraced = false;
+	UE::Tasks::FTask Task;
+};
+
+static bool AreQueriesEqual(const FTraversalTraceQuery& A, const FTraversalTraceQuery& B)
+{
+	return A.Shape == B.Shape && A.Start.Equals(B.Start) && A.End.Equals(B.End) && A.Radius == B.Radius && A.HalfHeight == B.HalfHeight;
+}
+
+void UTraversalComponent::RunCheckParallel(FTraversalCheck& Check)
+{
+	while (!Check.IsFinished())
+	{
+		FHitResult Hit;
+		if (ResolveFromLedge(Check, Hit))
+		{
+			AdvanceCheck(Check, Hit);
+			continue;
+		}
+
+		TArray<ETraversalCheckStage, TInlineAllocator<5>> Stages;
+		GetParallelStages(Check, Stages);
+
+		// Every query is built before any stage advances, so later stages get the same query the check would build once it reaches them
+		FTraversalStageTrace Traces[5];
+		const int32 NumTraces = FMath::Min(Stages.Num(), static_cast<int32>(UE_ARRAY_COUNT(Traces)));
+		for (int32 Index = 0; Index < NumTraces; ++Index)
+		{
+			FTraversalCheck StageCheck = Check;
+			StageCheck.Stage = Stages[Index];
+			Traces[Index].Stage = Stages[Index];
+			Traces[Index].Query = GetCheckQuery(StageCheck);
+		}
+
+		std::atomic<bool> bCancelled = false;
+		int32 NumWasted = 0;
+
+		// Each task takes its own read scope. The game thread doesn't hold the lock while it waits, so a pending writer can't deadlock against the tasks
+		FPhysScene* PhysicsScene = GetWorld()->GetPhysicsScene();
+		for (int32 Index = 0; Index < NumTraces; ++Index)
+		{
+			FTraversalStageTrace& Trace = Traces[Index];
+			Trace.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, PhysicsScene, &Trace, &bCancelled]()
+			{
+				if (bCancelled.load(std::memory_order_relaxed))
+					return;
+
+				SCOPE_CYCLE_COUNTER_STATID(GetTraversalTraceStatId(Trace.Stage));
+				FPhysicsCommand::ExecuteRead(PhysicsScene, [this, &Trace]()
+				{
+					TraceSingleThreadSafe(Trace.Query, Trace.Hit);
+				});
+				Trace.bTraced = true;
+			}, UE::Tasks::ETaskPriority::High);
+		}
+
+		// Feed the hits in stage order. Once the check rejects or leaves the stages traced ahead, the remaining traces aren't needed
+		for (int32 Index = 0; Index < NumTraces; ++Index)
+		{
+			FTraversalStageTrace& Trace = Traces[Index];
+			Trace.Task.Wait();
+
+			if (!bCancelled && (Check.IsFinished() || Check.Stage != Trace.Stage || !AreQueriesEqual(GetCheckQuery(Check), Trace.Query)))
+			{
+				bCancelled = true;
+			}
+
+			if (bCancelled)
+			{
+				NumWasted += Trace.bTraced ? 1 : 0;
+				continue;
+			}
+
+			++Check.NumTraces;
+			TRAVERSAL_DEBUG_CHECK_TRACE(GetOwner(), Check, Trace.Query, Trace.Hit);
+			AdvanceCheck(Check, Trace.Hit);
+		}
+
+		INC_DWORD_STAT_BY(STAT_TraversalParallelTracesWasted, NumWasted);
+	}
+}
+
+void UTraversalComponent::GetParallelStages(const FTraversalCheck& Check, TArray<ETraversalCheckStage, TInlineAllocator<5>>& OutStages) const
+{
+	OutStages.Add(Check.Stage);
+
+	switch (Check.Stage)
+	{
+	case ETraversalCheckStage::SurfaceWalkable:
+		// The reach trace only depends on the pose, not on the height of the ledge. Ledges resolve it without tracing
+		if ((Check.Action == ETraversalState::Vaulting || (Check.bIsUnified && Check.bCanVault)) && !Check.bUsesBakedLedge && !Check.bUsesCollisionLedge)
+		{
+			OutStages.Add(ETraversalCheckStage::VaultReach);
+		}
+		break;
+	case ETraversalCheckStage::VaultRoom:
+		// Both start from the far side of the obstacle
+		OutStages.Add(ETraversalCheckStage::VaultLand);
+		break;
+	case ETraversalCheckStage::WallForward:
+		// The room traces only depend on the pose
+		OutStages.Add(ETraversalCheckStage::WallRoomTop);
+		OutStages.Add(ETraversalCheckStage::WallRoomBottom);
+		OutStages.Add(ETraversalCheckStage::WallRoomRight);
+		OutStages.Add(ETraversalCheckStage::WallRoomLeft);
+		break;
+	default:
+		break;
+	}
+}
+
+bool UTraversalComponent::ReplayCheck(FTraversalCheck& Check, TConstArrayView<FTraversalCaptureStep> Steps) const
+{
+	for (const FTraversalCaptureStep& Step : Steps)
+	{
+		if (Check.IsFinished() || Check.Stage != Step.Stage || !AreQueriesEqual(GetCheckQuery(Check), Step.Query))
+			return false;
+
+		AdvanceCheck(Check, Step.Hit, &Step);
+	}
+
+	return true;
+}
+
+bool FTraversalTraceContext::TraceSingle(const FTraversalTraceQuery& Query, FHitResult& OutHit) const
+{
+	if (Query.Shape == ETraversalTraceShape::Line)
+	{
+		return World->LineTraceSingleByChannel(OutHit, Query.Start, Query.End, Channel, QueryParams);
+	}
+
+	return World->SweepSingleByChannel(OutHit, Query.Start, Query.End, FQuat::Identity, Channel, Query.GetCollisionShape(), QueryParams);
+}
+
+bool UTraversalComponent::TraceSingle(const FTraversalTraceQuery& Query, FHitResult& OutHit)
+{
+	CountTraversalTrace();
+	return TraceContext.TraceSingle(Query, OutHit);
+}
+
+bool UTraversalComponent::TraceSingleThreadSafe(const FTraversalTraceQuery& Query, FHitResult& OutHit) const
+{
+	CountTraversalTrace();
+	return TraceContext.TraceSingle(Query, OutHit);
+}
+
+void UTraversalComponent::RunCheckThreadSafe(FTraversalCheck& Check) const
+{
+	while (!Check.IsFinished())
+	{
+		FHitResult Hit;
+		if (!ResolveFromLedge(Check, Hit))
+		{
+			SCOPE_CYCLE_COUNTER_STATID(GetTraversalTraceStatId(Check.Stage));
+			TraceSingleThreadSafe(GetCheckQuery(Check), Hit);
+			++Check.NumTraces;
+		}
+		AdvanceCheck(Check, Hit);
+	}
+}
+
+bool UTraversalComponent::CommitPlan(const FTraversalPlan& Plan)
+{
+	const FTraversalBakedRootMotion* BakedRootMotion = FindBakedRootMotion(Plan);
+
+	// The selected montage is streamed. If it isn't resident yet, the player's input and received plans still start the action, at the cost of a hitch. Actions following baked root motion don't play it
+	if ((Plan.Action == ETraversalState::Vaulting || Plan.Action == ETraversalState::Mantling) && !BakedRootMotion && !Plan.AnimationProperties.Animation.Get())
+	{
+		UE_LOG(LogTraversal, Warning, TEXT("%s loads %s montage %s synchronously, it wasn't preloaded"), *GetNameSafe(GetOwner()), *UEnum::GetValueAsString(Plan.Action), *Plan.AnimationProperties.Animation.ToString());
+		if (!Plan.AnimationProperties.Animation.LoadSynchronous())
+			return false;
+
+		// Stream in the other montages of the action, so the next attempts don't hitch as well
+		PreloadMontages(Plan.Action);
+	}
+
+	// The character leaves its current pose, so nothing cached or armed will be hit again
+	InvalidateCheckCache();
+	ArmedPlans.Reset();
+
+	switch (Plan.Action)
+	{
+	case ETraversalState::Vaulting:
+		ObjectStartWarpTarget = Plan.ObjectStartWarpTarget;
+		ObjectEndWarpTarget = Plan.ObjectEndWarpTarget;
+		LandWarpTarget = Plan.LandWarpTarget;
+		VaultHeight = Plan.Height;
+		VaultStart(Plan.AnimationProperties.Animation.Get(), Plan.AnimationProperties.AnimationEndBlendTime, BakedRootMotion);
+		ReplicatePlan(Plan);
+		return true;
+	case ETraversalState::Mantling:
+		ObjectStartWarpTarget = Plan.ObjectStartWarpTarget;
+		MantleHeight = Plan.Height;
+		MantleStart(Plan.AnimationProperties, BakedRootMotion);
+		ReplicatePlan(Plan);
+		return true;
+	case ETraversalState::WallClimbing:
+		WallPatch = Plan.WallPatch;
+		WallClimbStart(Plan.WallHit);
+		return true;
+	default:
+		return false;
+	}
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeRoomForCapsuleQuery(const FTraversalPose& Pose, FVector Location) const
+{
+	const float HalfHeightWithoutHemisphere = FMath::Max(Pose.CapsuleHalfHeight - Pose.CapsuleRadius, 0.0f);
+
+	FTraversalTraceQuery Query;
+	Query.Shape = ETraversalTraceShape::Sphere;
+	Query.Start = Location + FVector(0.0f, 0.0f, HalfHeightWithoutHemisphere);
+	Query.End = Location - FVector(0.0f, 0.0f, HalfHeightWithoutHemisphere);
+	Query.Radius = Pose.CapsuleRadius;
+	return Query;
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeObjectClimbableQuery(const FTraversalPose& Pose, float ReachDistance, float MinLedgeHeight, float MaxLedgeHeight) const
+{
+	FTraversalTraceQuery Query;
+	Query.Shape = ETraversalTraceShape::Capsule;
+	Query.Start = (Pose.CapsuleBaseLocation + Pose.MovementInput * -15.0f) + FVector(0.0f, 0.0f, (MinLedgeHeight + MaxLedgeHeight) / 2);
+	Query.End = Query.Start + Pose.MovementInput * ReachDistance;
+	Query.Radius = 5.0f;
+	Query.HalfHeight = (MaxLedgeHeight - MinLedgeHeight) / 2;
+	return Query;
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeSurfaceWalkableQuery(const FTraversalPose& Pose, float MaxLedgeHeight, FVector InitialImpactPoint) const
+{
+	FTraversalTraceQuery Query;
+	Query.Shape = ETraversalTraceShape::Sphere;
+	Query.End = Pose.MovementInput * 15.0f + FVector(InitialImpactPoint.X, InitialImpactPoint.Y, Pose.CapsuleBaseLocation.Z);
+	Query.Start = Query.End + FVector(0.0f, 0.0f, MaxLedgeHeight + 30.0f);
+	Query.Radius = 5.0f;
+	return Query;
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeCapsulePathQuery(const FTraversalPose& Pose, float Height, FVector EndTargetLocation) const
+{
+	FTraversalTraceQuery Query;
+	Query.Shape = ETraversalTraceShape::Capsule;
+	Query.Start = Pose.Location + Pose.UpVector * Height;
+	Query.End = GetPoseCapsuleLocation(Pose, EndTargetLocation);
+	Query.Radius = Pose.CapsuleRadius;
+	Query.HalfHeight = Pose.CapsuleHalfHeight;
+	return Query;
+}
+
+FAnimationProperties UTraversalComponent::SelectAnimation(const FTraversalPlan& Plan, const FTraversalPose& Pose) const
+{
+	const UTraversalAnimationTable* AnimationTable = Config->GetAnimations(Plan.Action);
+	if (!AnimationTable)
+		return FAnimationProperties();
+
+	FTraversalAnimationQuery Query;
+	Query.Height = Plan.Height;
+	Query.Depth = Plan.Action == ETraversalState::Vaulting ? Plan.Depth : 0.0f;
+	Query.Speed = static_cast<float>(Pose.Velocity.Size2D());
+	Query.ApproachAngle = Plan.ApproachAngle;
+	return AnimationTable->SelectAnimation(Query);
+}
+
+
+/***** Vault *****/
+
+bool UTraversalComponent::VaultCheck()
+{
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalVaultCheck);
+
+	if (!CanStartCheck(ETraversalState::Vaulting))
+		return false;
+
+	if (CommitArmedPlan(ETraversalState::Vaulting) != ETraversalState::None)
+		return true;
+
+	FTraversalCheck Check = BeginCheck(ETraversalState::Vaulting);
+
+	return RunCheck(Check) && CommitPlan(Check.Plan);
+}
+
+bool UTraversalComponent::VaultCheckAsync()
+{
+	return StartAsyncCheck(ETraversalState::Vaulting);
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeVaultReachQuery(const FTraversalPose& Pose) const
+{
+	FTraversalTraceQuery Query;
+	Query.Start = Pose.Location;
+	Query.End = Query.Start + Pose.ForwardVector * Config->VaultReachDistance;
+	return Query;
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeVaultDepthQuery(const FTraversalPose& Pose, FVector ReachImpactPoint) const
+{
+	FTraversalTraceQuery Query;
+	Query.Start = ReachImpactPoint + Pose.ForwardVector * Config->VaultMaxDepth;
+	Query.End = ReachImpactPoint;
+	return Query;
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeVaultLandQuery(const FTraversalPose& Pose, FVector ObjectEndPoint) const
+{
+	FTraversalTraceQuery Query;
+	Query.Start = ObjectEndPoint + Pose.ForwardVector * Config->VaultLandDistance;
+	Query.End = Query.Start - FVector(0.0f, 0.0f, Config->VaultMaxLandVerticalDistance);
+	return Query;
+}
+
+void UTraversalComponent::VaultStart(UAnimMontage* VaultAnimation, float AnimationEndBlendTime, const FTraversalBakedRootMotion* BakedRootMotion)
+{
+	CountTraversalActionStarted();
+
+	TraversalState = ETraversalState::Vaulting;
+
+	// Set player movement mode and add warp targets
+	SetActionMovementMode(TraversalState);
+	if (BakedRootMotion)
+	{
+		const TPair<FName, FVector> WarpTargets[] = {
+			MakeTuple(Config->VaultObjectStartWarpTargetName, ObjectStartWarpTarget),
+			MakeTuple(Config->VaultObjectEndWarpTargetName, ObjectEndWarpTarget),
+			MakeTuple(Config->VaultLandWarpTargetName, LandWarpTarget) };
+
+		StartBakedAction(*BakedRootMotion, 0.0f, AnimationEndBlendTime, WarpTargets);
+		return;
+	}
+
+	UMotionWarpingComponent* PlayerMotionWarpingComponent = PlayerCharacter->FindComponentByClass<UMotionWarpingComponent>();
+	if (IsValid(PlayerMotionWarpingComponent))
+	{
+		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(Config->VaultObjectStartWarpTargetName, ObjectStartWarpTarget, PlayerCharacter->GetActorRotation());
+		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(Config->VaultObjectEndWarpTargetName, ObjectEndWarpTarget, PlayerCharacter->GetActorRotation());
+		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(Config->VaultLandWarpTargetName, LandWarpTarget, PlayerCharacter->GetActorRotation());
+
+		StartActionMontage(VaultAnimation, 0.0f, AnimationEndBlendTime);
+	}
+}
+
+
+/***** Mantle *****/
+
+bool UTraversalComponent::MantleCheck()
+{
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalMantleCheck);
+
+	if (!CanStartCheck(ETraversalState::Mantling))
+	{
+		return false;
+	}
+
+	if (CommitArmedPlan(ETraversalState::Mantling) != ETraversalState::None)
+		return true;
+
+	FTraversalCheck Check = BeginCheck(ETraversalState::Mantling);
+
+	return RunCheck(Check) && CommitPlan(Check.Plan);
+}
+
+bool UTraversalComponent::MantleCheckAsync()
+{
+	return StartAsyncCheck(ETraversalState::Mantling);
+}
+
+
+/***** Vault and mantle *****/
+
+ETraversalState UTraversalComponent::EvaluateTraversal()
+{
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalEvaluate);
+
+	if (!CanStartCheck(ETraversalState::None))
+		return ETraversalState::None;
+
+	const ETraversalState ArmedAction = CommitArmedPlan(ETraversalState::None);
+	if (ArmedAction != ETraversalState::None)
+		return ArmedAction;
+
+	FTraversalCheck Check = BeginCheck(ETraversalState::None);
+
+	return RunCheck(Check) && CommitPlan(Check.Plan) ? Check.Action : ETraversalState::None;
+}
+
+bool UTraversalComponent::EvaluateTraversalAsync()
+{
+	return StartAsyncCheck(ETraversalState::None);
+}
+
+float UTraversalComponent::ApplyMantleHeightOffset(float HeightOffset)
+{
+	return PlayerCapsule->GetScaledCapsuleHalfHeight() * 2 - HeightOffset;
+}
+
+void UTraversalComponent::MantleStart(const FAnimationProperties& AnimationProperties, const FTraversalBakedRootMotion* BakedRootMotion)
+{
+	CountTraversalActionStarted();
+
+	TraversalState = ETraversalState::Mantling;
+
+	// Set player movement mode and add warp target
+	SetActionMovementMode(TraversalState);
+	FVector TargetLocation = ObjectStartWarpTarget - FVector(0.0f, 0.0f, ApplyMantleHeightOffset(AnimationProperties.AnimationHeightOffset));
+	if (BakedRootMotion)
+	{
+		const TPair<FName, FVector> WarpTargets[] = { MakeTuple(Config->MantleWarpTargetName, TargetLocation) };
+
+		StartBakedAction(*BakedRootMotion, AnimationProperties.AnimationStartingPosition, AnimationProperties.AnimationEndBlendTime, WarpTargets);
+		return;
+	}
+
+	UMotionWarpingComponent* PlayerMotionWarpingComponent = PlayerCharacter->FindComponentByClass<UMotionWarpingComponent>();
+	if (IsValid(PlayerMotionWarpingComponent))
+	{
+		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(Config->MantleWarpTargetName, TargetLocation, PlayerCharacter->GetActorRotation());
+
+		StartActionMontage(AnimationProperties.Animation.Get(), AnimationProperties.AnimationStartingPosition, AnimationProperties.AnimationEndBlendTime);
+	}
+}
+
+
+/***** Action montages *****/
+
+int32 UTraversalComponent::PlayMontage(UAnimMontage* Montage, float StartingPosition, void (UTraversalComponent::*OnCompleted)(UAnimMontage*, bool, int32))
+{
+	UAnimInstance* AnimInstance = PlayerCharacter->GetMesh()->GetAnimInstance();
+	if (!AnimInstance || AnimInstance->Montage_Play(Montage, 1.0f, EMontagePlayReturnType::Duration, StartingPosition, true) <= 0.0f)
+		return INDEX_NONE;
+
+	const FAnimMontageInstance* MontageInstance = AnimInstance->GetActiveInstanceForMontage(Montage);
+	if (!MontageInstance)
+		return INDEX_NONE;
+
+	// The events carry the instance ID, so events of an earlier play of the same montage can be told apart
+	const int32 InstanceID = MontageInstance->GetInstanceID();
+	FOnMontageBlendingOutStarted BlendingOutDelegate = FOnMontageBlendingOutStarted::CreateUObject(this, OnCompleted, InstanceID);
+	AnimInstance->Montage_SetBlendingOutDelegate(BlendingOutDelegate, Montage);
+	FOnMontageEnded EndedDelegate = FOnMontageEnded::CreateUObject(this, OnCompleted, InstanceID);
+	AnimInstance->Montage_SetEndDelegate(EndedDelegate, Montage);
+
+	return InstanceID;
+}
+
+void UTraversalComponent::StartActionMontage(UAnimMontage* Montage, float StartingPosition, float AnimationEndBlendTime)
+{
+	const int32 InstanceID = PlayMontage(Montage, StartingPosition, &UTraversalComponent::OnActionMontageCompleted);
+	if (InstanceID == INDEX_NONE)
+	{
+		FinishAction(true);
+		return;
+	}
+
+	ActiveAction.Action = TraversalState;
+	ActiveAction.Montage = Montage;
+	ActiveAction.MontageInstanceID = InstanceID;
+	ActiveAction.ExitPosition = Montage->GetPlayLength() - AnimationEndBlendTime;
+	ActiveAction.bHasExitWindow = Montage->Notifies.ContainsByPredicate([](const FAnimNotifyEvent& Notify)
+		{
+			return Cast<UAnimNotifyState_TraversalExitWindow>(Notify.NotifyStateClass) != nullptr;
+		});
+
+	// Without an exit window the montage position is watched every frame, so the action ends at the same point of the montage regardless of hitches and time dilation
+	if (!ActiveAction.bHasExitWindow && AnimationEndBlendTime > 0.0f)
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+const FTraversalBakedRootMotion* UTraversalComponent::FindBakedRootMotion(const FTraversalPlan& Plan) const
+{
+	if (Plan.Action != ETraversalState::Vaulting && Plan.Action != ETraversalState::Mantling)
+		return nullptr;
+
+	// Servers move the character in its movement update, so they need the traversal movement component. Simulated proxies move it when the component ticks
+	const bool bOnServer = bUseBakedRootMotionOnServer && TraversalMovement && GetNetMode() == NM_DedicatedServer;
+	const bool bOnProxy = GetLODSettings().bUseBakedRootMotion && PlayerCharacter->GetLocalRole() == ROLE_SimulatedProxy;
+	if (!bOnServer && !bOnProxy)
+		return nullptr;
+
+	const UTraversalAnimationTable* AnimationTable = Config->GetAnimations(Plan.Action);
+	return AnimationTable ? AnimationTable->GetBakedRootMotion(Plan.AnimationProperties.EntryIndex) : nullptr;
+}
+
+// Fraction of a warp window's correction applied at a montage position. Windows that began before the action started are spread over the part that is left
+static float GetWarpWindowAlpha(const FTraversalBakedWarpWindow& Window, float StartPosition, float Position)
+{
+	const float WindowStart = FMath::Max(Window.StartTime, StartPosition);
+	if (Window.EndTime <= WindowStart)
+		return 1.0f;
+
+	return FMath::Clamp((Position - WindowStart) / (Window.EndTime - WindowStart), 0.0f, 1.0f);
+}
+
+void UTraversalComponent::StartBakedAction(const FTraversalBakedRootMotion& BakedRootMotion, float StartingPosition, float AnimationEndBlendTime, TConstArrayView<TPair<FName, FVector>> WarpTargets)
+{
+	USkeletalMeshComponent* Mesh = PlayerCharacter->GetMesh();
+
+	ActiveAction.Action = TraversalState;
+	ActiveAction.BakedRootMotion = &BakedRootMotion;
+	ActiveAction.StartPosition = FMath::Clamp(StartingPosition, 0.0f, BakedRootMotion.PlayLength);
+	ActiveAction.Position = ActiveAction.StartPosition;
+	ActiveAction.bHasExitWindow = BakedRootMotion.ExitWindowEndTime >= 0.0f;
+	ActiveAction.ExitPosition = FMath::Max(ActiveAction.bHasExitWindow ? BakedRootMotion.ExitWindowEndTime : BakedRootMotion.PlayLength - AnimationEndBlendTime, ActiveAction.StartPosition);
+	ActiveAction.StartRotation = PlayerCharacter->GetActorQuat();
+	ActiveAction.bMovedByMovementComponent = TraversalMovement && PlayerCharacter->GetLocalRole() != ROLE_SimulatedProxy;
+
+	// Root motion is baked in the space of the mesh, relative to the start of the montage. Map the starting position's root onto the root of the character
+	const FQuat StartYaw(FVector::UpVector, FMath::DegreesToRadians(BakedRootMotion.SampleYaw(ActiveAction.StartPosition)));
+	const FVector StartRootLocation = PlayerCharacter->GetActorLocation() + ActiveAction.StartRotation.RotateVector(PlayerCharacter->GetBaseTranslationOffset());
+	ActiveAction.RootMotionToWorld = FTransform(ActiveAction.StartRotation * PlayerCharacter->GetBaseRotationOffset() * StartYaw.Inverse(), FVector::ZeroVector, Mesh->GetComponentScale());
+	ActiveAction.RootMotionToWorld.SetTranslation(StartRootLocation - ActiveAction.RootMotionToWorld.TransformPosition(FVector(BakedRootMotion.SampleTranslation(ActiveAction.StartPosition))));
+
+	// Bend the root motion linearly over each warp window so the root reaches its target at the end of the window, like motion warping's skew warp
+	ActiveAction.WarpCorrections.Reset();
+	for (const FTraversalBakedWarpWindow& Window : BakedRootMotion.WarpWindows)
+	{
+		FVector& Correction = ActiveAction.WarpCorrections.Add_GetRef(FVector::ZeroVector);
+
+		const TPair<FName, FVector>* WarpTarget = WarpTargets.FindByPredicate([&Window](const TPair<FName, FVector>& Target)
+			{
+				return Target.Key == Window.WarpTargetName;
+			});
+		if (!WarpTarget || Window.EndTime <= ActiveAction.StartPosition)
+			continue;
+
+		// Earlier windows have moved the root already by the end of this one
+		FVector RootLocation = ActiveAction.RootMotionToWorld.TransformPosition(FVector(BakedRootMotion.SampleTranslation(Window.EndTime)));
+		for (int32 Index = 0; Index < ActiveAction.WarpCorrections.Num() - 1; ++Index)
+		{
+			RootLocation += ActiveAction.WarpCorrections[Index] * GetWarpWindowAlpha(BakedRootMotion.WarpWindows[Index], ActiveAction.StartPosition, Window.EndTime);
+		}
+
+		Correction = WarpTarget->Value - RootLocation;
+	}
+
+	// Nothing is animated during the action, so the mesh doesn't need to tick
+	ActiveAction.bMeshTickWasEnabled = Mesh->IsComponentTickEnabled();
+	Mesh->SetComponentTickEnabled(false);
+
+	if (!ActiveAction.bMovedByMovementComponent)
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+bool UTraversalComponent::AdvanceBakedAction(float DeltaTime, FVector& OutLocation, FQuat& OutRotation)
+{
+	ActiveAction.Position = FMath::Min(ActiveAction.Position + DeltaTime, ActiveAction.ExitPosition);
+	GetBakedActionTransform(ActiveAction.Position, OutLocation, OutRotation);
+
+	// Like UAnimNotifyState_TraversalExitWindow, the action ends in its exit window once there is movement input. The acceleration is the input of the move being simulated, also on the server
+	const bool bExitedInWindow = ActiveAction.bHasExitWindow && ActiveAction.Position >= ActiveAction.BakedRootMotion->ExitWindowStartTime
+		&& PlayerCharacter->GetLocalRole() != ROLE_SimulatedProxy && !PlayerCharacterMovement->GetCurrentAcceleration().IsNearlyZero();
+
+	// Proxies have no input and end the action when the server does
+	if (bExitedInWindow && PlayerCharacter->HasAuthority())
+	{
+		MulticastExitAction(ActiveAction.Action, ActionBlendOutTime);
+	}
+
+	return ActiveAction.Position < ActiveAction.ExitPosition && !bExitedInWindow;
+}
+
+void UTraversalComponent::GetBakedActionTransform(float Position, FVector& OutLocation, FQuat& OutRotation) const
+{
+	const FTraversalBakedRootMotion& BakedRootMotion = *ActiveAction.BakedRootMotion;
+
+	FVector RootLocation = ActiveAction.RootMotionToWorld.TransformPosition(FVector(BakedRootMotion.SampleTranslation(Position)));
+	for (int32 Index = 0; Index < ActiveAction.WarpCorrections.Num(); ++Index)
+	{
+		RootLocation += ActiveAction.WarpCorrections[Index] * GetWarpWindowAlpha(BakedRootMotion.WarpWindows[Index], ActiveAction.StartPosition, Position);
+	}
+
+	const float DeltaYaw = BakedRootMotion.SampleYaw(Position) - BakedRootMotion.SampleYaw(ActiveAction.StartPosition);
+	OutRotation = ActiveAction.StartRotation * FQuat(FVector::UpVector, FMath::DegreesToRadians(DeltaYaw));
+	OutLocation = RootLocation - OutRotation.RotateVector(PlayerCharacter->GetBaseTranslationOffset());
+}
+
+void UTraversalComponent::UpdateBakedAction(float DeltaTime)
+{
+	FVector Location;
+	FQuat Rotation;
+	const bool bContinues = AdvanceBakedAction(DeltaTime, Location, Rotation);
+
+	// Objects may have moved into the path since the check, so the move is swept
+	PlayerCharacter->SetActorLocationAndRotation(Location, Rotation, true);
+
+	// Simulated proxies would otherwise keep moving with the velocity they had before the action
+	PlayerCharacterMovement->Velocity = FVector::ZeroVector;
+
+	// Something stands in the way if the character fell behind the root motion by more than its radius
+	const bool bBlocked = FVector::DistSquared(PlayerCharacter->GetActorLocation(), Location) > FMath::Square(PlayerCapsule->GetScaledCapsuleRadius());
+	if (bBlocked || !bContinues)
+	{
+		FinishAction(bBlocked);
+	}
+}
+
+void UTraversalComponent::UpdateActionExit()
+{
+	if (ActiveAction.bHasExitWindow)
+	{
+		if (ActiveAction.bInExitWindow)
+		{
+			TryExitAction(ActiveAction.Montage, true, ActiveAction.ExitWindowBlendOutTime);
+		}
+		return;
+	}
+
+	UAnimInstance* AnimInstance = PlayerCharacter->GetMesh()->GetAnimInstance();
+	const FAnimMontageInstance* MontageInstance = AnimInstance ? AnimInstance->GetMontageInstanceForID(ActiveAction.MontageInstanceID) : nullptr;
+	if (MontageInstance && MontageInstance->GetPosition() >= ActiveAction.ExitPosition)
+	{
+		ExitAction(ActionBlendOutTime, false);
+	}
+}
+
+void UTraversalComponent::BeginExitWindow(const UAnimSequenceBase* Montage, float BlendOutTime)
+{
+	if (ActiveAction.MontageInstanceID == INDEX_NONE || ActiveAction.Montage != Montage)
+		return;
+
+	ActiveAction.bInExitWindow = true;
+	ActiveAction.ExitWindowBlendOutTime = BlendOutTime;
+
+	// Simulated proxies have no input to poll
+	if (PlayerCharacter->GetLocalRole() != ROLE_SimulatedProxy)
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+bool UTraversalComponent::TryExitAction(const UAnimSequenceBase* Montage, bool bRequireInput, float BlendOutTime)
+{
+	if (ActiveAction.MontageInstanceID == INDEX_NONE || ActiveAction.Montage != Montage)
+		return false;
+
+	if (bRequireInput)
+	{
+		// Like the baked actions, the acceleration is the input of the move being simulated, also on the server. Proxies have none and wait for the server
+		if (PlayerCharacter->GetLocalRole() == ROLE_SimulatedProxy || PlayerCharacterMovement->GetCurrentAcceleration().IsNearlyZero())
+			return false;
+
+		if (PlayerCharacter->HasAuthority())
+		{
+			MulticastExitAction(ActiveAction.Action, BlendOutTime);
+		}
+	}
+
+	ExitAction(BlendOutTime, false);
+	return true;
+}
+
+void UTraversalComponent::CancelAction()
+{
+	if (ActiveAction.Action != ETraversalState::None)
+	{
+		ExitAction(ActionBlendOutTime, true);
+	}
+}
+
+void UTraversalComponent::ExitAction(float BlendOutTime, bool bInterrupted)
+{
+	const int32 InstanceID = ActiveAction.MontageInstanceID;
+
+	// Finish first, so the blending out event of the stopped montage is stale when it arrives
+	FinishAction(bInterrupted);
+
+	UAnimInstance* AnimInstance = PlayerCharacter->GetMesh()->GetAnimInstance();
+	if (FAnimMontageInstance* MontageInstance = AnimInstance ? AnimInstance->GetMontageInstanceForID(InstanceID) : nullptr)
+	{
+		FAlphaBlend BlendOut = MontageInstance->Montage->BlendOut;
+		BlendOut.SetBlendTime(BlendOutTime);
+		MontageInstance->Stop(BlendOut, bInterrupted);
+	}
+}
+
+void UTraversalComponent::OnActionMontageCompleted(UAnimMontage* Montage, bool bInterrupted, int32 InstanceID)
+{
+	if (InstanceID == ActiveAction.MontageInstanceID)
+	{
+		FinishAction(bInterrupted);
+	}
+}
+
+void UTraversalComponent::FinishAction(bool bInterrupted)
+{
+	UE_VLOG(GetOwner(), LogTraversal, Log, TEXT("%s %s"), *UEnum::GetValueAsString(TraversalState), bInterrupted ? TEXT("interrupted") : TEXT("completed"));
+
+	if (ActiveAction.BakedRootMotion && ActiveAction.bMeshTickWasEnabled)
+	{
+		PlayerCharacter->GetMesh()->SetComponentTickEnabled(true);
+	}
+
+	ActiveAction = FTraversalActiveAction();
+	SetComponentTickEnabled(false);
+	SetActionMovementMode(ETraversalState::None);
+	TraversalState = ETraversalState::None;
+
+	if (bMovementReplicationPaused)
+	{
+		PlayerCharacter->SetReplicateMovement(true);
+		bMovementReplicationPaused = false;
+	}
+}
+
+
+/***** Movement modes *****/
+
+void UTraversalComponent::SetActionMovementMode(ETraversalState Action)
+{
+	if (TraversalMovement)
+	{
+		TraversalMovement->SetTraversalMode(Action);
+	}
+	else
+	{
+		PlayerCharacterMovement->SetMovementMode(Action == ETraversalState::None ? MOVE_Walking : MOVE_Flying);
+	}
+}
+
+bool UTraversalComponent::CanEnterClientTraversalMode(ETraversalState Mode)
+{
+	switch (Mode)
+	{
+	case ETraversalState::Vaulting:
+	case ETraversalState::Mantling:
+		// Started by ServerTraversalPlan, which rejects plans the server can't confirm
+		return ActiveAction.Action == Mode;
+	case ETraversalState::WallClimbing:
+		// Clients don't send wall climb plans, so the server looks for the wall itself
+		return TraversalState == ETraversalState::WallClimbing || WallClimbCheck();
+	default:
+		return false;
+	}
+}
+
+void UTraversalComponent::OnMovementModeChanged(ACharacter* Character, EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	// Slides are also entered on the server from client moves, and left by the movement update once too slow
+	const ETraversalState TraversalMode = TraversalMovement->GetTraversalMode();
+	const bool bSliding = TraversalMode == ETraversalState::Sliding;
+	if (bSliding && TraversalState == ETraversalState::None)
+	{
+		InvalidateCheckCache();
+		TraversalState = ETraversalState::Sliding;
+	}
+	else if (!bSliding && TraversalState == ETraversalState::Sliding)
+	{
+		TraversalState = ETraversalState::None;
+	}
+
+	// The server leaves the modes of a remote client's actions when the client's moves do
+	if (ActiveAction.Action != ETraversalState::None && TraversalMode != ActiveAction.Action)
+	{
+		CancelAction();
+	}
+	else if (TraversalState == ETraversalState::WallClimbing && TraversalMode != ETraversalState::WallClimbing)
+	{
+		TraversalState = ETraversalState::None;
+		WallPatch.Reset();
+	}
+}
+
+
+/***** Replication *****/
+
+static float GetServerWorldTime(const UWorld* World)
+{
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState ? static_cast<float>(GameState->GetServerWorldTimeSeconds()) : World->GetTimeSeconds();
+}
+
+bool FTraversalNetPlan::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Only vaults and mantles are sent
+	uint8 bIsVault = Action == ETraversalState::Vaulting;
+	Ar.SerializeBits(&bIsVault, 1);
+
+	uint32 PackedEntryIndex = static_cast<uint32>(FMath::Max(EntryIndex, 0));
+	Ar.SerializeIntPacked(PackedEntryIndex);
+
+	uint32 QuantizedHeight = static_cast<uint32>(FMath::Clamp(FMath::RoundToInt(Height), 0, static_cast<int32>(MAX_uint16)));
+	Ar.SerializeIntPacked(QuantizedHeight);
+
+	Ar << StartServerTime;
+
+	bOutSuccess = SerializePackedVector<1, 24>(ObjectStartWarpTarget, Ar);
+
+	// The vault targets are close to the object start, so their offsets pack into fewer bits than their locations
+	FVector ObjectEndOffset = ObjectEndWarpTarget - ObjectStartWarpTarget;
+	FVector LandOffset = LandWarpTarget - ObjectStartWarpTarget;
+	if (bIsVault)
+	{
+		bOutSuccess &= SerializePackedVector<1, 24>(ObjectEndOffset, Ar);
+		bOutSuccess &= SerializePackedVector<1, 24>(LandOffset, Ar);
+	}
+
+	if (Ar.IsLoading())
+	{
+		Action = bIsVault ? ETraversalState::Vaulting : ETraversalState::Mantling;
+		EntryIndex = static_cast<int32>(PackedEntryIndex);
+		Height = static_cast<float>(QuantizedHeight);
+		ObjectEndWarpTarget = bIsVault ? ObjectStartWarpTarget + ObjectEndOffset : FVector::ZeroVector;
+		LandWarpTarget = bIsVault ? ObjectStartWarpTarget + LandOffset : FVector::ZeroVector;
+	}
+
+	return true;
+}
+
+void UTraversalComponent::ReplicatePlan(const FTraversalPlan& Plan)
+{
+	if (!bReplicatePlans || ActiveAction.Action == ETraversalState::None || GetNetMode() == NM_Standalone)
+		return;
+
+	const ENetRole Role = PlayerCharacter->GetLocalRole();
+	if (Role == ROLE_SimulatedProxy)
+		return;
+
+	FTraversalNetPlan NetPlan;
+	NetPlan.Action = Plan.Action;
+	NetPlan.EntryIndex = Plan.AnimationProperties.EntryIndex;
+	NetPlan.StartServerTime = GetServerWorldTime(GetWorld());
+	NetPlan.Height = Plan.Height;
+	NetPlan.ObjectStartWarpTarget = Plan.ObjectStartWarpTarget;
+	NetPlan.ObjectEndWarpTarget = Plan.ObjectEndWarpTarget;
+	NetPlan.LandWarpTarget = Plan.LandWarpTarget;
+
+	if (Role == ROLE_Authority)
+	{
+		// Simulated proxies play the action from the plan, so the movement it produces isn't replicated until it ends
+		if (PlayerCharacter->IsReplicatingMovement())
+		{
+			PlayerCharacter->SetReplicateMovement(false);
+			bMovementReplicationPaused = true;
+		}
+
+		MulticastTraversalPlan(NetPlan);
+	}
+	else
+	{
+		ServerTraversalPlan(NetPlan);
+	}
+
+#if STATS || CSV_PROFILER
+	// The packed values take more or fewer bits depending on their magnitude, so every plan sent is measured
+	FNetBitWriter Writer(256);
+	bool bSerialized = true;
+	NetPlan.NetSerialize(Writer, nullptr, bSerialized);
+	const int32 NumBytes = static_cast<int32>(Writer.GetNumBytes());
+
+	CountTraversalNetPlan(NumBytes);
+	UE_LOG(LogTraversal, Verbose, TEXT("%s sent %s plan, %d bytes"), *GetNameSafe(GetOwner()), *UEnum::GetValueAsString(Plan.Action), NumBytes);
+#endif
+}
+
+void UTraversalComponent::ApplyNetPlan(const FTraversalNetPlan& NetPlan, bool bCatchUp)
+{
+	const UTraversalAnimationTable* AnimationTable = Config->GetAnimations(NetPlan.Action);
+	if (!AnimationTable)
+	{
+		UE_LOG(LogTraversal, Warning, TEXT("%s has no %s animations and ignored a received plan"), *GetNameSafe(GetOwner()), *UEnum::GetValueAsString(NetPlan.Action));
+		return;
+	}
+
+	FTraversalPlan Plan;
+	Plan.Action = NetPlan.Action;
+	Plan.ObjectStartWarpTarget = NetPlan.ObjectStartWarpTarget;
+	Plan.ObjectEndWarpTarget = NetPlan.ObjectEndWarpTarget;
+	Plan.LandWarpTarget = NetPlan.LandWarpTarget;
+	Plan.Height = NetPlan.Height;
+	Plan.AnimationProperties = AnimationTable->MakeAnimationProperties(NetPlan.EntryIndex, NetPlan.Height);
+	if (Plan.AnimationProperties.Animation.IsNull())
+	{
+		UE_LOG(LogTraversal, Warning, TEXT("%s ignored a received %s plan with unknown entry %d"), *GetNameSafe(GetOwner()), *UEnum::GetValueAsString(NetPlan.Action), NetPlan.EntryIndex);
+		return;
+	}
+
+	// A proxy may still be finishing its previous action. Montages that aren't resident are loaded by CommitPlan
+	CancelAction();
+
+	if (!CommitPlan(Plan))
+	{
+		UE_LOG(LogTraversal, Error, TEXT("%s couldn't start a received %s plan"), *GetNameSafe(GetOwner()), *UEnum::GetValueAsString(NetPlan.Action));
+		return;
+	}
+
+	if (!bCatchUp)
+		return;
+
+	const float ElapsedTime = GetServerWorldTime(GetWorld()) - NetPlan.StartServerTime;
+	if (ActiveAction.BakedRootMotion)
+	{
+		ActiveAction.Position = FMath::Clamp(ActiveAction.Position + ElapsedTime, ActiveAction.StartPosition, ActiveAction.ExitPosition);
+		return;
+	}
+
+	UAnimInstance* AnimInstance = PlayerCharacter->GetMesh()->GetAnimInstance();
+	FAnimMontageInstance* MontageInstance = AnimInstance ? AnimInstance->GetMontageInstanceForID(ActiveAction.MontageInstanceID) : nullptr;
+	if (MontageInstance && ElapsedTime > 0.0f)
+	{
+		MontageInstance->SetPosition(FMath::Min(MontageInstance->GetPosition() + ElapsedTime, ActiveAction.ExitPosition));
+	}
+}
+
+bool UTraversalComponent::IsClientNetPlanValid(const FTraversalNetPlan& NetPlan)
+{
+	const FTraversalPose Pose = CapturePose();
+	if (FVector::DistSquared(NetPlan.ObjectStartWarpTarget, Pose.Location) > FMath::Square(NetPlanMaxDistance))
+		return false;
+
+	// The height is measured from the character to the ledge, the same way the check does
+	const bool bIsVault = NetPlan.Action == ETraversalState::Vaulting;
+	const float MinHeight = bIsVault ? Config->VaultMinLedgeHeight : Config->MantleMinLedgeHeight;
+	const float MaxHeight = bIsVault ? Config->VaultMaxLedgeHeight : Config->MantleMaxLedgeHeight;
+	const float LedgeHeight = (GetPoseCapsuleLocation(Pose, NetPlan.ObjectStartWarpTarget) - Pose.Location).Z;
+	if (NetPlan.Height < MinHeight - NetPlanTolerance || NetPlan.Height > MaxHeight + NetPlanTolerance || FMath::Abs(LedgeHeight - NetPlan.Height) > NetPlanTolerance)
+		return false;
+
+	// The entry must be one the check could have selected for the height
+	const UTraversalAnimationTable* AnimationTable = Config->GetAnimations(NetPlan.Action);
+	if (!AnimationTable || !AnimationTable->Entries.IsValidIndex(NetPlan.EntryIndex))
+		return false;
+
+	const FAnimationPropertySettings& Settings = AnimationTable->Entries[NetPlan.EntryIndex].Settings;
+	if (NetPlan.Height < Settings.AnimationMinHeight - NetPlanTolerance || NetPlan.Height > Settings.AnimationMaxHeight + NetPlanTolerance)
+		return false;
+
+	if (bIsVault)
+	{
+		// The object end is found within the max depth of the reach point below the ledge, and the landing below a point the land distance past the object end
+		const FVector ObjectEndOffset = NetPlan.ObjectEndWarpTarget - NetPlan.ObjectStartWarpTarget;
+		if (ObjectEndOffset.Size2D() > Config->VaultMaxDepth + NetPlanTolerance || FMath::Abs(ObjectEndOffset.Z) > Config->VaultMaxLedgeHeight + NetPlanTolerance)
+			return false;
+
+		const FVector LandOffset = NetPlan.LandWarpTarget - NetPlan.ObjectEndWarpTarget;
+		if (LandOffset.Size2D() > Config->VaultLandDistance + NetPlanTolerance || LandOffset.Z > NetPlanTolerance || LandOffset.Z < -(Config->VaultMaxLandVerticalDistance + NetPlanTolerance))
+			return false;
+	}
+
+	// Sweep the path on the server, so the plan can't move the character through geometry
+	const FVector EndTargetLocation = bIsVault ? NetPlan.LandWarpTarget + FVector(0.0f, 0.0f, NetPlan.Height) : NetPlan.ObjectStartWarpTarget;
+	FHitResult Hit;
+	return !TraceSingle(MakeCapsulePathQuery(Pose, NetPlan.Height, EndTargetLocation), Hit);
+}
+
+void UTraversalComponent::ServerTraversalPlan_Implementation(const FTraversalNetPlan& NetPlan)
+{
+	// The client has started the action already. If it is rejected, the client is corrected by the movement component
+	if (!CanStartCheck(NetPlan.Action) || !IsClientNetPlanValid(NetPlan))
+	{
+		UE_VLOG(GetOwner(), LogTraversal, Log, TEXT("Rejected %s plan sent by the client"), *UEnum::GetValueAsString(NetPlan.Action));
+		return;
+	}
+
+	ApplyNetPlan(NetPlan, false);
+}
+
+void UTraversalComponent::MulticastTraversalPlan_Implementation(const FTraversalNetPlan& NetPlan)
+{
+	if (PlayerCharacter->HasAuthority() || PlayerCharacter->IsLocallyControlled())
+		return;
+
+	ApplyNetPlan(NetPlan, true);
+}
+
+void UTraversalComponent::MulticastExitAction_Implementation(ETraversalState Action, float BlendOutTime)
+{
+	if (PlayerCharacter->HasAuthority() || PlayerCharacter->IsLocallyControlled() || ActiveAction.Action != Action)
+		return;
+
+	ExitAction(BlendOutTime, false);
+}
+
+
+/***** Slide *****/
+
+bool UTraversalComponent::SlideCheck()
+{
+	if (TraversalState == ETraversalState::None && !PlayerCharacterMovement->IsFalling())
+	{
+		SlideStart();
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+void UTraversalComponent::SlideStart()
+{
+	CountTraversalActionStarted();
+
+	InvalidateCheckCache();
+	TraversalState = ETraversalState::Sliding;
+
+	// The traversal movement component slides in its movement update
+	if (TraversalMovement)
+	{
+		TraversalMovement->SetTraversalMode(ETraversalState::Sliding);
+		return;
+	}
+
+	SetComponentTickEnabled(true);
+	PlayerCharacterMovement->GroundFriction = Config->SlideGroundFriction;
+	PlayerCharacterMovement->BrakingDecelerationWalking = Config->SlideBrakingPower;
+}
+
+void UTraversalComponent::SlideUpdate()
+{
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalSlideUpdate);
+
+	FFindFloorResult FloorHit = PlayerCharacterMovement->CurrentFloor;
+
+	if (FloorHit.bBlockingHit)
+	{
+		PlayerCharacterMovement->AddForce(CalculateSlideForce(FloorHit.HitResult.ImpactNormal));
+
+		// Clamp velocity to prevent extreme player speed while sliding
+		PlayerCharacterMovement->Velocity = UKismetMathLibrary::ClampVectorSize(PlayerCharacterMovement->Velocity, 0.0, Config->SlideMaxSpeed);
+		
+		// If player speed gets too low while sliding, stop sliding
+		if (PlayerCharacterMovement->Velocity.Size() < Config->SlideMinSpeed)
+		{
+			SlideStop();
+		}
+	}
+	else
+	{
+		SlideStop();
+	}
+}
+
+FVector UTraversalComponent::CalculateSlideForce(FVector FloorNormal)
+{
+	FVector ForwardForce = PlayerCharacter->GetActorForwardVector() * Config->SlidePower;
+
+	FVector FloorCross = UKismetMathLibrary::Cross_VectorVector(FloorNormal, UKismetMathLibrary::Cross_VectorVector(FloorNormal, UKismetMathLibrary::Vector_Up())).GetSafeNormal();
+	float FloorDot = UKismetMathLibrary::Dot_VectorVector(PlayerCharacter->GetActorForwardVector(), FloorCross);
+	FVector FloorForce;
+
+	if (FloorDot == 0.0f)
+	{
+		FloorForce = FloorCross * (FloorDot * Config->SlideFloorMultiplier);
+	}
+	else if (FloorDot < 0.0f)
+	{
+		FloorForce = FloorCross * (((1.0f + FloorDot) * 2.0f) * Config->SlideFloorMultiplier);
+	}
+	else if (FloorDot > 0.0f && FloorDot <= 0.85f)
+	{
+		FloorForce = FloorCross * (((1.0f - FloorDot) * 2.0f) * Config->SlideFloorMultiplier);
+	}
+	else
+	{
+		FloorForce = FloorCross * (((1.0f - FloorDot) * 5.0f) * Config->SlideFloorMultiplier);
+	}
+
+	return ForwardForce + FloorForce;
+}
+
+void UTraversalComponent::SlideStop()
+{
+	TraversalState = ETraversalState::None;
+
+	if (TraversalMovement)
+	{
+		if (TraversalMovement->GetTraversalMode() == ETraversalState::Sliding)
+		{
+			TraversalMovement->SetTraversalMode(ETraversalState::None);
+		}
+		return;
+	}
+
+	SetComponentTickEnabled(false);
+	PlayerCharacterMovement->GroundFriction = MovementDefaults.GroundFriction;
+	PlayerCharacterMovement->BrakingDecelerationWalking = MovementDefaults.BrakingDeceleration;
+}
+
+
+/***** Wall climb *****/
+
+FHitResult UTraversalComponent::ForwardTrace(FVector Offset)
+{
+	FTraversalTraceQuery Query = MakeForwardQuery(CapturePose(), Offset);
+	FHitResult Hit;
+
+	TraceSingle(Query, Hit);
+	TRAVERSAL_DEBUG_WALL_CLIMB_TRACE(GetOwner(), Query, Hit, TEXT("Forward"));
+	
+	return Hit;
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeForwardQuery(const FTraversalPose& Pose, FVector Offset) const
+{
+	FTraversalTraceQuery Query;
+	Query.Start = Pose.Location + Offset;
+	Query.End = Query.Start + Pose.ForwardVector * Config->WallDetectionDistance;
+	return Query;
+}
+
+bool UTraversalComponent::WallClimbCheck()
+{
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalWallClimbCheck);
+
+	if (!CanStartCheck(ETraversalState::WallClimbing))
+	{
+		return false;
+	}
+
+	if (CommitArmedPlan(ETraversalState::WallClimbing) != ETraversalState::None)
+		return true;
+	
+	FTraversalCheck Check = BeginCheck(ETraversalState::WallClimbing);
+
+	return RunCheck(Check) && CommitPlan(Check.Plan);
+}
+
+bool UTraversalComponent::WallClimbCheckAsync()
+{
+	return StartAsyncCheck(ETraversalState::WallClimbing);
+}
+
+void UTraversalComponent::WallClimbStart(const FHitResult& ForwardTraceHit)
+{
+	CountTraversalActionStarted();
+	PreloadMontages(ETraversalState::WallClimbing);
+
+	TraversalState = ETraversalState::WallClimbing;
+	SetActionMovementMode(ETraversalState::WallClimbing);
+	if (!TraversalMovement)
+	{
+		PlayerCharacterMovement->bOrientRotationToMovement = false;
+		PlayerCharacterMovement->MaxFlySpeed = Config->WallClimbSpeed;
+		PlayerCharacterMovement->BrakingDecelerationFlying = Config->WallClimbBrakingDeceleration;
+	}
+	PlayerCharacterMovement->StopMovementImmediately();
+
+	// Place player against the wall
+	FVector TargetLocation = ForwardTraceHit.Location + ForwardTraceHit.Normal * PlayerCapsule->GetScaledCapsuleRadius();
+	FRotator TargetRotation = UKismetMathLibrary::MakeRotFromX(ForwardTraceHit.Normal * -1.0f);
+	PlayerCharacter->SetActorLocationAndRotation(TargetLocation, TargetRotation);
+}
+
+void UTraversalComponent::WallClimbStop()
+{
+	TraversalState = ETraversalState::None;
+	SetComponentTickEnabled(false);
+	SetActionMovementMode(ETraversalState::None);
+	if (!TraversalMovement)
+	{
+		PlayerCharacterMovement->bOrientRotationToMovement = true;
+	}
+	PlayerCharacterMovement->StopMovementImmediately();
+
+	WallClimbHorizontalInput = 0.0f;
+	WallClimbVerticalInput = 0.0f;
+	WallPatch.Reset();
+}
+
+FTraversalTraceQuery UTraversalComponent::MakeWallClimbRoomQuery(const FTraversalPose& Pose, FVector Direction) const
+{
+	FTraversalTraceQuery Query;
+	Query.Start = Pose.Location + Direction * Config->DirectionalTraceDistance;
+	Query.End = Query.Start + Pose.ForwardVector * Config->WallDetectionDistance;
+	return Query;
+}
+
+bool UTraversalComponent::WallClimbCornerTurn(float AxisValue, const FVector& Direction)
+{
+	if (AxisValue == 0.0f || !WallPatch.IsValid())
+		return false;
+
+	// Resolved once per patch
+	if (!WallPatch.Graph)
+	{
+		UTraversalWorldSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UTraversalWorldSubsystem>();
+		if (!TraversalSubsystem)
+			return false;
+
+		WallPatch.Graph = TraversalSubsystem->GetWallGraph(WallPatch.Component.Get());
+		WallPatch.GraphFace = WallPatch.Graph ? WallPatch.Graph->FindFace(WallPatch.Center, WallPatch.Normal) : INDEX_NONE;
+	}
+
+	const FTraversalWallCorner* Corner = WallPatch.Graph ? WallPatch.Graph->FindCorner(WallPatch.GraphFace, Direction) : nullptr;
+	if (!Corner)
+		return false;
+
+	const FTraversalWallFace& Face = WallPatch.Graph->Faces[WallPatch.GraphFace];
+	const FTraversalWallFace& TargetFace = WallPatch.Graph->Faces[Corner->Face];
+	const FVector Location = PlayerCharacter->GetActorLocation();
+
+	// The wall around the corner has to reach the character's height
+	if (FMath::Abs(FVector::DotProduct(Location - TargetFace.Center, TargetFace.UpAxis)) > TargetFace.HalfHeight)
+		return false;
+
+	const double Side = FVector::DotProduct(Direction, Face.TangentAxis) >= 0.0 ? 1.0 : -1.0;
+	const double Distance = Corner->Offset - FVector::DotProduct(Location - Face.Center, Face.TangentAxis) * Side;
+
+	// Same distances the inward turn trace and the directional trace used to detect the corners with
+	if (Corner->bInward)
+	{
+		if (Distance > Config->InwardTurnDetectionDistance || Corner->TurnAngle > Config->MaxInwardTurnAngle)
+			return false;
+
+		WallClimbInwardTurn(AxisValue);
+	}
+	else
+	{
+		if (Distance > Config->DirectionalTraceDistance || Corner->TurnAngle > Config->MaxOutwardTurnAngle)
+			return false;
+
+		WallClimbOutwardTurn(AxisValue);
+	}
+
+	UE_VLOG(GetOwner(), LogTraversal, Verbose, TEXT("%s corner of %.1f degrees %.1f away%s"), Corner->bInward ? TEXT("Inward") : TEXT("Outward"),
+		FMath::RadiansToDegrees(Corner->TurnAngle), Distance, bWallClimbIsTurning ? TEXT(", turning") : TEXT(""));
+
+	return bWallClimbIsTurning;
+}
+
+void UTraversalComponent::WallClimbInwardTurn(float AxisValue)
+{
+	// The turn montages are still streaming in
+	if (!(AxisValue < 0.0f ? Config->LeftInwardTurnAnimation : Config->RightInwardTurnAnimation).Get())
+		return;
+
+	if (AxisValue < 0.0f)
+	{
+		WallClimbTurnMontageInstanceID = PlayMontage(Config->LeftInwardTurnAnimation.Get(), 0.0f, &UTraversalComponent::OnWallClimbTurnMontageCompleted);
+	}
+	else
+	{
+		WallClimbTurnMontageInstanceID = PlayMontage(Config->RightInwardTurnAnimation.Get(), 0.0f, &UTraversalComponent::OnWallClimbTurnMontageCompleted);
+	}
+
+	bWallClimbIsTurning = WallClimbTurnMontageInstanceID != INDEX_NONE;
+}
+
+void UTraversalComponent::WallClimbOutwardTurn(float AxisValue)
+{
+	// The turn montages are still streaming in
+	if (!(AxisValue < 0.0f ? Config->LeftOutwardTurnAnimation : Config->RightOutwardTurnAnimation).Get())
+		return;
+
+	if (AxisValue < 0.0f)
+	{
+		WallClimbTurnMontageInstanceID = PlayMontage(Config->LeftOutwardTurnAnimation.Get(), 0.0f, &UTraversalComponent::OnWallClimbTurnMontageCompleted);
+	}
+	else
+	{
+		WallClimbTurnMontageInstanceID = PlayMontage(Config->RightOutwardTurnAnimation.Get(), 0.0f, &UTraversalComponent::OnWallClimbTurnMontageCompleted);
+	}
+
+	bWallClimbIsTurning = WallClimbTurnMontageInstanceID != INDEX_NONE;
+}
+
+void UTraversalComponent::WallClimbMovement(FVector2D Direction)
+{
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalWallClimbMovement);
+
+	// The wall is only traced near the edges of the patch, where it may end or turn
+	FVector WallNormal;
+	if (WallPatch.Contains(PlayerCharacter->GetActorLocation(), Config->DirectionalTraceDistance, Config->WallDetectionDistance))
+	{
+		WallNormal = WallPatch.Normal;
+	}
+	else
+	{
+		FHitResult ForwardTraceHit = ForwardTrace(FVector::ZeroVector);
+		if (!ForwardTraceHit.bBlockingHit)
+		{
+			WallClimbStop();
+			return;
+		}
+
+		WallNormal = ForwardTraceHit.Normal;
+
+		// Near the edges the trace keeps hitting the same face. Keep its place in the wall graph
+		const FTraversalWallPatch PreviousPatch = WallPatch;
+		if (WallPatch.Build(ForwardTraceHit) && WallPatch.Component == PreviousPatch.Component
+			&& WallPatch.ComponentTransform.Equals(PreviousPatch.ComponentTransform) && WallPatch.Center.Equals(PreviousPatch.Center, 1.0))
+		{
+			WallPatch.Graph = PreviousPatch.Graph;
+			WallPatch.GraphFace = PreviousPatch.GraphFace;
+		}
+	}
+
+	FVector WallTangent = FVector::CrossProduct(WallNormal, PlayerCharacter->GetActorUpVector()).GetSafeNormal();
+	FVector VerticalDirection = PlayerCharacter->GetActorUpVector().GetSafeNormal() * Direction.Y;
+	FVector HorizontalDirection = WallTangent * Direction.X;
+	FVector ActualDirection = VerticalDirection + HorizontalDirection;
+	UE_VLOG_ARROW(GetOwner(), LogTraversal, Verbose, PlayerCharacter->GetActorLocation(), PlayerCharacter->GetActorLocation() + ActualDirection * 50.0f, FColor::Yellow, TEXT("Wall tangent %s"), *WallTangent.ToString());
+
+	// Check if there is axis input
+	if (!ActualDirection.IsZero())
+	{
+		if (!bWallClimbIsTurning)
+		{
+			SetWallClimbAnimationMovementDirections(ActualDirection);
+
+			// Turn around the corners of the wall instead of tracing for them
+			if (WallClimbCornerTurn(Direction.X, HorizontalDirection))
+				return;
+
+			PlayerCharacter->AddMovementInput(ActualDirection, Direction.X == 0 ? Direction.Y : Direction.X);
+		}
+
+		UE_VLOG(GetOwner(), LogTraversal, Verbose, TEXT("Wall climb input %.1f, %.1f%s"), WallClimbHorizontalInput, WallClimbVerticalInput, bWallClimbIsTurning ? TEXT(" while turning") : TEXT(""));
+	}
+	else
+	{
+		// Reset values when there's no input
+		SetWallClimbAnimationMovementDirections(FVector::ZeroVector);
+	}
+}
+
+void UTraversalComponent::SetWallClimbAnimationMovementDirections(FVector Direction)
+{
+	// Set the blend space values based on direction
+	if (Direction.Z != 0.0f)
+		// Vertical movement (up/down)
+		WallClimbVerticalInput = Direction.Z * 100.0f; // Will give us 100 for up, -100 for down
+
+	if (Direction.Y != 0.0f)
+		// Horizontal movement (left/right)
+		WallClimbHorizontalInput = Direction.Y * 100.0f; // Will give us -100 for left, 100 for right
+	else if (Direction.X != 0.0f)
+		// Horizontal movement (left/right)
+		WallClimbHorizontalInput = Direction.X * 100.0f; // Will give us -100 for left, 100 for right
+
+	// Gradually decay values when there's no input in that direction
+	if (Direction.Z == 0.0f)
+		WallClimbVerticalInput = FMath::FInterpTo(WallClimbVerticalInput, 0.0f, UGameplayStatics::GetWorldDeltaSeconds(GetWorld()), 10.0f);
+
+	if (Direction.Y == 0.0f)
+		WallClimbHorizontalInput = FMath::FInterpTo(WallClimbHorizontalInput, 0.0f, UGameplayStatics::GetWorldDeltaSeconds(GetWorld()), 10.0f);
+	else if (Direction.X == 0.0f)
+		WallClimbHorizontalInput = FMath::FInterpTo(WallClimbHorizontalInput, 0.0f, UGameplayStatics::GetWorldDeltaSeconds(GetWorld()), 10.0f);
+
+	// Clamp final values to ensure they stay within bounds
+	WallClimbHorizontalInput = FMath::Clamp(WallClimbHorizontalInput, -100.0f, 100.0f);
+	WallClimbVerticalInput = FMath::Clamp(WallClimbVerticalInput, -100.0f, 100.0f);
+}
+
+void UTraversalComponent::OnWallClimbTurnMontageCompleted(UAnimMontage* Montage, bool bInterrupted, int32 InstanceID)
+{
+	if (InstanceID != WallClimbTurnMontageInstanceID)
+		return;
+
+	WallClimbTurnMontageInstanceID = INDEX_NONE;
+	bWallClimbIsTurning = false;
+	UE_VLOG(GetOwner(), LogTraversal, Log, TEXT("Wall climb turn completed"));
+}
 
-	// Check if nothing is blocking the mantle path
-	bool bIsPathClear = IsCapsulePathClear(MantleHeight, WalkableImpactPoint);
 
-	if (!bIsPathClear)
-	{
+/***** Async checks *****/
+
+bool UTraversalComponent::StartAsyncCheck(ETraversalState Action)
+{
+	if (bAsyncCheckPending || !CanStartCheck(Action))
 		return false;
+
+	// An armed plan starts right away instead of waiting for traces
+	const ETraversalState ArmedAction = CommitArmedPlan(Action);
+	if (ArmedAction != ETraversalState::None)
+	{
+		OnAsyncCheckCompleted.Broadcast(ArmedAction, true);
+		return true;
 	}
 
-	// Determine correct mantle animation based on mantle height
-	FAnimationProperties MantleAnimationProperties = DetermineAnimationProperties(MantleHeight, MantleAnimationPropertySettings);
+	AsyncCheck = BeginCheck(Action);
+	bAsyncCheckPending = true;
 
-	// Start mantle
-	if (IsValid(MantleAnimationProperties.Animation))
+	if (FindCachedCheck(AsyncCheck))
 	{
-		MantleStart(MantleAnimationProperties);
+		FinishAsyncCheck();
 		return true;
 	}
-	else
+
+	UTraversalWorldSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UTraversalWorldSubsystem>();
+	if (bUseBatchedChecks && TraversalSubsystem)
 	{
-		return false;
+		TraversalSubsystem->EnqueueCheck(this, AsyncCheck);
+		return true;
 	}
-}
 
-float UTraversalComponent::ApplyMantleHeightOffset(float HeightOffset)
-{
-	return PlayerCapsule->GetScaledCapsuleHalfHeight() * 2 - HeightOffset;
+	ContinueAsyncCheck();
+	return true;
 }
 
-void UTraversalComponent::MantleStart(const FAnimationProperties& AnimationProperties)
+void UTraversalComponent::ContinueAsyncCheck()
 {
-	TraversalState = ETraversalState::Mantling;
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalAsyncCheckStep);
 
-	// Set player movement mode and add warp target
-	PlayerCharacterMovement->SetMovementMode(MOVE_Flying);
-	UMotionWarpingComponent* PlayerMotionWarpingComponent = PlayerCharacter->FindComponentByClass<UMotionWarpingComponent>();
-	if (IsValid(PlayerMotionWarpingComponent))
+	FHitResult Hit;
+	while (!AsyncCheck.IsFinished() && ResolveFromLedge(AsyncCheck, Hit))
 	{
-		FVector TargetLocation = ObjectStartWarpTarget - FVector(0.0f, 0.0f, ApplyMantleHeightOffset(AnimationProperties.AnimationHeightOffset));
-		PlayerMotionWarpingComponent->AddOrUpdateWarpTargetFromLocationAndRotation(MantleWarpTargetName, TargetLocation, PlayerCharacter->GetActorRotation());
+		AdvanceCheck(AsyncCheck, Hit);
+		Hit = FHitResult();
+	}
 
-		float MontageDuration = PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Play(AnimationProperties.Animation, 1.0f, EMontagePlayReturnType::Duration, AnimationProperties.AnimationStartingPosition, true);
-		FTimerHandle MontageCompletedTimerHandle;
-		float MontageFinalDuration = MontageDuration - AnimationProperties.AnimationStartingPosition - AnimationProperties.AnimationEndBlendTime;
-		GetWorld()->GetTimerManager().SetTimer(MontageCompletedTimerHandle, FTimerDelegate::CreateUObject(this, &UTraversalComponent::OnMantleMontageCompleted, AnimationProperties.AnimationEndBlendTime), MontageFinalDuration, false);
+	if (!AsyncCheck.IsFinished())
+	{
+		SubmitAsyncCheckTrace();
+		return;
 	}
-}
 
-void UTraversalComponent::OnMantleMontageCompleted(float AnimationEndBlendTime)
-{
-	PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Stop(0.2f, PlayerCharacter->GetMesh()->GetAnimInstance()->GetActiveMontageInstance()->Montage);
-	PlayerCharacterMovement->SetMovementMode(MOVE_Walking);
-	TraversalState = ETraversalState::None;
+	CacheCheck(AsyncCheck);
+	FinishAsyncCheck();
 }
 
-
-/***** Slide *****/
-
-//bool UTraversalComponent::CanSlide()
-//{
-//	return TraversalState == ETraversalState::None && !PlayerCharacterMovement->IsFalling();
-//}
-
-bool UTraversalComponent::SlideCheck()
+void UTraversalComponent::SubmitAsyncCheckTrace()
 {
-	if (TraversalState == ETraversalState::None && !PlayerCharacterMovement->IsFalling())
+	const FTraversalTraceQuery Query = GetCheckQuery(AsyncCheck);
+	++AsyncCheck.NumTraces;
+	CountTraversalTrace();
+
+	if (Query.Shape == ETraversalTraceShape::Line)
 	{
-		SlideStart();
-		return true;
+		AsyncTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Query.Start, Query.End, TraceContext.Channel, TraceContext.QueryParams, FCollisionResponseParams::DefaultResponseParam, &AsyncTraceDelegate);
 	}
 	else
 	{
-		return false;
+		AsyncTraceHandle = GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Query.Start, Query.End, FQuat::Identity, TraceContext.Channel, Query.GetCollisionShape(), TraceContext.QueryParams, FCollisionResponseParams::DefaultResponseParam, &AsyncTraceDelegate);
 	}
 }
 
-void UTraversalComponent::SlideStart()
-{
-	TraversalState = ETraversalState::Sliding;
-	PlayerCharacterMovement->GroundFriction = SlideGroundFriction;
-	PlayerCharacterMovement->BrakingDecelerationWalking = SlideBrakingPower;
-}
-
-void UTraversalComponent::SlideUpdate()
+void UTraversalComponent::OnAsyncCheckTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
 {
-	FFindFloorResult FloorHit = PlayerCharacterMovement->CurrentFloor;
+	if (!bAsyncCheckPending || TraceHandle != AsyncTraceHandle)
+		return;
 
-	if (FloorHit.bBlockingHit)
+	FHitResult Hit;
+	for (const FHitResult& OutHit : TraceDatum.OutHits)
 	{
-		FVector Force = CalculateSlideForce(FloorHit.HitResult.ImpactNormal);
-
-		PlayerCharacterMovement->AddForce(Force);
-
-		// Clamp velocity to prevent extreme player speed while sliding
-		PlayerCharacterMovement->Velocity = UKismetMathLibrary::ClampVectorSize(PlayerCharacterMovement->Velocity, 0.0, SlideMaxSpeed);
-		
-		// If player speed gets too low while sliding, stop sliding
-		if (PlayerCharacterMovement->Velocity.Size() < SlideMinSpeed)
+		if (OutHit.bBlockingHit)
 		{
-			SlideStop();
+			Hit = OutHit;
+			break;
 		}
 	}
-	else
+
+	TRAVERSAL_DEBUG_CHECK_TRACE(GetOwner(), AsyncCheck, GetCheckQuery(AsyncCheck), Hit);
+	AdvanceCheck(AsyncCheck, Hit);
+	ContinueAsyncCheck();
+}
+
+void UTraversalComponent::OnBatchedCheckCompleted(const FTraversalCheck& Check)
+{
+	if (Check.bIsLookAhead)
 	{
-		SlideStop();
+		CacheCheck(Check);
+		OnLookAheadCheckCompleted(Check);
+		return;
 	}
+
+	if (!bAsyncCheckPending)
+		return;
+
+	AsyncCheck = Check;
+	CacheCheck(AsyncCheck);
+	FinishAsyncCheck();
 }
 
-FVector UTraversalComponent::CalculateSlideForce(FVector FloorNormal)
+void UTraversalComponent::FinishAsyncCheck()
 {
-	FVector ForwardForce = PlayerCharacter->GetActorForwardVector() * SlidePower;
+	bAsyncCheckPending = false;
+	TRAVERSAL_DEBUG_CHECK_RESULT(GetOwner(), AsyncCheck);
 
-	FVector FloorCross = UKismetMathLibrary::Cross_VectorVector(FloorNormal, UKismetMathLibrary::Cross_VectorVector(FloorNormal, UKismetMathLibrary::Vector_Up())).GetSafeNormal();
-	float FloorDot = UKismetMathLibrary::Dot_VectorVector(PlayerCharacter->GetActorForwardVector(), FloorCross);
-	FVector FloorForce;
+	// The character may have started another action while the traces were in flight
+	bool bStarted = AsyncCheck.Stage == ETraversalCheckStage::Succeeded && CanStartCheck(AsyncCheck.Action) && CommitPlan(AsyncCheck.Plan);
+	OnAsyncCheckCompleted.Broadcast(AsyncCheck.Action, bStarted);
+}
 
-	if (FloorDot == 0.0f)
-	{
-		FloorForce = FloorCross * (FloorDot * SlideFloorMultiplier);
-	}
-	else if (FloorDot < 0.0f)
-	{
-		FloorForce = FloorCross * (((1.0f + FloorDot) * 2.0f) * SlideFloorMultiplier);
-	}
-	else if (FloorDot > 0.0f && FloorDot <= 0.85f)
-	{
-		FloorForce = FloorCross * (((1.0f - FloorDot) * 2.0f) * SlideFloorMultiplier);
-	}
-	else
+void UTraversalComponent::CancelAsyncCheck()
+{
+	bAsyncCheckPending = false;
+	AsyncTraceHandle = FTraceHandle();
+
+	UWorld* World = GetWorld();
+	if (UTraversalWorldSubsystem* TraversalSubsystem = World ? World->GetSubsystem<UTraversalWorldSubsystem>() : nullptr)
 	{
-		FloorForce = FloorCross * (((1.0f - FloorDot) * 5.0f) * SlideFloorMultiplier);
+		TraversalSubsystem->CancelChecks(this);
 	}
-	
-	//GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::Red, FString::SanitizeFloat(FloorDot));
-	return ForwardForce + FloorForce;
 }
 
-void UTraversalComponent::SlideStop()
+
+/***** Look-ahead *****/
+
+void UTraversalComponent::UpdateLookAhead()
 {
-	TraversalState = ETraversalState::None;
-	PlayerCharacterMovement->GroundFriction = DefaultGroundFriction;
-	PlayerCharacterMovement->BrakingDecelerationWalking = DefaultBrakingDeceleration;
-}
+	// Simulated proxies only play the actions replicated to them
+	if (TraversalState != ETraversalState::None || PlayerCharacter->GetLocalRole() == ROLE_SimulatedProxy)
+		return;
 
+	UTraversalWorldSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UTraversalWorldSubsystem>();
+	if (!TraversalSubsystem)
+		return;
 
-/***** Wall climb *****/
+	for (const ETraversalState Action : { ETraversalState::None, ETraversalState::WallClimbing })
+	{
+		FTraversalCheck Check = BeginLookAheadCheck(Action);
 
-FHitResult UTraversalComponent::ForwardTrace(FVector Offset)
-{
-	FVector Start = PlayerCharacter->GetActorLocation() + Offset;
-	FVector End = Start + PlayerCharacter->GetActorForwardVector() * WallDetectionDistance;
-	TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
+		// Vaults and mantles are only checked along the movement input
+		if (Action == ETraversalState::None && Check.Pose.MovementInput.IsNearlyZero())
+		{
+			ArmedPlans.Remove(ETraversalState::Vaulting);
+			ArmedPlans.Remove(ETraversalState::Mantling);
+			continue;
+		}
 
-	bool bHit = UKismetSystemLibrary::LineTraceSingle(GetWorld(), Start, End, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
-	DrawDebugLine(GetWorld(), Start, End, FColor::Red, false, 1.0f, 1.0f);
-	
-	return Hit;
+		INC_DWORD_STAT(STAT_TraversalLookAheadChecks);
+
+		if (FindCachedCheck(Check))
+		{
+			OnLookAheadCheckCompleted(Check);
+			continue;
+		}
+
+		TraversalSubsystem->EnqueueCheck(this, Check);
+	}
 }
 
-bool UTraversalComponent::WallClimbCheck()
+FTraversalCheck UTraversalComponent::BeginLookAheadCheck(ETraversalState Action) const
+{
+	FTraversalCheck Check = BeginCheck(Action);
+	Check.bIsLookAhead = true;
+
+	// Check from where the character will be once the batch has run and the action is likely requested
+	const FVector Offset = Check.Pose.Velocity * LookAheadTime;
+	Check.Pose.Location += Offset;
+	Check.Pose.CapsuleBaseLocation += Offset;
+	return Check;
+}
+
+void UTraversalComponent::OnLookAheadCheckCompleted(const FTraversalCheck& Check)
 {
+	// The check was queued before an action started
 	if (TraversalState != ETraversalState::None)
+		return;
+
+	if (Check.bIsUnified)
 	{
-		return false;
-	}
-	
-	FHitResult TraceResult = ForwardTrace(FVector(0.0f, 0.0f, 0.0f));
-	if (IsRoomToStartWallClimb())
-	{
-		WallClimbStart(TraceResult);
-		return true;
+		ArmedPlans.Remove(ETraversalState::Vaulting);
+		ArmedPlans.Remove(ETraversalState::Mantling);
 	}
 	else
 	{
-		return false;
+		ArmedPlans.Remove(Check.Action);
 	}
-}
 
-void UTraversalComponent::WallClimbStart(FHitResult& ForwardTraceHit)
-{
-	TraversalState = ETraversalState::WallClimbing;
-	PlayerCharacterMovement->SetMovementMode(MOVE_Flying);
-	PlayerCharacterMovement->bOrientRotationToMovement = false;
-	PlayerCharacterMovement->MaxFlySpeed = WallClimbSpeed;
-	PlayerCharacterMovement->BrakingDecelerationFlying = 2048;
-	PlayerCharacterMovement->StopMovementImmediately();
+	if (Check.Stage != ETraversalCheckStage::Succeeded || !Check.Obstacle.IsValid())
+		return;
 
-	// Place player against the wall
-	FVector TargetLocation = ForwardTraceHit.Location + ForwardTraceHit.Normal * PlayerCapsule->GetScaledCapsuleRadius();
-	FRotator TargetRotation = UKismetMathLibrary::MakeRotFromX(ForwardTraceHit.Normal * -1.0f);
-	PlayerCharacter->SetActorLocationAndRotation(TargetLocation, TargetRotation);
-}
+	LLM_SCOPE_BYTAG(Traversal);
 
-void UTraversalComponent::WallClimbStop()
-{
-	TraversalState = ETraversalState::None;
-	PlayerCharacterMovement->SetMovementMode(MOVE_Walking);
-	PlayerCharacterMovement->bOrientRotationToMovement = true;
-	PlayerCharacterMovement->StopMovementImmediately();
+	FTraversalArmedPlan& ArmedPlan = ArmedPlans.Add(Check.Action);
+	ArmedPlan.Plan = Check.Plan;
+	ArmedPlan.Pose = Check.Pose;
+	ArmedPlan.Obstacle = Check.Obstacle;
+	ArmedPlan.ObstacleTransform = Check.ObstacleTransform;
+	ArmedPlan.Time = GetWorld()->GetTimeSeconds();
 
-	WallClimbHorizontalInput = 0.0f;
-	WallClimbVerticalInput = 0.0f;
+	UE_VLOG_LOCATION(GetOwner(), LogTraversal, Verbose, ArmedPlan.Pose.Location, Check.Pose.CapsuleRadius, FColor::Magenta, TEXT("Armed %s"), *UEnum::GetValueAsString(Check.Action));
 }
 
-bool UTraversalComponent::IsRoomToStartWallClimb()
+ETraversalState UTraversalComponent::CommitArmedPlan(ETraversalState Action)
 {
-	TArray<AActor*> ActorsToIgnore;
+	if (ArmedPlans.IsEmpty())
+		return ETraversalState::None;
+
+	// Vaulting is preferred, like in unified checks
+	if (Action == ETraversalState::None)
+	{
+		const ETraversalState ArmedAction = CommitArmedPlan(ETraversalState::Vaulting);
+		return ArmedAction != ETraversalState::None ? ArmedAction : CommitArmedPlan(ETraversalState::Mantling);
+	}
 
-	FVector TopStart = PlayerCharacter->GetActorLocation() + FVector(0.0f, 0.0f, 1.0f) * DirectionalTraceDistance;
-	FVector TopEnd = TopStart + PlayerCharacter->GetActorForwardVector() * WallDetectionDistance;
-	FHitResult TopHit;
-	UKismetSystemLibrary::LineTraceSingle(GetWorld(), TopStart, TopEnd, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::ForDuration, TopHit, true, FLinearColor::Black);
+	FTraversalArmedPlan* ArmedPlan = ArmedPlans.Find(Action);
+	if (!ArmedPlan)
+		return ETraversalState::None;
 
-	FVector BottomStart = PlayerCharacter->GetActorLocation() + FVector(0.0f, 0.0f, -1.0f) * DirectionalTraceDistance;
-	FVector BottomEnd = BottomStart + PlayerCharacter->GetActorForwardVector() * WallDetectionDistance;
-	FHitResult BottomHit;
-	UKismetSystemLibrary::LineTraceSingle(GetWorld(), BottomStart, BottomEnd, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::ForDuration, BottomHit, true, FLinearColor::Black);
+	const FTraversalPose Pose = CapturePose();
+	const UPrimitiveComponent* Obstacle = ArmedPlan->Obstacle.Get();
+	const float MinCos = FMath::Cos(FMath::DegreesToRadians(ArmedPlanAngleTolerance));
+	const FVector ArmedInput = ArmedPlan->Pose.MovementInput.GetSafeNormal();
+	const FVector Input = Pose.MovementInput.GetSafeNormal();
 
-	FVector RightStart = PlayerCharacter->GetActorLocation() + PlayerCharacter->GetActorRightVector() * DirectionalTraceDistance;
-	FVector RightEnd = RightStart + PlayerCharacter->GetActorForwardVector() * WallDetectionDistance;
-	FHitResult RightHit;
-	UKismetSystemLibrary::LineTraceSingle(GetWorld(), RightStart, RightEnd, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::ForDuration, RightHit, true, FLinearColor::Black);
+	// Only the cheap conditions are validated again. The surroundings were traced when the plan was armed
+	const bool bIsValid = Obstacle && ArmedPlan->ObstacleTransform.Equals(Obstacle->GetComponentTransform()) && CanStartCheck(Action)
+		&& GetWorld()->GetTimeSeconds() - ArmedPlan->Time <= ArmedPlanLifetime
+		&& FVector::DistSquared(Pose.Location, ArmedPlan->Pose.Location) <= FMath::Square(ArmedPlanLocationTolerance)
+		&& FVector::DotProduct(Pose.ForwardVector, ArmedPlan->Pose.ForwardVector) >= MinCos
+		&& (Input.IsZero() == ArmedInput.IsZero()) && (Input.IsZero() || FVector::DotProduct(Input, ArmedInput) >= MinCos);
+
+	FTraversalPlan Plan = ArmedPlan->Plan;
+	ArmedPlans.Remove(Action);
+
+	if (!bIsValid)
+		return ETraversalState::None;
+
+	// The animation also depends on the approach speed, which may have changed since
+	if (Action == ETraversalState::Vaulting || Action == ETraversalState::Mantling)
+	{
+		Plan.AnimationProperties = SelectAnimation(Plan, Pose);
+		if (Plan.AnimationProperties.Animation.IsNull())
+			return ETraversalState::None;
+	}
 
-	FVector LeftStart = PlayerCharacter->GetActorLocation() + (PlayerCharacter->GetActorRightVector() * -1.0f) * DirectionalTraceDistance;
-	FVector LeftEnd = LeftStart + PlayerCharacter->GetActorForwardVector() * WallDetectionDistance;
-	FHitResult LeftHit;
-	UKismetSystemLibrary::LineTraceSingle(GetWorld(), LeftStart, LeftEnd, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::ForDuration, LeftHit, true, FLinearColor::Black);
+	if (!CommitPlan(Plan))
+		return ETraversalState::None;
 
-	return TopHit.bBlockingHit && BottomHit.bBlockingHit && RightHit.bBlockingHit && LeftHit.bBlockingHit && ForwardTrace(FVector(0.0f, 0.0f, 0.0f)).bBlockingHit;
+	INC_DWORD_STAT(STAT_TraversalArmedPlansCommitted);
+	CSV_CUSTOM_STAT(Traversal, ArmedPlansCommitted, 1, ECsvCustomStatOp::Accumulate);
+	return Action;
 }
 
-bool UTraversalComponent::IsTurnAngleClimbable(FVector CurrentWallNormal, FVector TargetWallNormal, float MaxTurnAngle)
-{
-	float Dot = FVector::DotProduct(CurrentWallNormal, TargetWallNormal);
-	float Angle = UKismetMathLibrary::Acos(Dot);
 
-	return Angle <= MaxTurnAngle;
+/***** Check cache *****/
+
+FTraversalCheckCacheKey UTraversalComponent::MakeCheckCacheKey(const FTraversalCheck& Check, const FTransform& ObstacleTransform) const
+{
+	// Ignore the obstacle's scale so the quantization grid is the same size in every direction
+	const FTransform ObstacleFrame(ObstacleTransform.GetRotation(), ObstacleTransform.GetLocation());
+	const float LocationTolerance = CheckCacheLocationTolerance * GetLODSettings().CheckCacheToleranceScale;
+	const float AngleTolerance = CheckCacheAngleTolerance * GetLODSettings().CheckCacheToleranceScale;
+	const FVector LocalLocation = ObstacleFrame.InverseTransformPositionNoScale(Check.Pose.Location) / LocationTolerance;
+	const FVector LocalForward = ObstacleFrame.InverseTransformVectorNoScale(Check.Pose.ForwardVector);
+	const FVector LocalInput = ObstacleFrame.InverseTransformVectorNoScale(Check.Pose.MovementInput);
+
+	FTraversalCheckCacheKey Key;
+	Key.Action = Check.bIsUnified ? ETraversalState::None : Check.Action;
+	Key.Location = FIntVector(FMath::RoundToInt(LocalLocation.X), FMath::RoundToInt(LocalLocation.Y), FMath::RoundToInt(LocalLocation.Z));
+	Key.Yaw = FMath::RoundToInt(FMath::RadiansToDegrees(FMath::Atan2(LocalForward.Y, LocalForward.X)) / AngleTolerance);
+	Key.bHasInput = !LocalInput.IsNearlyZero();
+	Key.InputYaw = Key.bHasInput ? FMath::RoundToInt(FMath::RadiansToDegrees(FMath::Atan2(LocalInput.Y, LocalInput.X)) / AngleTolerance) : 0;
+	Key.CapsuleHalfHeight = FMath::RoundToInt(Check.Pose.CapsuleHalfHeight / LocationTolerance);
+	Key.bIsFalling = PlayerCharacterMovement->IsFalling();
+	return Key;
 }
 
-void UTraversalComponent::WallClimbInwardTurnTrace(FVector Direction, float AxisValue, FVector CurrentWallNormal)
+bool UTraversalComponent::FindCachedCheck(FTraversalCheck& Check)
 {
-	FVector Start = PlayerCharacter->GetActorLocation();
-	FVector End = Start + Direction * (AxisValue * InwardTurnDetectionDistance);
-	TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
+	if (!bUseCheckCache)
+		return false;
 
-	UKismetSystemLibrary::LineTraceSingle(GetWorld(), Start, End, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
+	const double Now = GetWorld()->GetTimeSeconds();
 
-	if (Hit.bBlockingHit)
+	for (int32 Index = CheckCache.Num() - 1; Index >= 0; --Index)
 	{
-		// Check if turn angle of wall can be climbed onto
-		bool bCanTurn = IsTurnAngleClimbable(CurrentWallNormal, Hit.Normal, MaxInwardTurnAngle);
-		if (bCanTurn)
+		const FTraversalCheckCacheEntry& Entry = CheckCache[Index];
+		const UPrimitiveComponent* Obstacle = Entry.Obstacle.Get();
+
+		// Drop results that are too old, or whose obstacle was destroyed or has moved since
+		if (!Obstacle || Now - Entry.Time > CheckCacheLifetime * GetLODSettings().CheckCacheToleranceScale || !Entry.ObstacleTransform.Equals(Obstacle->GetComponentTransform()))
+		{
+			CheckCache.RemoveAtSwap(Index);
+			continue;
+		}
+
+		if (Entry.Key == MakeCheckCacheKey(Check, Entry.ObstacleTransform))
 		{
-			WallClimbInwardTurn(AxisValue);
+			Check.Action = Entry.Action;
+			Check.Plan = Entry.Plan;
+			Check.Obstacle = Entry.Obstacle;
+			Check.ObstacleTransform = Entry.ObstacleTransform;
+			Check.Stage = Entry.bSucceeded ? ETraversalCheckStage::Succeeded : ETraversalCheckStage::Failed;
+
+			// The animation also depends on the approach speed, which isn't part of the key
+			if (Entry.bSucceeded && (Check.Action == ETraversalState::Vaulting || Check.Action == ETraversalState::Mantling))
+			{
+				Check.Plan.AnimationProperties = SelectAnimation(Check.Plan, Check.Pose);
+				if (Check.Plan.AnimationProperties.Animation.IsNull())
+				{
+					Check.Stage = ETraversalCheckStage::Failed;
+				}
+			}
+			return true;
 		}
 	}
+
+	return false;
 }
 
-void UTraversalComponent::WallClimbInwardTurn(float AxisValue)
+void UTraversalComponent::CacheCheck(const FTraversalCheck& Check)
 {
-	bWallClimbIsTurning = true;
+	if (!bUseCheckCache || !Check.Obstacle.IsValid())
+		return;
 
-	if (AxisValue < 0.0f)
-	{
-		//PlayerCharacter->PlayAnimMontage(LeftInwardTurnAnimation);
+	LLM_SCOPE_BYTAG(Traversal);
 
-		float MontageDuration = PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Play(LeftInwardTurnAnimation, 1.0f, EMontagePlayReturnType::Duration, 0.0f, true);
-		GetWorld()->GetTimerManager().SetTimer(WallClimbTurnMontageCompletedHandle, this, &UTraversalComponent::OnWallClimbTurnMontageCompleted, MontageDuration, false);
+	FTraversalCheckCacheEntry Entry;
+	Entry.Obstacle = Check.Obstacle;
+	Entry.ObstacleTransform = Check.ObstacleTransform;
+	Entry.Key = MakeCheckCacheKey(Check, Check.ObstacleTransform);
+	Entry.Time = GetWorld()->GetTimeSeconds();
+	Entry.bSucceeded = Check.Stage == ETraversalCheckStage::Succeeded;
+	Entry.Action = Check.Action;
+	Entry.Plan = Check.Plan;
 
-		//GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Red, TEXT("Left Inward Turn"));
-	}
-	else
+	if (CheckCache.Num() >= CheckCacheSize)
 	{
-		//PlayerCharacter->PlayAnimMontage(RightInwardTurnAnimation);
-
-		float MontageDuration = PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Play(RightInwardTurnAnimation, 1.0f, EMontagePlayReturnType::Duration, 0.0f, true);
-		GetWorld()->GetTimerManager().SetTimer(WallClimbTurnMontageCompletedHandle, this, &UTraversalComponent::OnWallClimbTurnMontageCompleted, MontageDuration, false);
+		// Replace the oldest result
+		int32 OldestIndex = 0;
+		for (int32 Index = 1; Index < CheckCache.Num(); ++Index)
+		{
+			if (CheckCache[Index].Time < CheckCache[OldestIndex].Time)
+				OldestIndex = Index;
+		}
 
-		//GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Red, TEXT("Right Inward Turn"));
+		CheckCache[OldestIndex] = MoveTemp(Entry);
+		return;
 	}
+
+	CheckCache.Add(MoveTemp(Entry));
 }
 
-FHitResult UTraversalComponent::WallClimbDirectionalTrace(FVector Direction, float AxisValue)
+void UTraversalComponent::InvalidateCheckCache()
 {
-	FVector Start = PlayerCharacter->GetActorLocation() + Direction * (AxisValue * DirectionalTraceDistance);
-	FVector End = Start + PlayerCharacter->GetActorForwardVector() * WallDetectionDistance;
-	TArray<AActor*> ActorsToIgnore;
-	FHitResult Hit;
+	CheckCache.Reset();
+}
 
-	UKismetSystemLibrary::LineTraceSingle(GetWorld(), Start, End, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
-	DrawDebugLine(GetWorld(), Start, End, FColor::Red, false, 1.0f, 1.0f);
 
-	return Hit;
-}
+/***** Montage streaming *****/
 
-void UTraversalComponent::WallClimbOutwardTurnTrace(FVector Direction, float AxisValue, FVector CurrentWallNormal, FVector DirectionalTraceEnd)
+void UTraversalComponent::GetActionMontages(ETraversalState Action, TArray<FSoftObjectPath>& OutPaths) const
 {
-	if (Direction == PlayerCharacter->GetActorRightVector() || Direction == PlayerCharacter->GetActorRightVector() * -1)
+	switch (Action)
 	{
-		FVector Start = DirectionalTraceEnd;
-		FVector End = Start + Direction * (AxisValue * -1.0f * OutwardTurnDetectionDistance);
-		TArray<AActor*> ActorsToIgnore;
-		FHitResult Hit;
-
-		UKismetSystemLibrary::LineTraceSingle(GetWorld(), Start, End, DetectionTraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, true);
-		DrawDebugLine(GetWorld(), Start, End, FColor::Red, false, 1.0f, 1.0f);
-
-		if (Hit.bBlockingHit)
+	case ETraversalState::Vaulting:
+	case ETraversalState::Mantling:
+		if (const UTraversalAnimationTable* AnimationTable = Config->GetAnimations(Action))
 		{
-			// Check if turn angle of wall can be climbed onto
-			bool bCanTurn = IsTurnAngleClimbable(CurrentWallNormal, Hit.Normal, MaxOutwardTurnAngle);
+			// Dedicated servers don't play the montages of actions that follow baked root motion
+			if (bUseBakedRootMotionOnServer && TraversalMovement && GetNetMode() == NM_DedicatedServer && AnimationTable->HasBakedRootMotion())
+				break;
 
-			if (bCanTurn)
+			AnimationTable->GetAnimations(OutPaths);
+		}
+		break;
+	case ETraversalState::WallClimbing:
+		for (const TSoftObjectPtr<UAnimMontage>* TurnAnimation : { &Config->LeftInwardTurnAnimation, &Config->RightInwardTurnAnimation, &Config->LeftOutwardTurnAnimation, &Config->RightOutwardTurnAnimation })
+		{
+			if (!TurnAnimation->IsNull())
 			{
-				WallClimbOutwardTurn(AxisValue);
+				OutPaths.AddUnique(TurnAnimation->ToSoftObjectPath());
 			}
 		}
+		break;
+	default:
+		break;
 	}
 }
 
-void UTraversalComponent::WallClimbOutwardTurn(float AxisValue)
+void UTraversalComponent::PreloadMontages(ETraversalState Action)
 {
-	bWallClimbIsTurning = true;
-	if (AxisValue < 0.0f)
-	{
-		//PlayerCharacter->PlayAnimMontage(LeftOutwardTurnAnimation);
-
-		float MontageDuration = PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Play(LeftOutwardTurnAnimation, 1.0f, EMontagePlayReturnType::Duration, 0.0f, true);
-		GetWorld()->GetTimerManager().SetTimer(WallClimbTurnMontageCompletedHandle, this, &UTraversalComponent::OnWallClimbTurnMontageCompleted, MontageDuration, false);
+	const TSharedPtr<FStreamableHandle>* ExistingHandle = MontageHandles.Find(Action);
+	if (ExistingHandle && ExistingHandle->IsValid())
+		return;
 
-		//GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Red, TEXT("Left Outward Turn"));
-	}
-	else
-	{
-		//PlayerCharacter->PlayAnimMontage(RightOutwardTurnAnimation);
+	TArray<FSoftObjectPath> Paths;
+	GetActionMontages(Action, Paths);
+	if (Paths.IsEmpty())
+		return;
 
-		float MontageDuration = PlayerCharacter->GetMesh()->GetAnimInstance()->Montage_Play(RightOutwardTurnAnimation, 1.0f, EMontagePlayReturnType::Duration, 0.0f, true);
-		GetWorld()->GetTimerManager().SetTimer(WallClimbTurnMontageCompletedHandle, this, &UTraversalComponent::OnWallClimbTurnMontageCompleted, MontageDuration, false);
+	LLM_SCOPE_BYTAG(Traversal);
+	MontageHandles.Add(Action, UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths), FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority));
+}
 
-		//GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Red, TEXT("Right Outward Turn"));
+void UTraversalComponent::ReleaseMontages(ETraversalState Action)
+{
+	TSharedPtr<FStreamableHandle> Handle;
+	if (MontageHandles.RemoveAndCopyValue(Action, Handle) && Handle.IsValid())
+	{
+		Handle->ReleaseHandle();
 	}
 }
 
-void UTraversalComponent::WallClimbMovement(FVector2D Direction)
+void UTraversalComponent::UpdateMontagePreloading()
 {
-	FHitResult ForwardTraceHit = ForwardTrace(FVector::ZeroVector);
-	if (!ForwardTraceHit.bBlockingHit)
+	const UTraversalWorldSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UTraversalWorldSubsystem>();
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastMemoryTrimTime < MontageReleaseDelay)
+		return;
+
+	// Without baked ledges there is nothing to go by, so keep the montages loaded
+	if (!TraversalSubsystem || !TraversalSubsystem->HasLedgeIndices() || TraversalSubsystem->HasLedgeNear(PlayerCharacter->GetActorLocation(), MontagePreloadDistance))
 	{
-		WallClimbStop();
+		LastLedgeNearTime = Now;
+		PreloadMontages(ETraversalState::Vaulting);
+		PreloadMontages(ETraversalState::Mantling);
 		return;
 	}
 
-	FVector WallNormal = ForwardTraceHit.Normal;
-	FVector WallTangent = FVector::CrossProduct(WallNormal, PlayerCharacter->GetActorUpVector()).GetSafeNormal();
-	FVector VerticalDirection = PlayerCharacter->GetActorUpVector().GetSafeNormal() * Direction.Y;
-	FVector HorizontalDirection = WallTangent * Direction.X;
-	FVector ActualDirection = VerticalDirection + HorizontalDirection;
-	UE_LOG(LogTemp, Error, TEXT("WallTangent: %s"), *VerticalDirection.ToString());
-	UE_LOG(LogTemp, Error, TEXT("VerticalDirection: %s"), *VerticalDirection.ToString());
-	UE_LOG(LogTemp, Error, TEXT("HorizontalDirection: %s"), *HorizontalDirection.ToString());
-	UE_LOG(LogTemp, Error, TEXT("ActualDirection: %s"), *ActualDirection.ToString());
-
-	// Check if there is axis input
-	if (!ActualDirection.IsZero())
+	if (Now - LastLedgeNearTime > MontageReleaseDelay)
 	{
-		if (!bWallClimbIsTurning)
+		if (TraversalState != ETraversalState::Vaulting)
 		{
-			SetWallClimbAnimationMovementDirections(ActualDirection);
-			
-			UE_LOG(LogTemp, Error, TEXT("Horizontal input NOT turning: %f"), WallClimbHorizontalInput)
-
-			//WallClimbInwardTurnTrace(Direction, AxisValue, WallNormal);
-
-			//FHitResult DirectionalTraceHit = WallClimbDirectionalTrace(Direction, AxisValue);
-
-			//if (DirectionalTraceHit.bBlockingHit)
-			//{
-			//	FVector TargetLocation = DirectionalTraceHit.Location;
-			//	FVector TargetNormal = DirectionalTraceHit.Normal;
-
-			//	FVector ClimbUnitDirection = UKismetMathLibrary::GetDirectionUnitVector(PlayerCharacter->GetActorLocation(), TargetLocation + (TargetNormal * PlayerCapsule->GetScaledCapsuleRadius()));
-			//	FVector ClimbDirection;
-			//	if (Direction.X > 0.0f || Direction.Y > 0.0f)
-			//	{
-			//		ClimbDirection = ClimbUnitDirection * 1.0f;
-			//	}
-			//	else
-			//	{
-			//		ClimbDirection = ClimbUnitDirection * -1.0f;
-			//	}
-
-				PlayerCharacter->AddMovementInput(ActualDirection, Direction.X == 0 ? Direction.Y : Direction.X);
-			//	// Adjust player rotation to wall
-			//	FRotator NewRotation = UKismetMathLibrary::RInterpTo(PlayerCharacter->GetActorRotation(), (TargetNormal * -1.0f).Rotation(), UGameplayStatics::GetWorldDeltaSeconds(GetWorld()), 5.0f);
-			//	PlayerCharacter->SetActorRotation(NewRotation);
-			//}
-			//else
-			//{
-			//	WallClimbOutwardTurnTrace(Direction, AxisValue, WallNormal, DirectionalTraceHit.TraceEnd);
-			//}
-		}
-
-		UE_LOG(LogTemp, Error, TEXT("Horizontal input turning: %f"), WallClimbHorizontalInput)
+			ReleaseMontages(ETraversalState::Vaulting);
+		}
+
+		if (TraversalState != ETraversalState::Mantling)
+		{
+			ReleaseMontages(ETraversalState::Mantling);
+		}
 	}
-	else
+}
+
+void UTraversalComponent::OnMemoryTrim()
+{
+	for (const ETraversalState Action : { ETraversalState::Vaulting, ETraversalState::Mantling, ETraversalState::WallClimbing })
 	{
-		// Reset values when there's no input
-		SetWallClimbAnimationMovementDirections(FVector::ZeroVector);
+		if (TraversalState != Action)
+		{
+			ReleaseMontages(Action);
+		}
 	}
+
+	// Hold off preloading for a while so the montages aren't loaded straight back in
+	LastMemoryTrimTime = GetWorld()->GetTimeSeconds();
 }
 
-void UTraversalComponent::SetWallClimbAnimationMovementDirections(FVector Direction)
+
+/***** LOD *****/
+
+const FTraversalLODSettings& UTraversalComponent::GetLODSettings() const
 {
-	/*if (Direction.X != 0.0f)
-		WallClimbHorizontalInput = Direction.X * 100.0f;
-	if (Direction.Y != 0.0f)
-		WallClimbVerticalInput = Direction.Y * 100.0f;
+	static const FTraversalLODSettings DefaultLODSettings;
+	return LODSettings.IsValidIndex(CurrentLOD) ? LODSettings[CurrentLOD] : DefaultLODSettings;
+}
 
-	if (Direction.X == 0.0f)
-		WallClimbHorizontalInput = 0.0f;
-	if (Direction.Y == 0.0f)
-		WallClimbVerticalInput = 0.0f;*/
+void UTraversalComponent::SetLOD(int32 LOD)
+{
+	const int32 PreviousLOD = CurrentLOD;
+	CurrentLOD = LODSettings.IsEmpty() ? 0 : FMath::Clamp(LOD, 0, LODSettings.Num() - 1);
 
-	// Set the blend space values based on direction
-	if (Direction.Z != 0.0f)
-		// Vertical movement (up/down)
-		WallClimbVerticalInput = Direction.Z * 100.0f; // Will give us 100 for up, -100 for down
+	// Cached results were quantized with the tolerances of the previous level, and may have skipped checks this level runs
+	if (CurrentLOD != PreviousLOD)
+	{
+		InvalidateCheckCache();
+	}
 
-	if (Direction.Y != 0.0f)
-		// Horizontal movement (left/right)
-		WallClimbHorizontalInput = Direction.Y * 100.0f; // Will give us -100 for left, 100 for right
-	else if (Direction.X != 0.0f)
-		// Horizontal movement (left/right)
-		WallClimbHorizontalInput = Direction.X * 100.0f; // Will give us -100 for left, 100 for right
+	// Only the background checks are throttled. The tick drives the slide, baked actions and exit windows, which need every frame
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (TimerManager.IsTimerActive(LookAheadTimerHandle))
+	{
+		TimerManager.SetTimer(LookAheadTimerHandle, this, &UTraversalComponent::UpdateLookAhead, GetLookAheadInterval(), true);
+	}
+}
 
-	// Gradually decay values when there's no input in that direction
-	if (Direction.Z == 0.0f)
-		WallClimbVerticalInput = FMath::FInterpTo(WallClimbVerticalInput, 0.0f, UGameplayStatics::GetWorldDeltaSeconds(GetWorld()), 10.0f);
+float UTraversalComponent::GetLookAheadInterval() const
+{
+	return FMath::Max(LookAheadInterval, GetLODSettings().LookAheadInterval);
+}
 
-	if (Direction.Y == 0.0f)
-		WallClimbHorizontalInput = FMath::FInterpTo(WallClimbHorizontalInput, 0.0f, UGameplayStatics::GetWorldDeltaSeconds(GetWorld()), 10.0f);
-	else if (Direction.X == 0.0f)
-		WallClimbHorizontalInput = FMath::FInterpTo(WallClimbHorizontalInput, 0.0f, UGameplayStatics::GetWorldDeltaSeconds(GetWorld()), 10.0f);
+float UTraversalComponent::CalculateSignificance(const FTransform& ViewTransform) const
+{
+	const AActor* Owner = GetOwner();
+	if (!Owner)
+		return 0.0f;
 
-	// Clamp final values to ensure they stay within bounds
-	WallClimbHorizontalInput = FMath::Clamp(WallClimbHorizontalInput, -100.0f, 100.0f);
-	WallClimbVerticalInput = FMath::Clamp(WallClimbVerticalInput, -100.0f, 100.0f);
+	const FVector ToOwner = Owner->GetActorLocation() - ViewTransform.GetLocation();
+	float Distance = ToOwner.Size();
+
+	// Characters behind the viewer count as further away
+	if (FVector::DotProduct(ToOwner, ViewTransform.GetRotation().GetForwardVector()) < 0.0f)
+	{
+		Distance *= OffScreenDistanceScale;
+	}
+
+	// Closer characters are more significant
+	return -Distance;
 }
 
-void UTraversalComponent::OnWallClimbTurnMontageCompleted()
+void UTraversalComponent::SetLODFromSignificance(float Significance)
 {
-	bWallClimbIsTurning = false;
-	GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Red, TEXT("Turn montage completed"));
+	const float Distance = -Significance;
+
+	int32 LOD = 0;
+	for (int32 Index = 1; Index < LODSettings.Num(); ++Index)
+	{
+		if (Distance >= LODSettings[Index].MinDistance)
+		{
+			LOD = Index;
+		}
+	}
+
+	if (LOD != CurrentLOD)
+	{
+		SetLOD(LOD);
+	}
 }
@@ -0,0 +1,62 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalConfig.h"
+#include "TraversalAnimationTable.h"
+
+void UTraversalConfig::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Configs created at runtime aren't loaded. Loaded configs are compiled once their properties are in PostLoad
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_NeedLoad))
+	{
+		CompileAnimationTables();
+	}
+}
+
+void UTraversalConfig::PostLoad()
+{
+	Super::PostLoad();
+
+	CompileAnimationTables();
+}
+
+#if WITH_EDITOR
+void UTraversalConfig::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	CompileAnimationTables();
+}
+#endif
+
+void UTraversalConfig::CompileAnimationTables()
+{
+	// Compile the animation property settings of configs that don't use animation tables
+	VaultAnimations = VaultAnimationTable;
+	if (!VaultAnimations)
+	{
+		VaultAnimations = NewObject<UTraversalAnimationTable>(this, NAME_None, RF_Transient);
+		VaultAnimations->InitializeFromSettings(VaultAnimationPropertySettings);
+	}
+
+	MantleAnimations = MantleAnimationTable;
+	if (!MantleAnimations)
+	{
+		MantleAnimations = NewObject<UTraversalAnimationTable>(this, NAME_None, RF_Transient);
+		MantleAnimations->InitializeFromSettings(MantleAnimationPropertySettings);
+	}
+}
+
+const UTraversalAnimationTable* UTraversalConfig::GetAnimations(ETraversalState Action) const
+{
+	switch (Action)
+	{
+	case ETraversalState::Vaulting:
+		return VaultAnimations;
+	case ETraversalState::Mantling:
+		return MantleAnimations;
+	default:
+		return nullptr;
+	}
+}
@@ -0,0 +1,147 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalDebug.h"
+#include "TraversalComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "KismetTraceUtils.h"
+#include "DrawDebugHelpers.h"
+
+DEFINE_LOG_CATEGORY(LogTraversal);
+
+#if WITH_TRAVERSAL_DEBUG
+
+namespace TraversalDebug
+{
+	static TAutoConsoleVariable<bool> CVarDrawChecks(
+		TEXT("traversal.Debug.DrawChecks"),
+		false,
+		TEXT("Draw the traces of vault, mantle and wall climb checks and the warp targets of successful checks. Batched checks run on worker threads and only draw their result."),
+		ECVF_Cheat);
+
+	static TAutoConsoleVariable<bool> CVarDrawWallClimb(
+		TEXT("traversal.Debug.DrawWallClimb"),
+		false,
+		TEXT("Draw the traces issued every frame while wall climbing."),
+		ECVF_Cheat);
+
+	static TAutoConsoleVariable<float> CVarDrawDuration(
+		TEXT("traversal.Debug.DrawDuration"),
+		5.0f,
+		TEXT("Seconds traversal debug shapes stay on screen."),
+		ECVF_Cheat);
+
+	static FString GetStageName(ETraversalCheckStage Stage)
+	{
+		return StaticEnum<ETraversalCheckStage>()->GetNameStringByValue(static_cast<int64>(Stage));
+	}
+
+	static FString GetActionName(ETraversalState Action)
+	{
+		return Action == ETraversalState::None ? TEXT("Vault or mantle") : StaticEnum<ETraversalState>()->GetNameStringByValue(static_cast<int64>(Action));
+	}
+
+	static void DrawTrace(const UWorld* World, const FTraversalTraceQuery& Query, const FHitResult& Hit, FLinearColor TraceColor)
+	{
+		const float Duration = CVarDrawDuration.GetValueOnGameThread();
+
+		switch (Query.Shape)
+		{
+		case ETraversalTraceShape::Sphere:
+			DrawDebugSphereTraceSingle(World, Query.Start, Query.End, Query.Radius, EDrawDebugTrace::ForDuration, Hit.bBlockingHit, Hit, TraceColor, FLinearColor::Green, Duration);
+			break;
+		case ETraversalTraceShape::Capsule:
+			DrawDebugCapsuleTraceSingle(World, Query.Start, Query.End, Query.Radius, Query.HalfHeight, EDrawDebugTrace::ForDuration, Hit.bBlockingHit, Hit, TraceColor, FLinearColor::Green, Duration);
+			break;
+		default:
+			DrawDebugLineTraceSingle(World, Query.Start, Query.End, EDrawDebugTrace::ForDuration, Hit.bBlockingHit, Hit, TraceColor, FLinearColor::Green, Duration);
+			break;
+		}
+	}
+
+	// Only called while the Visual Logger is recording, so the label isn't built otherwise.
+	static void VLogTrace(const UObject* Owner, const FTraversalTraceQuery& Query, const FHitResult& Hit, const FColor& Color, const FString& Label)
+	{
+		switch (Query.Shape)
+		{
+		case ETraversalTraceShape::Sphere:
+			UE_VLOG_LOCATION(Owner, LogTraversal, Verbose, Query.End, Query.Radius, Color, TEXT(""));
+			break;
+		case ETraversalTraceShape::Capsule:
+			UE_VLOG_CAPSULE(Owner, LogTraversal, Verbose, Query.End - FVector(0.0f, 0.0f, Query.HalfHeight), Query.HalfHeight, Query.Radius, FQuat::Identity, Color, TEXT(""));
+			break;
+		default:
+			break;
+		}
+
+		UE_VLOG_SEGMENT(Owner, LogTraversal, Verbose, Query.Start, Query.End, Color, TEXT("%s"), *Label);
+
+		if (Hit.bBlockingHit)
+		{
+			UE_VLOG_LOCATION(Owner, LogTraversal, Verbose, Hit.ImpactPoint, 5.0f, FColor::Green, TEXT("%s hit %s"), *Label, *GetNameSafe(Hit.GetActor()));
+		}
+	}
+
+	void CheckTrace(const UObject* Owner, const FTraversalCheck& Check, const FTraversalTraceQuery& Query, const FHitResult& Hit)
+	{
+		if (CVarDrawChecks.GetValueOnGameThread() && Owner)
+		{
+			DrawTrace(Owner->GetWorld(), Query, Hit, FLinearColor::Red);
+		}
+
+#if ENABLE_VISUAL_LOG
+		if (FVisualLogger::IsRecording())
+		{
+			VLogTrace(Owner, Query, Hit, FColor::Red, GetStageName(Check.Stage));
+		}
+#endif
+	}
+
+	void CheckResult(const UObject* Owner, const FTraversalCheck& Check)
+	{
+		const bool bSucceeded = Check.Stage == ETraversalCheckStage::Succeeded;
+		const FTraversalPlan& Plan = Check.Plan;
+
+		if (bSucceeded && CVarDrawChecks.GetValueOnGameThread() && Owner && Plan.Action != ETraversalState::WallClimbing)
+		{
+			const float Duration = CVarDrawDuration.GetValueOnGameThread();
+			DrawDebugSphere(Owner->GetWorld(), Plan.ObjectStartWarpTarget, 10.0f, 8, FColor::Cyan, false, Duration);
+
+			if (Plan.Action == ETraversalState::Vaulting)
+			{
+				DrawDebugSphere(Owner->GetWorld(), Plan.ObjectEndWarpTarget, 10.0f, 8, FColor::Cyan, false, Duration);
+				DrawDebugSphere(Owner->GetWorld(), Plan.LandWarpTarget, 10.0f, 8, FColor::Cyan, false, Duration);
+			}
+		}
+
+		UE_VLOG(Owner, LogTraversal, Log, TEXT("%s check %s after %d traces%s"),
+			*GetActionName(Check.Action), bSucceeded ? TEXT("succeeded") : TEXT("failed"), Check.NumTraces, Check.bUsesBakedLedge ? TEXT(" using the ledge index") : Check.bUsesCollisionLedge ? TEXT(" using the obstacle's collision") : TEXT(""));
+
+		if (bSucceeded && Plan.Action != ETraversalState::WallClimbing)
+		{
+			UE_VLOG_LOCATION(Owner, LogTraversal, Log, Plan.ObjectStartWarpTarget, 10.0f, FColor::Cyan, TEXT("Object start, height %.1f"), Plan.Height);
+
+			if (Plan.Action == ETraversalState::Vaulting)
+			{
+				UE_VLOG_LOCATION(Owner, LogTraversal, Log, Plan.ObjectEndWarpTarget, 10.0f, FColor::Cyan, TEXT("Object end"));
+				UE_VLOG_LOCATION(Owner, LogTraversal, Log, Plan.LandWarpTarget, 10.0f, FColor::Cyan, TEXT("Land"));
+			}
+		}
+	}
+
+	void WallClimbTrace(const UObject* Owner, const FTraversalTraceQuery& Query, const FHitResult& Hit, const TCHAR* Label)
+	{
+		if (CVarDrawWallClimb.GetValueOnGameThread() && Owner)
+		{
+			DrawTrace(Owner->GetWorld(), Query, Hit, FLinearColor::Yellow);
+		}
+
+#if ENABLE_VISUAL_LOG
+		if (FVisualLogger::IsRecording())
+		{
+			VLogTrace(Owner, Query, Hit, FColor::Yellow, Label);
+		}
+#endif
+	}
+}
+
+#endif
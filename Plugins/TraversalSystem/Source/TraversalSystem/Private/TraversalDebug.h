@@ -0,0 +1,60 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VisualLogger/VisualLogger.h"
+
+struct FHitResult;
+struct FTraversalTraceQuery;
+struct FTraversalCheck;
+
+// Debug drawing and Visual Logger output. Everything below compiles to nothing in Shipping.
+#define WITH_TRAVERSAL_DEBUG !UE_BUILD_SHIPPING
+
+DECLARE_LOG_CATEGORY_EXTERN(LogTraversal, Log, All);
+
+#if WITH_TRAVERSAL_DEBUG
+
+namespace TraversalDebug
+{
+	/**
+	* Draw a trace issued by a check stage if traversal.Debug.DrawChecks is set, and record it in the Visual Logger.
+	*
+	* @param Owner Object the Visual Logger entry belongs to.
+	* @param Check Check that issued the trace, before advancing with the hit.
+	* @param Query Trace that was run.
+	* @param Hit Hit result of the trace.
+	*/
+	void CheckTrace(const UObject* Owner, const FTraversalCheck& Check, const FTraversalTraceQuery& Query, const FHitResult& Hit);
+
+	/**
+	* Draw the plan of a finished check if traversal.Debug.DrawChecks is set, and record its outcome in the Visual Logger.
+	*
+	* @param Owner Object the Visual Logger entry belongs to.
+	* @param Check Finished check.
+	*/
+	void CheckResult(const UObject* Owner, const FTraversalCheck& Check);
+
+	/**
+	* Draw a trace issued while wall climbing if traversal.Debug.DrawWallClimb is set, and record it in the Visual Logger.
+	*
+	* @param Owner Object the Visual Logger entry belongs to.
+	* @param Query Trace that was run.
+	* @param Hit Hit result of the trace.
+	* @param Label Name of the trace.
+	*/
+	void WallClimbTrace(const UObject* Owner, const FTraversalTraceQuery& Query, const FHitResult& Hit, const TCHAR* Label);
+}
+
+#define TRAVERSAL_DEBUG_CHECK_TRACE(Owner, Check, Query, Hit) TraversalDebug::CheckTrace(Owner, Check, Query, Hit)
+#define TRAVERSAL_DEBUG_CHECK_RESULT(Owner, Check) TraversalDebug::CheckResult(Owner, Check)
+#define TRAVERSAL_DEBUG_WALL_CLIMB_TRACE(Owner, Query, Hit, Label) TraversalDebug::WallClimbTrace(Owner, Query, Hit, Label)
+
+#else
+
+#define TRAVERSAL_DEBUG_CHECK_TRACE(Owner, Check, Query, Hit)
+#define TRAVERSAL_DEBUG_CHECK_RESULT(Owner, Check)
+#define TRAVERSAL_DEBUG_WALL_CLIMB_TRACE(Owner, Query, Hit, Label)
+
+#endif
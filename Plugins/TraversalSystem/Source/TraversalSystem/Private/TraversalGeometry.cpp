@@ -0,0 +1,337 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalGeometry.h"
+#include "TraversalComponent.h"
+#include "Algo/AllOf.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+
+static FTraversalBox MakeWorldBox(const FTransform& ElementTransform, const FVector& LocalCenter, const FVector& LocalHalfExtents, const FTransform& ComponentTransform)
+{
+	const FTransform ElementToWorld = ElementTransform * ComponentTransform;
+
+	FTraversalBox Box;
+	Box.Center = ElementToWorld.TransformPosition(LocalCenter);
+
+	// Transform each half axis separately so non-uniform component scale ends up in the extents
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		FVector LocalHalfAxis = FVector::ZeroVector;
+		LocalHalfAxis[Axis] = LocalHalfExtents[Axis];
+
+		const FVector WorldHalfAxis = ElementToWorld.TransformPosition(LocalCenter + LocalHalfAxis) - Box.Center;
+		Box.HalfExtents[Axis] = WorldHalfAxis.Size();
+		Box.Axes[Axis] = WorldHalfAxis.GetSafeNormal();
+	}
+
+	return Box;
+}
+
+int32 FTraversalBox::GetUpAxis(double& OutSign) const
+{
+	int32 UpAxis = 0;
+	for (int32 Axis = 1; Axis < 3; ++Axis)
+	{
+		if (FMath::Abs(Axes[Axis].Z) > FMath::Abs(Axes[UpAxis].Z))
+		{
+			UpAxis = Axis;
+		}
+	}
+
+	OutSign = Axes[UpAxis].Z >= 0.0 ? 1.0 : -1.0;
+	return UpAxis;
+}
+
+FVector FTraversalBox::GetTopCenter() const
+{
+	double UpSign;
+	const int32 UpAxis = GetUpAxis(UpSign);
+	return Center + Axes[UpAxis] * (UpSign * HalfExtents[UpAxis]);
+}
+
+template <typename AllocatorType>
+void FTraversalBox::GatherFromPrimitive(const UPrimitiveComponent* Primitive, TArray<FTraversalBox, AllocatorType>& OutBoxes)
+{
+	const UBodySetup* BodySetup = Primitive ? Primitive->GetBodySetup() : nullptr;
+	if (!BodySetup)
+		return;
+
+	const FTransform& ComponentTransform = Primitive->GetComponentTransform();
+
+	for (const FKBoxElem& BoxElem : BodySetup->AggGeom.BoxElems)
+	{
+		OutBoxes.Add(MakeWorldBox(BoxElem.GetTransform(), FVector::ZeroVector, FVector(BoxElem.X, BoxElem.Y, BoxElem.Z) * 0.5, ComponentTransform));
+	}
+
+	for (const FKConvexElem& ConvexElem : BodySetup->AggGeom.ConvexElems)
+	{
+		const FBox& ElemBox = ConvexElem.ElemBox;
+		if (ElemBox.IsValid)
+		{
+			FTraversalBox& Box = OutBoxes.Add_GetRef(MakeWorldBox(ConvexElem.GetTransform(), ElemBox.GetCenter(), ElemBox.GetExtent(), ComponentTransform));
+			Box.bIsExact = ConvexElem.VertexData.Num() == 8 && Algo::AllOf(ConvexElem.VertexData, [&ElemBox](const FVector& Vertex)
+				{
+					return (FMath::IsNearlyEqual(Vertex.X, ElemBox.Min.X) || FMath::IsNearlyEqual(Vertex.X, ElemBox.Max.X))
+						&& (FMath::IsNearlyEqual(Vertex.Y, ElemBox.Min.Y) || FMath::IsNearlyEqual(Vertex.Y, ElemBox.Max.Y))
+						&& (FMath::IsNearlyEqual(Vertex.Z, ElemBox.Min.Z) || FMath::IsNearlyEqual(Vertex.Z, ElemBox.Max.Z));
+				});
+		}
+	}
+}
+
+template void FTraversalBox::GatherFromPrimitive(const UPrimitiveComponent* Primitive, TArray<FTraversalBox>& OutBoxes);
+template void FTraversalBox::GatherFromPrimitive(const UPrimitiveComponent* Primitive, FTraversalPrimitiveBoxes& OutBoxes);
+
+FTraversalWallFace MakeWallFace(const FTraversalBox& Box, int32 Axis, double Sign)
+{
+	// The face axis closer to vertical runs up the wall
+	int32 TangentIndex = (Axis + 1) % 3;
+	int32 UpIndex = (Axis + 2) % 3;
+	if (FMath::Abs(Box.Axes[TangentIndex].Z) > FMath::Abs(Box.Axes[UpIndex].Z))
+	{
+		Swap(TangentIndex, UpIndex);
+	}
+
+	FTraversalWallFace Face;
+	Face.Normal = Box.Axes[Axis] * Sign;
+	Face.Center = Box.Center + Face.Normal * Box.HalfExtents[Axis];
+	Face.TangentAxis = Box.Axes[TangentIndex];
+	Face.UpAxis = Box.Axes[UpIndex];
+	Face.HalfWidth = Box.HalfExtents[TangentIndex];
+	Face.HalfHeight = Box.HalfExtents[UpIndex];
+	return Face;
+}
+
+bool FTraversalWallPatch::Build(const FHitResult& Hit)
+{
+	Reset();
+
+	UPrimitiveComponent* Primitive = Hit.GetComponent();
+	if (!Primitive)
+		return false;
+
+	FTraversalPrimitiveBoxes Boxes;
+	FTraversalBox::GatherFromPrimitive(Primitive, Boxes);
+
+	// Hits within this distance of a face plane are on the face
+	constexpr double PlaneTolerance = 1.0;
+
+	for (const FTraversalBox& Box : Boxes)
+	{
+		if (!Box.bIsExact)
+			continue;
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const double Sign = FVector::DotProduct(Box.Axes[Axis], Hit.ImpactNormal) >= 0.0 ? 1.0 : -1.0;
+			const FVector FaceNormal = Box.Axes[Axis] * Sign;
+			if (FVector::DotProduct(FaceNormal, Hit.ImpactNormal) < 0.999)
+				continue;
+
+			const FVector FaceCenter = Box.Center + FaceNormal * Box.HalfExtents[Axis];
+			if (FMath::Abs(FVector::DotProduct(Hit.ImpactPoint - FaceCenter, FaceNormal)) > PlaneTolerance)
+				continue;
+
+			const FTraversalWallFace Face = MakeWallFace(Box, Axis, Sign);
+			Component = Primitive;
+			ComponentTransform = Primitive->GetComponentTransform();
+			Center = Face.Center;
+			Normal = Face.Normal;
+			TangentAxis = Face.TangentAxis;
+			UpAxis = Face.UpAxis;
+			HalfWidth = Face.HalfWidth;
+			HalfHeight = Face.HalfHeight;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FTraversalWallPatch::Contains(const FVector& Location, double EdgeMargin, double MaxDistance) const
+{
+	const UPrimitiveComponent* Primitive = Component.Get();
+	if (!Primitive || !Primitive->GetComponentTransform().Equals(ComponentTransform))
+		return false;
+
+	const FVector Offset = Location - Center;
+	const double Distance = FVector::DotProduct(Offset, Normal);
+
+	return Distance >= 0.0 && Distance <= MaxDistance
+		&& FMath::Abs(FVector::DotProduct(Offset, TangentAxis)) <= HalfWidth - EdgeMargin
+		&& FMath::Abs(FVector::DotProduct(Offset, UpAxis)) <= HalfHeight - EdgeMargin;
+}
+
+bool FindCollisionLedge(const UPrimitiveComponent* Primitive, const FVector& ImpactPoint, const FVector& ImpactNormal, FTraversalLedge& OutLedge)
+{
+	// Traces hit the simple collision, so a single box is all the obstacle is made of
+	const UBodySetup* BodySetup = Primitive ? Primitive->GetBodySetup() : nullptr;
+	if (!BodySetup || BodySetup->GetCollisionTraceFlag() == CTF_UseComplexAsSimple || BodySetup->AggGeom.GetElementCount() != 1)
+		return false;
+
+	FTraversalPrimitiveBoxes Boxes;
+	FTraversalBox::GatherFromPrimitive(Primitive, Boxes);
+	if (Boxes.Num() != 1 || !Boxes[0].bIsExact)
+		return false;
+
+	const FTraversalBox& Box = Boxes[0];
+	double UpSign;
+	const int32 UpAxis = Box.GetUpAxis(UpSign);
+
+	// Tilted boxes have no level ledge
+	if (FMath::Abs(Box.Axes[UpAxis].Z) < 0.999)
+		return false;
+
+	// Hits within this distance of a face plane are on the face
+	constexpr double PlaneTolerance = 1.0;
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (Axis == UpAxis)
+			continue;
+
+		const double Sign = FVector::DotProduct(Box.Axes[Axis], ImpactNormal) >= 0.0 ? 1.0 : -1.0;
+		const FTraversalWallFace Face = MakeWallFace(Box, Axis, Sign);
+		if (FVector::DotProduct(Face.Normal, ImpactNormal) < 0.999 || FMath::Abs(FVector::DotProduct(ImpactPoint - Face.Center, Face.Normal)) > PlaneTolerance)
+			continue;
+
+		const FVector EdgeCenter = Face.Center + Box.Axes[UpAxis] * (UpSign * Box.HalfExtents[UpAxis]);
+		OutLedge.Start = EdgeCenter - Face.TangentAxis * Face.HalfWidth;
+		OutLedge.End = EdgeCenter + Face.TangentAxis * Face.HalfWidth;
+		OutLedge.Normal = FVector3f(Face.Normal.GetSafeNormal2D());
+		OutLedge.Depth = static_cast<float>(Box.HalfExtents[Axis] * 2.0);
+		OutLedge.Height = static_cast<float>(Box.HalfExtents[UpAxis] * 2.0);
+		OutLedge.LandZ = 0.0f;
+		OutLedge.bHasLandingRoom = false;
+		return true;
+	}
+
+	return false;
+}
+
+void FTraversalWallGraph::Build(const UPrimitiveComponent* Primitive)
+{
+	Faces.Reset();
+
+	if (!Primitive)
+		return;
+
+	ComponentTransform = Primitive->GetComponentTransform();
+
+	FTraversalPrimitiveBoxes Boxes;
+	FTraversalBox::GatherFromPrimitive(Primitive, Boxes);
+
+	for (const FTraversalBox& Box : Boxes)
+	{
+		if (!Box.bIsExact)
+			continue;
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Faces.Add(MakeWallFace(Box, Axis, 1.0));
+			Faces.Add(MakeWallFace(Box, Axis, -1.0));
+		}
+	}
+
+	// Faces within this distance of a corner meet at it
+	constexpr double CornerTolerance = 1.0;
+
+	for (int32 FaceIndex = 0; FaceIndex < Faces.Num(); ++FaceIndex)
+	{
+		FTraversalWallFace& Face = Faces[FaceIndex];
+
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			const FVector Direction = Face.TangentAxis * (Side == 0 ? -1.0 : 1.0);
+			FTraversalWallCorner& Corner = Face.Corners[Side];
+
+			for (int32 OtherIndex = 0; OtherIndex < Faces.Num(); ++OtherIndex)
+			{
+				const FTraversalWallFace& Other = Faces[OtherIndex];
+
+				// Only faces running along the face's up axis form a corner the character can turn around
+				const double Approach = FVector::DotProduct(Direction, Other.Normal);
+				if (OtherIndex == FaceIndex || FMath::Abs(Approach) < 0.01 || FMath::Abs(FVector::DotProduct(Other.Normal, Face.UpAxis)) > 0.01)
+					continue;
+
+				// Where the other face's plane crosses the face's center line
+				const double Offset = FVector::DotProduct(Other.Center - Face.Center, Other.Normal) / Approach;
+				if (Offset <= 0.0 || Offset > Face.HalfWidth + CornerTolerance)
+					continue;
+
+				const FVector CornerLocation = Face.Center + Direction * Offset;
+				const FVector OtherOffset = CornerLocation - Other.Center;
+				const double OtherTangentOffset = FMath::Abs(FVector::DotProduct(OtherOffset, Other.TangentAxis));
+				if (OtherTangentOffset > Other.HalfWidth + CornerTolerance || FMath::Abs(FVector::DotProduct(OtherOffset, Other.UpAxis)) > Other.HalfHeight + CornerTolerance)
+					continue;
+
+				// Extent of the other face in front of and behind the corner
+				const double OtherDepth = FVector::DotProduct(Other.Center - CornerLocation, Face.Normal);
+				const double OtherHalfDepth = Other.HalfWidth * FMath::Abs(FVector::DotProduct(Other.TangentAxis, Face.Normal));
+
+				// Inward faces face back along the direction and rise in front of the face. Outward faces start at the face's edge and continue behind it
+				const bool bInward = Approach < 0.0;
+				if (bInward)
+				{
+					if (OtherDepth + OtherHalfDepth <= CornerTolerance)
+						continue;
+				}
+				else if (OtherDepth - OtherHalfDepth >= -CornerTolerance || Offset < Face.HalfWidth - CornerTolerance || OtherTangentOffset < Other.HalfWidth - CornerTolerance)
+				{
+					continue;
+				}
+
+				const float TurnAngle = FMath::Acos(FMath::Clamp(FVector::DotProduct(Face.Normal, Other.Normal), -1.0, 1.0));
+
+				// Inward faces block the way, so the closest one wins over any outward face
+				const bool bBetter = Corner.Face == INDEX_NONE
+					|| (bInward && (!Corner.bInward || Offset < Corner.Offset))
+					|| (!bInward && !Corner.bInward && TurnAngle < Corner.TurnAngle);
+
+				if (bBetter)
+				{
+					Corner.Face = OtherIndex;
+					Corner.Offset = Offset;
+					Corner.TurnAngle = TurnAngle;
+					Corner.bInward = bInward;
+				}
+			}
+		}
+	}
+}
+
+int32 FTraversalWallGraph::FindFace(const FVector& Center, const FVector& Normal) const
+{
+	return Faces.IndexOfByPredicate([&Center, &Normal](const FTraversalWallFace& Face)
+		{
+			return FVector::DotProduct(Face.Normal, Normal) >= 0.999 && Face.Center.Equals(Center, 1.0);
+		});
+}
+
+const FTraversalWallCorner* FTraversalWallGraph::FindCorner(int32 FaceIndex, const FVector& Direction) const
+{
+	if (!Faces.IsValidIndex(FaceIndex))
+		return nullptr;
+
+	const FTraversalWallFace& Face = Faces[FaceIndex];
+	const FTraversalWallCorner& Corner = Face.Corners[FVector::DotProduct(Direction, Face.TangentAxis) >= 0.0 ? 1 : 0];
+
+	return Corner.Face != INDEX_NONE ? &Corner : nullptr;
+}
+
+bool IntersectSegments2D(const FVector& StartA, const FVector& EndA, const FVector& StartB, const FVector& EndB, double& OutTimeA, double& OutTimeB)
+{
+	const FVector2D DeltaA(EndA - StartA);
+	const FVector2D DeltaB(EndB - StartB);
+	const double Denominator = FVector2D::CrossProduct(DeltaA, DeltaB);
+
+	// Parallel segments are treated as not intersecting
+	if (FMath::IsNearlyZero(Denominator))
+		return false;
+
+	const FVector2D StartOffset(StartB - StartA);
+	OutTimeA = FVector2D::CrossProduct(StartOffset, DeltaB) / Denominator;
+	OutTimeB = FVector2D::CrossProduct(StartOffset, DeltaA) / Denominator;
+
+	return OutTimeA >= 0.0 && OutTimeA <= 1.0 && OutTimeB >= 0.0 && OutTimeB <= 1.0;
+}
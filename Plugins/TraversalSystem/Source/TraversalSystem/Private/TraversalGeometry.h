@@ -0,0 +1,161 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPrimitiveComponent;
+struct FTraversalLedge;
+
+/**
+* Oriented box in world space built from a simple collision element of a primitive.
+*/
+struct FTraversalBox
+{
+	FVector Center = FVector::ZeroVector;
+	FVector Axes[3] = { FVector::ForwardVector, FVector::RightVector, FVector::UpVector };
+	double HalfExtents[3] = { 0.0, 0.0, 0.0 };
+
+	// Whether the box is the exact collision shape, rather than the bounding box of a convex element that isn't a box.
+	bool bIsExact = true;
+
+	/**
+	* Get the axis that is closest to world up.
+	*
+	* @param OutSign 1 if the axis points up, -1 if it points down.
+	* @return Index of the axis.
+	*/
+	int32 GetUpAxis(double& OutSign) const;
+
+	/**
+	* Get the center of the face that points up.
+	*
+	* @return Center of the top face.
+	*/
+	FVector GetTopCenter() const;
+
+	/**
+	* Collect the box and convex simple collision elements of a primitive as world space boxes.
+	* Convex elements are approximated by their bounding box. Convex elements whose vertices are all corners of their bounding box are exact.
+	*
+	* @param Primitive Primitive to read the collision of.
+	* @param OutBoxes Boxes of the primitive's simple collision.
+	*/
+	template <typename AllocatorType>
+	static void GatherFromPrimitive(const UPrimitiveComponent* Primitive, TArray<FTraversalBox, AllocatorType>& OutBoxes);
+};
+
+// Boxes of a single primitive, gathered during checks without allocating. Collision with more elements spills to the heap.
+using FTraversalPrimitiveBoxes = TArray<FTraversalBox, TInlineAllocator<8>>;
+
+/**
+* Corner where a face of a wall graph meets another face to its left or right.
+*/
+struct FTraversalWallCorner
+{
+	// Face on the other side of the corner. INDEX_NONE if the face has no corner on this side.
+	int32 Face = INDEX_NONE;
+
+	// Distance from the center of the face to the corner, along the side's direction.
+	double Offset = 0.0;
+
+	// Angle in radians between the normals of both faces.
+	float TurnAngle = 0.0f;
+
+	// Whether the other face turns back in front of the face, rather than continuing behind its edge.
+	bool bInward = false;
+};
+
+/**
+* Flat face of a box collision element, with the corners at its left and right edges.
+*/
+struct FTraversalWallFace
+{
+	FVector Center = FVector::ZeroVector;
+	FVector Normal = FVector::ForwardVector;
+
+	// Axis of the face closest to horizontal.
+	FVector TangentAxis = FVector::RightVector;
+
+	// Axis of the face closest to vertical.
+	FVector UpAxis = FVector::UpVector;
+
+	double HalfWidth = 0.0;
+	double HalfHeight = 0.0;
+
+	// Corners in the direction of -TangentAxis and +TangentAxis.
+	FTraversalWallCorner Corners[2];
+};
+
+/**
+* Faces of a primitive's box collision and the corners between them, with the turn angle of each corner computed once.
+* Built by UTraversalWorldSubsystem the first time a wall of the primitive is climbed, and shared by every character climbing it. Never changed once built.
+*/
+class FTraversalWallGraph
+{
+public:
+	// Transform of the primitive when the graph was built.
+	FTransform ComponentTransform;
+
+	TArray<FTraversalWallFace> Faces;
+
+	/**
+	* Collect the faces of the primitive's exact box elements and link the faces that meet at a vertical corner.
+	*
+	* @param Primitive Primitive to read the collision of.
+	*/
+	void Build(const UPrimitiveComponent* Primitive);
+
+	/**
+	* Find the face with a center and normal.
+	*
+	* @param Center Center of the face.
+	* @param Normal Normal of the face.
+	* @return Index of the face, or INDEX_NONE if there is none.
+	*/
+	int32 FindFace(const FVector& Center, const FVector& Normal) const;
+
+	/**
+	* Get the corner of a face in a direction along the face.
+	*
+	* @param FaceIndex Index of the face.
+	* @param Direction Direction along the face. Only its side of the face's tangent axis is used.
+	* @return Corner on that side, or nullptr if the face ends there without one.
+	*/
+	const FTraversalWallCorner* FindCorner(int32 FaceIndex, const FVector& Direction) const;
+};
+
+/**
+* Get a face of a box.
+*
+* @param Box Box the face belongs to.
+* @param Axis Axis of the box the face is perpendicular to.
+* @param Sign 1 for the face on the positive side of the axis, -1 for the negative side.
+* @return The face, without corners.
+*/
+FTraversalWallFace MakeWallFace(const FTraversalBox& Box, int32 Axis, double Sign);
+
+/**
+* Compute the ledge above a hit on the side of a primitive whose simple collision is a single box with a flat top.
+* The ledge has the same shape as one baked by ATraversalLedgeIndex, without a landing.
+*
+* @param Primitive Primitive that was hit.
+* @param ImpactPoint Impact point on the side of the box.
+* @param ImpactNormal Impact normal of the hit. Hits on the box's edges don't have a face normal and aren't solved.
+* @param OutLedge Top edge of the face that was hit, the depth of the box behind it and the height of the face.
+* @return The ledge was computed.
+*/
+bool FindCollisionLedge(const UPrimitiveComponent* Primitive, const FVector& ImpactPoint, const FVector& ImpactNormal, FTraversalLedge& OutLedge);
+
+/**
+* Intersect two segments projected onto the XY plane.
+*
+* @param StartA Start of the first segment.
+* @param EndA End of the first segment.
+* @param StartB Start of the second segment.
+* @param EndB End of the second segment.
+* @param OutTimeA Position of the intersection along the first segment, from 0 to 1.
+* @param OutTimeB Position of the intersection along the second segment, from 0 to 1.
+* @return Segments intersect.
+*/
+bool IntersectSegments2D(const FVector& StartA, const FVector& EndA, const FVector& StartB, const FVector& EndB, double& OutTimeA, double& OutTimeB);
@@ -0,0 +1,237 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalLedgeIndex.h"
+#include "TraversalGeometry.h"
+#include "TraversalWorldSubsystem.h"
+#include "TraversalStats.h"
+#include "TraversalDebug.h"
+#include "Components/BoxComponent.h"
+#include "Algo/BinarySearch.h"
+#include "EngineUtils.h"
+
+ATraversalLedgeIndex::ATraversalLedgeIndex()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	BoundsComponent = CreateDefaultSubobject<UBoxComponent>(TEXT("Bounds"));
+	BoundsComponent->SetBoxExtent(FVector(2000.0f, 2000.0f, 500.0f));
+	BoundsComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BoundsComponent->SetMobility(EComponentMobility::Static);
+	RootComponent = BoundsComponent;
+
+	DetectionTraceChannel = UEngineTypes::ConvertToTraceType(ECC_Visibility);
+
+#if WITH_EDITORONLY_DATA
+	// Stream the baked ledges in and out with the cell they were baked for
+	bIsSpatiallyLoaded = true;
+#endif
+}
+
+void ATraversalLedgeIndex::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UTraversalWorldSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UTraversalWorldSubsystem>())
+	{
+		TraversalSubsystem->RegisterLedgeIndex(this);
+	}
+}
+
+void ATraversalLedgeIndex::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTraversalWorldSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UTraversalWorldSubsystem>())
+	{
+		TraversalSubsystem->UnregisterLedgeIndex(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ATraversalLedgeIndex::FindLedge(const FVector& Origin, const FVector& Direction, float MaxDistance, float MinZ, float MaxZ, FTraversalLedge& OutLedge, float& OutDistance) const
+{
+	const FVector RayDirection = Direction.GetSafeNormal2D();
+	if (RayDirection.IsZero() || MaxDistance <= 0.0f)
+		return false;
+
+	const FVector RayEnd = Origin + RayDirection * MaxDistance;
+
+	// Ledges are sorted by the X of their center, so only a slice of them can be crossed by the ray
+	const double MinX = FMath::Min(Origin.X, RayEnd.X) - MaxHalfLengthX;
+	const double MaxX = FMath::Max(Origin.X, RayEnd.X) + MaxHalfLengthX;
+
+	int32 Index = Algo::LowerBoundBy(Ledges, MinX, [](const FTraversalLedge& Ledge) { return Ledge.GetCenter().X; });
+
+	const FTraversalLedge* ClosestLedge = nullptr;
+	double ClosestTime = 1.0;
+
+	for (; Index < Ledges.Num() && Ledges[Index].GetCenter().X <= MaxX; ++Index)
+	{
+		const FTraversalLedge& Ledge = Ledges[Index];
+
+		// Only ledges whose face points towards the ray can be climbed
+		if (FVector::DotProduct(FVector(Ledge.Normal), RayDirection) >= 0.0)
+			continue;
+
+		double RayTime, LedgeTime;
+		if (!IntersectSegments2D(Origin, RayEnd, Ledge.Start, Ledge.End, RayTime, LedgeTime) || RayTime > ClosestTime)
+			continue;
+
+		const double LedgeZ = FMath::Lerp(Ledge.Start.Z, Ledge.End.Z, LedgeTime);
+		if (LedgeZ < MinZ || LedgeZ > MaxZ)
+			continue;
+
+		ClosestLedge = &Ledge;
+		ClosestTime = RayTime;
+	}
+
+	if (!ClosestLedge)
+		return false;
+
+	OutLedge = *ClosestLedge;
+	OutDistance = static_cast<float>(ClosestTime * MaxDistance);
+	return true;
+}
+
+bool ATraversalLedgeIndex::HasLedgeNear(const FVector& Location, float Radius) const
+{
+	const double MinX = Location.X - Radius - MaxHalfLengthX;
+	const double MaxX = Location.X + Radius + MaxHalfLengthX;
+	const double RadiusSquared = FMath::Square(Radius);
+
+	int32 Index = Algo::LowerBoundBy(Ledges, MinX, [](const FTraversalLedge& Ledge) { return Ledge.GetCenter().X; });
+
+	for (; Index < Ledges.Num() && Ledges[Index].GetCenter().X <= MaxX; ++Index)
+	{
+		if (FMath::PointDistToSegmentSquared(Location, Ledges[Index].Start, Ledges[Index].End) <= RadiusSquared)
+			return true;
+	}
+
+	return false;
+}
+
+#if WITH_EDITOR
+void ATraversalLedgeIndex::Bake()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+		return;
+
+	LLM_SCOPE_BYTAG(Traversal);
+
+	Modify();
+	Ledges.Reset();
+
+	const FBox Bounds = BoundsComponent->Bounds.GetBox();
+	const ECollisionChannel TraceChannel = UEngineTypes::ConvertToCollisionChannel(DetectionTraceChannel);
+
+	// Collect the simple collision of every static primitive in the bounds. Everything else is traced at runtime
+	TArray<FTraversalBox> Boxes;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (*It == this)
+			continue;
+
+		It->ForEachComponent<UPrimitiveComponent>(false, [&Boxes, &Bounds, TraceChannel](const UPrimitiveComponent* Primitive)
+		{
+			if (Primitive->Mobility != EComponentMobility::Static || !Primitive->IsCollisionEnabled() || Primitive->GetCollisionResponseToChannel(TraceChannel) != ECR_Block)
+				return;
+
+			if (Bounds.Intersect(Primitive->Bounds.GetBox()))
+			{
+				FTraversalBox::GatherFromPrimitive(Primitive, Boxes);
+			}
+		});
+	}
+
+	// Every edge of a walkable top surface is a candidate ledge
+	for (const FTraversalBox& Box : Boxes)
+	{
+		double UpSign;
+		const int32 UpAxis = Box.GetUpAxis(UpSign);
+		if (Box.Axes[UpAxis].Z * UpSign < MinTopNormalZ)
+			continue;
+
+		const FVector TopCenter = Box.GetTopCenter();
+
+		for (int32 EdgeAxis = 0; EdgeAxis < 3; ++EdgeAxis)
+		{
+			if (EdgeAxis == UpAxis)
+				continue;
+
+			const int32 AlongAxis = 3 - UpAxis - EdgeAxis;
+			const FVector HalfAlong = Box.Axes[AlongAxis] * Box.HalfExtents[AlongAxis];
+
+			for (const double Side : { 1.0, -1.0 })
+			{
+				const FVector Outward = Box.Axes[EdgeAxis] * Side;
+				const FVector EdgeCenter = TopCenter + Outward * Box.HalfExtents[EdgeAxis];
+				BakeEdge(World, EdgeCenter - HalfAlong, EdgeCenter + HalfAlong, Outward.GetSafeNormal2D(), static_cast<float>(Box.HalfExtents[EdgeAxis] * 2.0));
+			}
+		}
+	}
+
+	Ledges.Sort([](const FTraversalLedge& A, const FTraversalLedge& B)
+	{
+		return A.GetCenter().X < B.GetCenter().X;
+	});
+
+	MaxHalfLengthX = 0.0;
+	LedgeBounds.Init();
+	for (const FTraversalLedge& Ledge : Ledges)
+	{
+		MaxHalfLengthX = FMath::Max(MaxHalfLengthX, FMath::Abs(Ledge.End.X - Ledge.Start.X) * 0.5);
+		LedgeBounds += Ledge.Start;
+		LedgeBounds += Ledge.End;
+	}
+
+	UE_LOG(LogTraversal, Log, TEXT("%s: Baked %d ledges from %d collision boxes"), *GetName(), Ledges.Num(), Boxes.Num());
+}
+
+void ATraversalLedgeIndex::BakeEdge(UWorld* World, const FVector& Start, const FVector& End, const FVector& Normal, float Depth)
+{
+	const FVector Center = (Start + End) * 0.5;
+
+	// Edges outside the bounds belong to the neighbouring index
+	if (Normal.IsNearlyZero() || !BoundsComponent->Bounds.GetBox().IsInside(Center))
+		return;
+
+	const ECollisionChannel TraceChannel = UEngineTypes::ConvertToCollisionChannel(DetectionTraceChannel);
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(TraversalLedgeBake), false, this);
+
+	// Measure the height from the ground in front of the edge. Starting slightly above the edge rejects edges shared with a neighbouring surface of the same height
+	FHitResult GroundHit;
+	const FVector ProbeStart = Center + Normal * EdgeProbeDistance + FVector(0.0f, 0.0f, 2.0f);
+	if (!World->LineTraceSingleByChannel(GroundHit, ProbeStart, ProbeStart - FVector(0.0f, 0.0f, MaxLedgeHeight + 2.0f), TraceChannel, Params))
+		return;
+
+	const float Height = static_cast<float>(Center.Z - GroundHit.ImpactPoint.Z);
+	if (Height < MinLedgeHeight || Height > MaxLedgeHeight)
+		return;
+
+	// Skip edges that are covered by other objects
+	const FVector TopLocation = Center - Normal * CapsuleRadius + FVector(0.0f, 0.0f, CapsuleRadius + 2.0f);
+	if (World->OverlapBlockingTestByChannel(TopLocation, FQuat::Identity, TraceChannel, FCollisionShape::MakeSphere(CapsuleRadius), Params))
+		return;
+
+	FTraversalLedge Ledge;
+	Ledge.Start = Start;
+	Ledge.End = End;
+	Ledge.Normal = FVector3f(Normal);
+	Ledge.Depth = Depth;
+	Ledge.Height = Height;
+
+	// Look for ground behind the obstacle, and room for the capsule standing at the height of the character approaching the ledge
+	FHitResult LandHit;
+	const FVector LandStart = Center - Normal * (Depth + LandDistance);
+	if (World->LineTraceSingleByChannel(LandHit, LandStart, LandStart - FVector(0.0f, 0.0f, MaxLandVerticalDistance), TraceChannel, Params) && !LandHit.bStartPenetrating)
+	{
+		FVector RoomLocation = Center - Normal * (Depth + CapsuleRadius + LandDistance);
+		RoomLocation.Z = GroundHit.ImpactPoint.Z + CapsuleHalfHeight;
+
+		Ledge.LandZ = static_cast<float>(LandHit.ImpactPoint.Z);
+		Ledge.bHasLandingRoom = !World->OverlapBlockingTestByChannel(RoomLocation, FQuat::Identity, TraceChannel, FCollisionShape::MakeCapsule(CapsuleRadius, CapsuleHalfHeight), Params);
+	}
+
+	Ledges.Add(Ledge);
+}
+#endif
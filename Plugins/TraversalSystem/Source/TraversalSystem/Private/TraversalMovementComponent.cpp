@@ -0,0 +1,349 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalMovementComponent.h"
+#include "TraversalConfig.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+
+// Compressed flags carrying the requested traversal mode
+static constexpr uint8 TraversalModeFlagsShift = 4;
+static constexpr uint8 TraversalModeFlagsMask = FSavedMove_Character::FLAG_Custom_0 | FSavedMove_Character::FLAG_Custom_1 | FSavedMove_Character::FLAG_Custom_2;
+
+static_assert(static_cast<uint8>(ETraversalState::WallClimbing) <= (TraversalModeFlagsMask >> TraversalModeFlagsShift), "Traversal modes don't fit into the compressed flags");
+
+
+/***** Saved move *****/
+
+void FSavedMove_Traversal::Clear()
+{
+	Super::Clear();
+
+	SavedTraversalMode = ETraversalState::None;
+	SavedSlideTimeRemainder = 0.0f;
+}
+
+uint8 FSavedMove_Traversal::GetCompressedFlags() const
+{
+	return Super::GetCompressedFlags() | ((static_cast<uint8>(SavedTraversalMode) << TraversalModeFlagsShift) & TraversalModeFlagsMask);
+}
+
+bool FSavedMove_Traversal::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	if (SavedTraversalMode != static_cast<const FSavedMove_Traversal*>(NewMove.Get())->SavedTraversalMode)
+		return false;
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Traversal::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const UTraversalMovementComponent* MovementComponent = Cast<UTraversalMovementComponent>(C->GetCharacterMovement()))
+	{
+		SavedTraversalMode = MovementComponent->RequestedTraversalMode;
+		SavedSlideTimeRemainder = MovementComponent->SlideTimeRemainder;
+	}
+}
+
+void FSavedMove_Traversal::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// Replayed moves enter and leave the traversal modes where they originally did
+	if (UTraversalMovementComponent* MovementComponent = Cast<UTraversalMovementComponent>(C->GetCharacterMovement()))
+	{
+		MovementComponent->RequestedTraversalMode = SavedTraversalMode;
+		MovementComponent->SlideTimeRemainder = SavedSlideTimeRemainder;
+	}
+}
+
+FNetworkPredictionData_Client_Traversal::FNetworkPredictionData_Client_Traversal(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Traversal::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Traversal());
+}
+
+
+/***** Traversal modes *****/
+
+void UTraversalMovementComponent::SetTraversalMode(ETraversalState Mode)
+{
+	RequestedTraversalMode = Mode;
+
+	if (Mode != ETraversalState::None)
+	{
+		SetMovementMode(MOVE_Custom, static_cast<uint8>(Mode));
+	}
+	else if (GetTraversalMode() != ETraversalState::None)
+	{
+		SetMovementMode(MOVE_Walking);
+	}
+}
+
+ETraversalState UTraversalMovementComponent::GetTraversalMode() const
+{
+	if (MovementMode != MOVE_Custom || CustomMovementMode > static_cast<uint8>(ETraversalState::WallClimbing))
+		return ETraversalState::None;
+
+	return static_cast<ETraversalState>(CustomMovementMode);
+}
+
+bool UTraversalMovementComponent::CanEnterTraversalMode(ETraversalState Mode)
+{
+	if (Mode == ETraversalState::None)
+		return true;
+
+	// Slides start from the ground
+	if (Mode == ETraversalState::Sliding)
+		return MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking;
+
+	// Clients replay their own moves. The server only follows a remote client into the other modes once it has validated them itself
+	if (CharacterOwner->GetLocalRole() != ROLE_Authority || CharacterOwner->IsLocallyControlled())
+		return true;
+
+	return TraversalComponent && TraversalComponent->CanEnterClientTraversalMode(Mode);
+}
+
+void UTraversalMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	// Follow the mode the move was made in. On the server this is the mode the client requested, in replays the mode the move was saved with
+	if (RequestedTraversalMode != GetTraversalMode() && CanEnterTraversalMode(RequestedTraversalMode))
+	{
+		SetTraversalMode(RequestedTraversalMode);
+	}
+}
+
+void UTraversalMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	// Modes left by the movement itself, like a slide that ran out of speed, aren't requested anymore
+	const ETraversalState TraversalMode = GetTraversalMode();
+	RequestedTraversalMode = TraversalMode;
+
+	if (TraversalMode == ETraversalState::Sliding)
+	{
+		SlideTimeRemainder = 0.0f;
+	}
+
+	// Face the wall while wall climbing instead of the movement direction
+	const bool bWasWallClimbing = PreviousMovementMode == MOVE_Custom && PreviousCustomMode == static_cast<uint8>(ETraversalState::WallClimbing);
+	if (TraversalMode == ETraversalState::WallClimbing && !bWasWallClimbing)
+	{
+		bWallClimbOrientedRotationToMovement = bOrientRotationToMovement;
+		bOrientRotationToMovement = false;
+	}
+	else if (TraversalMode != ETraversalState::WallClimbing && bWasWallClimbing)
+	{
+		bOrientRotationToMovement = bWallClimbOrientedRotationToMovement;
+	}
+}
+
+float UTraversalMovementComponent::GetMaxSpeed() const
+{
+	switch (GetTraversalMode())
+	{
+	case ETraversalState::Vaulting:
+	case ETraversalState::Mantling:
+		return MaxFlySpeed;
+	case ETraversalState::Sliding:
+		return MaxWalkSpeed;
+	case ETraversalState::WallClimbing:
+		return TraversalComponent ? TraversalComponent->Config->WallClimbSpeed : MaxFlySpeed;
+	default:
+		return Super::GetMaxSpeed();
+	}
+}
+
+float UTraversalMovementComponent::GetMaxBrakingDeceleration() const
+{
+	switch (GetTraversalMode())
+	{
+	case ETraversalState::Vaulting:
+	case ETraversalState::Mantling:
+		return BrakingDecelerationFlying;
+	case ETraversalState::Sliding:
+		return TraversalComponent ? TraversalComponent->Config->SlideBrakingPower : BrakingDecelerationWalking;
+	case ETraversalState::WallClimbing:
+		return TraversalComponent ? TraversalComponent->Config->WallClimbBrakingDeceleration : BrakingDecelerationFlying;
+	default:
+		return Super::GetMaxBrakingDeceleration();
+	}
+}
+
+bool UTraversalMovementComponent::IsMovingOnGround() const
+{
+	return Super::IsMovingOnGround() || (GetTraversalMode() == ETraversalState::Sliding && UpdatedComponent);
+}
+
+void UTraversalMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	// The flags have room for values that aren't traversal modes
+	const uint8 Mode = (Flags & TraversalModeFlagsMask) >> TraversalModeFlagsShift;
+	RequestedTraversalMode = Mode <= static_cast<uint8>(ETraversalState::WallClimbing) ? static_cast<ETraversalState>(Mode) : ETraversalState::None;
+}
+
+FNetworkPredictionData_Client* UTraversalMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UTraversalMovementComponent* MutableThis = const_cast<UTraversalMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Traversal(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+
+/***** Physics *****/
+
+void UTraversalMovementComponent::PhysCustom(float DeltaTime, int32 Iterations)
+{
+	switch (GetTraversalMode())
+	{
+	case ETraversalState::Vaulting:
+	case ETraversalState::Mantling:
+		if (TraversalComponent && TraversalComponent->ActiveAction.BakedRootMotion && TraversalComponent->ActiveAction.bMovedByMovementComponent)
+		{
+			PhysBakedRootMotion(DeltaTime, Iterations);
+			break;
+		}
+		[[fallthrough]];
+	case ETraversalState::WallClimbing:
+		// Vaults and mantles are driven by root motion, wall climbs by input on the wall plane
+		PhysFlying(DeltaTime, Iterations);
+		break;
+	case ETraversalState::Sliding:
+		PhysSlide(DeltaTime, Iterations);
+		break;
+	default:
+		Super::PhysCustom(DeltaTime, Iterations);
+		break;
+	}
+}
+
+void UTraversalMovementComponent::PhysSlide(float DeltaTime, int32 Iterations)
+{
+	if (DeltaTime < MIN_TICK_TIME)
+		return;
+
+	if (!TraversalComponent || !CurrentFloor.IsWalkableFloor())
+	{
+		SetTraversalMode(ETraversalState::None);
+		StartNewPhysics(DeltaTime, Iterations);
+		return;
+	}
+
+	RestorePreAdditiveRootMotionVelocity();
+
+	float MoveTime = DeltaTime;
+	FVector MoveDelta = FVector::ZeroVector;
+
+	if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	{
+		// Integrate on a fixed step grid, so client and server reach the same velocity and distance whatever their frame rates
+		const float SubstepTime = TraversalComponent->Config->SlideSubstepTime;
+		SlideTimeRemainder += DeltaTime;
+		int32 NumSubsteps = FMath::FloorToInt32(SlideTimeRemainder / SubstepTime);
+		if (NumSubsteps > TraversalComponent->Config->SlideMaxSubsteps)
+		{
+			NumSubsteps = TraversalComponent->Config->SlideMaxSubsteps;
+			SlideTimeRemainder = 0.0f;
+		}
+		else
+		{
+			SlideTimeRemainder -= NumSubsteps * SubstepTime;
+		}
+
+		const FVector SlideAcceleration = TraversalComponent->CalculateSlideForce(CurrentFloor.HitResult.ImpactNormal) / Mass;
+		for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
+		{
+			// Same as adding the slide force for the step, then braking with the slide friction
+			Velocity += SlideAcceleration * SubstepTime;
+			MaintainHorizontalGroundVelocity();
+			CalcVelocity(SubstepTime, TraversalComponent->Config->SlideGroundFriction, false, GetMaxBrakingDeceleration());
+			Velocity = Velocity.GetClampedToMaxSize(TraversalComponent->Config->SlideMaxSpeed);
+			MoveDelta += Velocity * SubstepTime;
+		}
+
+		MoveTime = NumSubsteps * SubstepTime;
+	}
+	else
+	{
+		ApplyRootMotionToVelocity(DeltaTime);
+		MoveDelta = Velocity * DeltaTime;
+	}
+
+	Iterations++;
+	bJustTeleported = false;
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+
+	// The steps are swept as a single move
+	if (MoveTime > 0.0f && !MoveDelta.IsNearlyZero())
+	{
+		MoveAlongFloor(MoveDelta / MoveTime, MoveTime);
+	}
+
+	FindFloor(UpdatedComponent->GetComponentLocation(), CurrentFloor, false);
+	if (CurrentFloor.IsWalkableFloor())
+	{
+		AdjustFloorHeight();
+		SetBaseFromFloor(CurrentFloor);
+	}
+
+	// Keep the integrated velocity unless the move was blocked, so the next update continues from the last step
+	if (!bJustTeleported && MoveTime > 0.0f && !HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	{
+		const FVector ActualDelta = UpdatedComponent->GetComponentLocation() - OldLocation;
+		if (ActualDelta.SizeSquared2D() < MoveDelta.SizeSquared2D() * 0.99f)
+		{
+			Velocity = ActualDelta / MoveTime;
+			MaintainHorizontalGroundVelocity();
+		}
+	}
+
+	// Walking falls off the edge on the next update if there is no floor
+	if (!CurrentFloor.IsWalkableFloor() || Velocity.SizeSquared() < FMath::Square(TraversalComponent->Config->SlideMinSpeed))
+	{
+		SetTraversalMode(ETraversalState::None);
+	}
+}
+
+void UTraversalMovementComponent::PhysBakedRootMotion(float DeltaTime, int32 Iterations)
+{
+	if (DeltaTime < MIN_TICK_TIME)
+		return;
+
+	FVector Location;
+	FQuat Rotation;
+	const bool bContinues = TraversalComponent->AdvanceBakedAction(DeltaTime, Location, Rotation);
+
+	// Objects may have moved into the path since the check, and low LOD levels skip the path sweep, so the move is swept
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	const FVector Delta = Location - OldLocation;
+	FHitResult Hit(1.0f);
+	SafeMoveUpdatedComponent(Delta, Rotation, true, Hit);
+	if (Hit.IsValidBlockingHit())
+	{
+		// Graze along what was hit, like the montage driven flying movement does
+		SlideAlongSurface(Delta, 1.0f - Hit.Time, Hit.Normal, Hit, true);
+	}
+
+	Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / DeltaTime;
+
+	// Something stands in the way if the capsule fell behind the root motion by more than its radius
+	const bool bBlocked = FVector::DistSquared(UpdatedComponent->GetComponentLocation(), Location) > FMath::Square(CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius());
+	if (bBlocked || !bContinues)
+	{
+		TraversalComponent->FinishAction(bBlocked);
+	}
+}
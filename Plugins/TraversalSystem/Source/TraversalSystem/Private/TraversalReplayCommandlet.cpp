@@ -0,0 +1,167 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalReplayCommandlet.h"
+#include "TraversalCapture.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTraversalReplay, Log, All);
+
+UTraversalReplayCommandlet::UTraversalReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UTraversalReplayCommandlet::Main(const FString& Params)
+{
+	FString CapturePath;
+	int32 NumRepeats = 100;
+
+	if (!FParse::Value(*Params, TEXT("Capture="), CapturePath))
+	{
+		UE_LOG(LogTraversalReplay, Error, TEXT("No capture file. Pass -Capture=<file>."));
+		return 1;
+	}
+
+	FParse::Value(*Params, TEXT("Repeat="), NumRepeats);
+	NumRepeats = FMath::Max(NumRepeats, 1);
+
+	TArray<FTraversalCaptureTuning> Tunings;
+	TArray<FTraversalCheckCapture> Captures;
+	if (!TraversalCapture::LoadFile(CapturePath, Tunings, Captures))
+	{
+		UE_LOG(LogTraversalReplay, Error, TEXT("%s could not be read, or was captured by another version."), *CapturePath);
+		return 1;
+	}
+
+	// Only used to test whether hits are walkable. The walkable floor Z is set per check
+	UCharacterMovementComponent* Movement = NewObject<UCharacterMovementComponent>(GetTransientPackage());
+
+	TArray<UTraversalComponent*> Components;
+	for (const FTraversalCaptureTuning& Tuning : Tunings)
+	{
+		Components.Add(CreateComponent(Tuning, Movement));
+	}
+
+	// Indexed by the action of the check, like the checks of the benchmark
+	TArray<FReplayResults> Results;
+	Results.SetNum(static_cast<int32>(ETraversalState::WallClimbing) + 1);
+	Results[static_cast<int32>(ETraversalState::None)].Name = TEXT("EvaluateTraversal");
+	Results[static_cast<int32>(ETraversalState::Vaulting)].Name = TEXT("VaultCheck");
+	Results[static_cast<int32>(ETraversalState::Mantling)].Name = TEXT("MantleCheck");
+	Results[static_cast<int32>(ETraversalState::WallClimbing)].Name = TEXT("WallClimbCheck");
+
+	int32 NumSkipped = 0;
+
+	for (int32 CaptureIndex = 0; CaptureIndex < Captures.Num(); ++CaptureIndex)
+	{
+		const FTraversalCheckCapture& Capture = Captures[CaptureIndex];
+		UTraversalComponent* Component = Components.IsValidIndex(Capture.Tuning) ? Components[Capture.Tuning] : nullptr;
+		if (!Component || !Results.IsValidIndex(static_cast<int32>(Capture.InitialCheck.Action)))
+		{
+			++NumSkipped;
+			continue;
+		}
+
+		Component->CurrentLOD = Capture.LOD;
+		Movement->SetWalkableFloorZ(Capture.WalkableFloorZ);
+
+		FTraversalCheck Check;
+		bool bReplayed = false;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat)
+		{
+			Check = Capture.InitialCheck;
+			bReplayed = Component->ReplayCheck(Check, Capture.Steps);
+		}
+
+		FReplayResults& Result = Results[static_cast<int32>(Capture.InitialCheck.Action)];
+		Result.Times.Add(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) / NumRepeats);
+
+		// Captures are only written once their check finished, so a replay that ran out of steps diverged too
+		if (!bReplayed || !Check.IsFinished() || !DoesOutcomeMatch(Capture, Check))
+		{
+			++Result.NumDiverged;
+			UE_LOG(LogTraversalReplay, Warning, TEXT("Check %d (%s at %.3fs) diverged. Captured %s %s, replayed %s %s."), CaptureIndex, *Result.Name, Capture.Time,
+				*UEnum::GetValueAsString(Capture.FinalPlan.Action), *UEnum::GetValueAsString(Capture.FinalStage), *UEnum::GetValueAsString(Check.Plan.Action), *UEnum::GetValueAsString(Check.Stage));
+		}
+		else
+		{
+			++Result.NumMatched;
+		}
+	}
+
+	int32 NumDiverged = 0;
+	for (FReplayResults& Result : Results)
+	{
+		if (Result.Times.IsEmpty())
+			continue;
+
+		Result.Times.Sort();
+
+		double TotalTime = 0.0;
+		for (const double Time : Result.Times)
+		{
+			TotalTime += Time;
+		}
+
+		auto Percentile = [&Result](double Ratio)
+		{
+			return Result.Times[FMath::Clamp(FMath::CeilToInt32(Ratio * Result.Times.Num()) - 1, 0, Result.Times.Num() - 1)] * 1000000.0;
+		};
+
+		UE_LOG(LogTraversalReplay, Display, TEXT("%-18s checks %6d  matched %6d  diverged %6d  mean %8.3fus  p50 %8.3fus  p99 %8.3fus"),
+			*Result.Name, Result.Times.Num(), Result.NumMatched, Result.NumDiverged, TotalTime / Result.Times.Num() * 1000000.0, Percentile(0.5), Percentile(0.99));
+
+		NumDiverged += Result.NumDiverged;
+	}
+
+	if (NumSkipped > 0)
+	{
+		UE_LOG(LogTraversalReplay, Warning, TEXT("%d checks were skipped because their component or config class could not be loaded."), NumSkipped);
+	}
+
+	return NumDiverged > 0 ? 1 : 0;
+}
+
+UTraversalComponent* UTraversalReplayCommandlet::CreateComponent(const FTraversalCaptureTuning& Tuning, UCharacterMovementComponent* Movement) const
+{
+	UClass* ComponentClass = LoadClass<UTraversalComponent>(nullptr, *Tuning.ClassPath);
+	if (!ComponentClass)
+	{
+		UE_LOG(LogTraversalReplay, Error, TEXT("Component class %s could not be loaded."), *Tuning.ClassPath);
+		return nullptr;
+	}
+
+	UTraversalComponent* Component = NewObject<UTraversalComponent>(GetTransientPackage(), ComponentClass);
+	TraversalCapture::ApplyTuning(Component, Tuning);
+	Component->PlayerCharacterMovement = Movement;
+
+	Component->Config = TraversalCapture::CreateConfig(Component, Tuning);
+	if (!Component->Config)
+		return nullptr;
+
+	return Component;
+}
+
+bool UTraversalReplayCommandlet::DoesOutcomeMatch(const FTraversalCheckCapture& Capture, const FTraversalCheck& Check) const
+{
+	if (Check.Stage != Capture.FinalStage)
+		return false;
+
+	if (Check.Stage != ETraversalCheckStage::Succeeded)
+		return true;
+
+	const FTraversalPlan& Plan = Check.Plan;
+	const FTraversalPlan& CapturedPlan = Capture.FinalPlan;
+	return Plan.Action == CapturedPlan.Action
+		&& Plan.ObjectStartWarpTarget.Equals(CapturedPlan.ObjectStartWarpTarget)
+		&& Plan.ObjectEndWarpTarget.Equals(CapturedPlan.ObjectEndWarpTarget)
+		&& Plan.LandWarpTarget.Equals(CapturedPlan.LandWarpTarget)
+		&& FMath::IsNearlyEqual(Plan.Height, CapturedPlan.Height)
+		&& FMath::IsNearlyEqual(Plan.Depth, CapturedPlan.Depth)
+		&& Plan.AnimationProperties.EntryIndex == CapturedPlan.AnimationProperties.EntryIndex;
+}
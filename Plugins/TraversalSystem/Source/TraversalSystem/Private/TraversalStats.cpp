@@ -0,0 +1,85 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalStats.h"
+#include "TraversalComponent.h"
+
+DEFINE_STAT(STAT_TraversalVaultCheck);
+DEFINE_STAT(STAT_TraversalMantleCheck);
+DEFINE_STAT(STAT_TraversalEvaluate);
+DEFINE_STAT(STAT_TraversalWallClimbCheck);
+DEFINE_STAT(STAT_TraversalAsyncCheckStep);
+DEFINE_STAT(STAT_TraversalCheckBatch);
+DEFINE_STAT(STAT_TraversalLedgeLookup);
+DEFINE_STAT(STAT_TraversalSlideUpdate);
+DEFINE_STAT(STAT_TraversalWallClimbMovement);
+DEFINE_STAT(STAT_TraversalWallGraphBuild);
+
+DEFINE_STAT(STAT_TraversalTraceObjectClimbable);
+DEFINE_STAT(STAT_TraversalTraceSurfaceWalkable);
+DEFINE_STAT(STAT_TraversalTraceVaultReach);
+DEFINE_STAT(STAT_TraversalTraceVaultDepth);
+DEFINE_STAT(STAT_TraversalTraceVaultRoom);
+DEFINE_STAT(STAT_TraversalTraceVaultLand);
+DEFINE_STAT(STAT_TraversalTraceCapsulePath);
+DEFINE_STAT(STAT_TraversalTraceWallForward);
+DEFINE_STAT(STAT_TraversalTraceWallRoom);
+
+DEFINE_STAT(STAT_TraversalTracesIssued);
+DEFINE_STAT(STAT_TraversalChecksAttempted);
+DEFINE_STAT(STAT_TraversalActionsStarted);
+DEFINE_STAT(STAT_TraversalBatchedChecks);
+DEFINE_STAT(STAT_TraversalNetPlansSent);
+DEFINE_STAT(STAT_TraversalNetPlanBytes);
+DEFINE_STAT(STAT_TraversalLookAheadChecks);
+DEFINE_STAT(STAT_TraversalArmedPlansCommitted);
+DEFINE_STAT(STAT_TraversalParallelTracesWasted);
+
+CSV_DEFINE_CATEGORY_MODULE(, Traversal, true);
+
+LLM_DEFINE_TAG(Traversal);
+
+TStatId GetTraversalTraceStatId(ETraversalCheckStage Stage)
+{
+	switch (Stage)
+	{
+	case ETraversalCheckStage::ObjectClimbable:
+		return GET_STATID(STAT_TraversalTraceObjectClimbable);
+	case ETraversalCheckStage::SurfaceWalkable:
+		return GET_STATID(STAT_TraversalTraceSurfaceWalkable);
+	case ETraversalCheckStage::VaultReach:
+		return GET_STATID(STAT_TraversalTraceVaultReach);
+	case ETraversalCheckStage::VaultDepth:
+		return GET_STATID(STAT_TraversalTraceVaultDepth);
+	case ETraversalCheckStage::VaultRoom:
+		return GET_STATID(STAT_TraversalTraceVaultRoom);
+	case ETraversalCheckStage::VaultLand:
+		return GET_STATID(STAT_TraversalTraceVaultLand);
+	case ETraversalCheckStage::CapsulePath:
+		return GET_STATID(STAT_TraversalTraceCapsulePath);
+	case ETraversalCheckStage::WallForward:
+		return GET_STATID(STAT_TraversalTraceWallForward);
+	default:
+		// The four wall room traces share one stat
+		return GET_STATID(STAT_TraversalTraceWallRoom);
+	}
+}
+
+void CountTraversalTrace()
+{
+	INC_DWORD_STAT(STAT_TraversalTracesIssued);
+	CSV_CUSTOM_STAT(Traversal, TracesIssued, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void CountTraversalActionStarted()
+{
+	INC_DWORD_STAT(STAT_TraversalActionsStarted);
+	CSV_CUSTOM_STAT(Traversal, ActionsStarted, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void CountTraversalNetPlan(int32 NumBytes)
+{
+	INC_DWORD_STAT(STAT_TraversalNetPlansSent);
+	INC_DWORD_STAT_BY(STAT_TraversalNetPlanBytes, NumBytes);
+	CSV_CUSTOM_STAT(Traversal, NetPlansSent, 1, ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(Traversal, NetPlanBytes, NumBytes, ECsvCustomStatOp::Accumulate);
+}
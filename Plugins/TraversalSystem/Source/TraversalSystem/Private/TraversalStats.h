@@ -0,0 +1,81 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "HAL/LowLevelMemTracker.h"
+
+enum class ETraversalCheckStage : uint8;
+
+DECLARE_STATS_GROUP(TEXT("Traversal"), STATGROUP_Traversal, STATCAT_Advanced);
+
+// Checks
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Vault Check"), STAT_TraversalVaultCheck, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mantle Check"), STAT_TraversalMantleCheck, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate Traversal"), STAT_TraversalEvaluate, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Wall Climb Check"), STAT_TraversalWallClimbCheck, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Async Check Step"), STAT_TraversalAsyncCheckStep, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Check Batch"), STAT_TraversalCheckBatch, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ledge Index Lookup"), STAT_TraversalLedgeLookup, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Slide Update"), STAT_TraversalSlideUpdate, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Wall Climb Movement"), STAT_TraversalWallClimbMovement, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Wall Graph Build"), STAT_TraversalWallGraphBuild, STATGROUP_Traversal, );
+
+// Trace stages
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Object Climbable"), STAT_TraversalTraceObjectClimbable, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Surface Walkable"), STAT_TraversalTraceSurfaceWalkable, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Vault Reach"), STAT_TraversalTraceVaultReach, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Vault Depth"), STAT_TraversalTraceVaultDepth, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Vault Room"), STAT_TraversalTraceVaultRoom, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Vault Land"), STAT_TraversalTraceVaultLand, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Capsule Path"), STAT_TraversalTraceCapsulePath, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Wall Forward"), STAT_TraversalTraceWallForward, STATGROUP_Traversal, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trace Wall Room"), STAT_TraversalTraceWallRoom, STATGROUP_Traversal, );
+
+// Counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces Issued"), STAT_TraversalTracesIssued, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Checks Attempted"), STAT_TraversalChecksAttempted, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Actions Started"), STAT_TraversalActionsStarted, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched Checks"), STAT_TraversalBatchedChecks, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Net Plans Sent"), STAT_TraversalNetPlansSent, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Net Plan Bytes"), STAT_TraversalNetPlanBytes, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Look-Ahead Checks"), STAT_TraversalLookAheadChecks, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Armed Plans Committed"), STAT_TraversalArmedPlansCommitted, STATGROUP_Traversal, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Parallel Traces Wasted"), STAT_TraversalParallelTracesWasted, STATGROUP_Traversal, );
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(, Traversal);
+
+LLM_DECLARE_TAG(Traversal);
+
+// Cycle counter that also shows up as a named scope in Unreal Insights.
+#define TRAVERSAL_SCOPE_CYCLE_COUNTER(Stat) \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat); \
+	SCOPE_CYCLE_COUNTER(Stat)
+
+/**
+* Get the cycle stat of the trace issued by a check stage.
+*
+* @param Stage Stage that traces.
+* @return Stat of the stage.
+*/
+TStatId GetTraversalTraceStatId(ETraversalCheckStage Stage);
+
+/**
+* Count a trace issued by a check in the stat group and CSV profile.
+*/
+void CountTraversalTrace();
+
+/**
+* Count an action started by a character in the stat group and CSV profile.
+*/
+void CountTraversalActionStarted();
+
+/**
+* Count a traversal plan sent over the network in the stat group and CSV profile.
+*
+* @param NumBytes Size of the serialized plan, without RPC overhead.
+*/
+void CountTraversalNetPlan(int32 NumBytes);
@@ -0,0 +1,225 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#include "TraversalWorldSubsystem.h"
+#include "TraversalLedgeIndex.h"
+#include "TraversalStats.h"
+#include "TraversalGeometry.h"
+#include "Async/ParallelFor.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "SignificanceManager.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarUpdateSignificance(
+	TEXT("traversal.Significance.Update"),
+	true,
+	TEXT("Update the significance manager with the views of the local players every frame, which picks the LOD level of the traversal components. Disable if the game already updates it."));
+
+void UTraversalWorldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateSignificance();
+
+	if (PendingChecks.IsEmpty())
+		return;
+
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalCheckBatch);
+	LLM_SCOPE_BYTAG(Traversal);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Take the queue so components can queue new checks from the result callbacks
+	Swap(PendingChecks, BatchChecks);
+	PendingChecks.Reset();
+
+	// Resolve components on the game thread. Destroyed components drop out of the batch
+	BatchComponents.Reset();
+	for (const FPendingCheck& PendingCheck : BatchChecks)
+	{
+		BatchComponents.Add(PendingCheck.Component.Get());
+	}
+
+	FPhysicsCommand::ExecuteRead(GetWorld()->GetPhysicsScene(), [this]()
+	{
+		ParallelFor(BatchChecks.Num(), [this](int32 Index)
+		{
+			if (BatchComponents[Index])
+			{
+				BatchComponents[Index]->RunCheckThreadSafe(BatchChecks[Index].Check);
+			}
+		});
+	});
+
+	// Hand the results back on the game thread
+	for (int32 Index = 0; Index < BatchChecks.Num(); ++Index)
+	{
+		if (IsValid(BatchComponents[Index]))
+		{
+			BatchComponents[Index]->OnBatchedCheckCompleted(BatchChecks[Index].Check);
+		}
+	}
+
+	LastBatchSize = BatchChecks.Num();
+	LastBatchTime = static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	INC_DWORD_STAT_BY(STAT_TraversalBatchedChecks, LastBatchSize);
+	CSV_CUSTOM_STAT(Traversal, BatchedChecks, LastBatchSize, ECsvCustomStatOp::Accumulate);
+}
+
+void UTraversalWorldSubsystem::UpdateSignificance()
+{
+	if (!CVarUpdateSignificance.GetValueOnGameThread())
+		return;
+
+	USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld());
+	if (!SignificanceManager)
+		return;
+
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController || !PlayerController->IsLocalController())
+			continue;
+
+		FVector Location;
+		FRotator Rotation;
+		PlayerController->GetPlayerViewPoint(Location, Rotation);
+		Viewpoints.Emplace(Rotation, Location);
+	}
+
+	// Components keep their LOD level while there is no view
+	if (!Viewpoints.IsEmpty())
+	{
+		SignificanceManager->Update(Viewpoints);
+	}
+}
+
+TStatId UTraversalWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTraversalWorldSubsystem, STATGROUP_Tickables);
+}
+
+void UTraversalWorldSubsystem::EnqueueCheck(UTraversalComponent* Component, const FTraversalCheck& Check)
+{
+	LLM_SCOPE_BYTAG(Traversal);
+
+	FPendingCheck& PendingCheck = PendingChecks.AddDefaulted_GetRef();
+	PendingCheck.Component = Component;
+	PendingCheck.Check = Check;
+}
+
+void UTraversalWorldSubsystem::CancelChecks(const UTraversalComponent* Component)
+{
+	PendingChecks.RemoveAllSwap([Component](const FPendingCheck& PendingCheck)
+	{
+		return PendingCheck.Component.Get() == Component;
+	});
+}
+
+void UTraversalWorldSubsystem::RegisterLedgeIndex(ATraversalLedgeIndex* LedgeIndex)
+{
+	LLM_SCOPE_BYTAG(Traversal);
+
+	LedgeIndices.AddUnique(LedgeIndex);
+}
+
+void UTraversalWorldSubsystem::UnregisterLedgeIndex(ATraversalLedgeIndex* LedgeIndex)
+{
+	LedgeIndices.RemoveSwap(LedgeIndex);
+}
+
+bool UTraversalWorldSubsystem::FindLedge(const FVector& Origin, const FVector& Direction, float MaxDistance, float MinZ, float MaxZ, FTraversalLedge& OutLedge, float& OutDistance) const
+{
+	TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalLedgeLookup);
+
+	const FVector RayDelta = Direction.GetSafeNormal2D() * MaxDistance;
+	if (RayDelta.IsNearlyZero())
+		return false;
+
+	bool bFound = false;
+
+	for (const TWeakObjectPtr<ATraversalLedgeIndex>& WeakLedgeIndex : LedgeIndices)
+	{
+		const ATraversalLedgeIndex* LedgeIndex = WeakLedgeIndex.Get();
+		if (!LedgeIndex || !LedgeIndex->GetLedgeBounds().IsValid)
+			continue;
+
+		// Skip indices whose ledges are outside the height band
+		FBox Bounds = LedgeIndex->GetLedgeBounds().ExpandBy(1.0);
+		if (Bounds.Max.Z < MinZ || Bounds.Min.Z > MaxZ)
+			continue;
+
+		// Skip indices the ray doesn't pass over. Only X and Y are compared
+		Bounds.Min.Z = Origin.Z - 1.0;
+		Bounds.Max.Z = Origin.Z + 1.0;
+		if (!FMath::LineBoxIntersection(Bounds, Origin, Origin + RayDelta, RayDelta))
+			continue;
+
+		// Ledges along the borders of streamed cells can be in more than one index. Keep the closest
+		FTraversalLedge Ledge;
+		float Distance;
+		if (LedgeIndex->FindLedge(Origin, Direction, MaxDistance, MinZ, MaxZ, Ledge, Distance) && (!bFound || Distance < OutDistance))
+		{
+			OutLedge = Ledge;
+			OutDistance = Distance;
+			bFound = true;
+		}
+	}
+
+	return bFound;
+}
+
+bool UTraversalWorldSubsystem::HasLedgeNear(const FVector& Location, float Radius) const
+{
+	for (const TWeakObjectPtr<ATraversalLedgeIndex>& WeakLedgeIndex : LedgeIndices)
+	{
+		const ATraversalLedgeIndex* LedgeIndex = WeakLedgeIndex.Get();
+		if (!LedgeIndex || !LedgeIndex->GetLedgeBounds().IsValid || LedgeIndex->GetLedgeBounds().ComputeSquaredDistanceToPoint(Location) > FMath::Square(Radius))
+			continue;
+
+		if (LedgeIndex->HasLedgeNear(Location, Radius))
+			return true;
+	}
+
+	return false;
+}
+
+TSharedPtr<const FTraversalWallGraph> UTraversalWorldSubsystem::GetWallGraph(const UPrimitiveComponent* Primitive)
+{
+	if (!Primitive)
+		return nullptr;
+
+	LLM_SCOPE_BYTAG(Traversal);
+
+	if (!WallGraphs.Contains(Primitive))
+	{
+		// Drop the graphs of destroyed primitives before adding another
+		for (auto It = WallGraphs.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().ResolveObjectPtr())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	// A new graph is built once the primitive moves. Patches still holding the old one keep it alive until they are rebuilt
+	TSharedPtr<const FTraversalWallGraph>& WallGraph = WallGraphs.FindOrAdd(Primitive);
+	if (!WallGraph || !WallGraph->ComponentTransform.Equals(Primitive->GetComponentTransform()))
+	{
+		TRAVERSAL_SCOPE_CYCLE_COUNTER(STAT_TraversalWallGraphBuild);
+
+		TSharedPtr<FTraversalWallGraph> NewWallGraph = MakeShared<FTraversalWallGraph>();
+		NewWallGraph->Build(Primitive);
+		WallGraph = NewWallGraph;
+	}
+
+	return WallGraph;
+}
+
+bool UTraversalWorldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,26 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNotifies/AnimNotifyState.h"
+#include "AnimNotifyState_TraversalExitWindow.generated.h"
+
+/**
+* Window of a vault or mantle montage in which the action may end early. The action ends as soon as the character has movement input in the window, and at the end of the window otherwise.
+* The traversal component polls the input while the window is open. Simulated proxies end the action when the server does, or at the end of the window.
+* Montages without an exit window end AnimationEndBlendTime before the end of the montage.
+*/
+UCLASS(meta = (DisplayName = "Traversal Exit Window"))
+class TRAVERSALSYSTEM_API UAnimNotifyState_TraversalExitWindow : public UAnimNotifyState
+{
+	GENERATED_BODY()
+
+public:
+	// Blend out time in seconds of the montage when the action ends in the window.
+	UPROPERTY(EditAnywhere, Category = "Traversal", meta = (ClampMin = "0.0"))
+	float BlendOutTime = 0.2f;
+
+	virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference) override;
+	virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference) override;
+};
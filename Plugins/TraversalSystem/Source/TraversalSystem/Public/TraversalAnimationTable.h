@@ -0,0 +1,248 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "TraversalComponent.h"
+#include "TraversalAnimationTable.generated.h"
+
+/**
+* Conditions a vault or mantle animation is selected by.
+*/
+USTRUCT()
+struct FTraversalAnimationQuery
+{
+	GENERATED_BODY()
+
+	// Height of the ledge above the character.
+	float Height = 0.0f;
+
+	// Depth of the obstacle. 0 for mantles.
+	float Depth = 0.0f;
+
+	// Horizontal speed of the character.
+	float Speed = 0.0f;
+
+	// Angle in degrees between the character's forward vector and the direction into the obstacle's face. 0 is head-on.
+	float ApproachAngle = 0.0f;
+};
+
+/**
+* Vault or mantle animation and the conditions it is played in.
+*/
+USTRUCT()
+struct FTraversalAnimationEntry
+{
+	GENERATED_BODY()
+
+	// Animation and how it is played. Selected by ledge height using the min and max animation height.
+	UPROPERTY(EditAnywhere, meta = (ShowOnlyInnerProperties))
+	FAnimationPropertySettings Settings;
+
+	// Obstacle depth this animation is played for. Mantles always have a depth of 0.
+	UPROPERTY(EditAnywhere)
+	FFloatInterval Depth = FFloatInterval(0.0f, 1000.0f);
+
+	// Horizontal speed of the character this animation is played for.
+	UPROPERTY(EditAnywhere)
+	FFloatInterval Speed = FFloatInterval(0.0f, 2000.0f);
+
+	// Approach angle in degrees this animation is played for. 0 is head-on.
+	UPROPERTY(EditAnywhere, meta = (UIMin = "0.0", UIMax = "90.0"))
+	FFloatInterval ApproachAngle = FFloatInterval(0.0f, 90.0f);
+};
+
+/**
+* Motion warping window of a montage, baked with its root motion.
+*/
+struct FTraversalBakedWarpWindow
+{
+	// Warp target the root reaches at the end of the window.
+	FName WarpTargetName;
+
+	// Montage position the window starts at.
+	float StartTime = 0.0f;
+
+	// Montage position the window ends at.
+	float EndTime = 0.0f;
+
+	friend FArchive& operator<<(FArchive& Ar, FTraversalBakedWarpWindow& Window);
+};
+
+/**
+* Root motion of a vault or mantle montage sampled when the table is cooked for a platform, so the action can move the character without playing the montage.
+* The translation and yaw are those of the root relative to the start of the montage, in the space of the skeletal mesh component.
+*/
+struct FTraversalBakedRootMotion
+{
+	// Time in seconds between samples.
+	float SampleInterval = 0.0f;
+
+	// Translation of the root at each sample.
+	TArray<FVector3f> Translations;
+
+	// Yaw of the root in degrees at each sample. Unwound, so it doesn't wrap around between samples.
+	TArray<float> Yaws;
+
+	// Motion warping windows of the montage, sorted by end time.
+	TArray<FTraversalBakedWarpWindow> WarpWindows;
+
+	// Start of the montage's UAnimNotifyState_TraversalExitWindow. -1 if it has none.
+	float ExitWindowStartTime = -1.0f;
+
+	// End of the montage's UAnimNotifyState_TraversalExitWindow. -1 if it has none.
+	float ExitWindowEndTime = -1.0f;
+
+	// Length of the montage in seconds.
+	float PlayLength = 0.0f;
+
+	/**
+	* Whether root motion was baked.
+	*
+	* @return Has samples to follow.
+	*/
+	bool IsValid() const;
+
+	/**
+	* Interpolate the translation of the root.
+	*
+	* @param Time Montage position. Clamped to the length of the montage.
+	* @return Translation of the root relative to the start of the montage.
+	*/
+	FVector3f SampleTranslation(float Time) const;
+
+	/**
+	* Interpolate the yaw of the root.
+	*
+	* @param Time Montage position. Clamped to the length of the montage.
+	* @return Yaw of the root in degrees relative to the start of the montage.
+	*/
+	float SampleYaw(float Time) const;
+
+	friend FArchive& operator<<(FArchive& Ar, FTraversalBakedRootMotion& RootMotion);
+};
+
+/**
+* Vault or mantle animations of a character, selected by ledge height, obstacle depth, approach speed and approach angle.
+* The entries are compiled into a lookup sorted by height when the asset is saved or loaded. Selection is a binary search on height followed by a scan of the few entries that cover that height.
+* When the conditions of several entries match, the first entry in the list is played.
+* The root motion of every entry's montage is baked when the table is cooked, for dedicated servers and distant simulated proxies that move characters without playing the montages.
+*/
+UCLASS(BlueprintType)
+class TRAVERSALSYSTEM_API UTraversalAnimationTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Animations to select from. Earlier entries take priority over later ones.
+	UPROPERTY(EditAnywhere, Category = "Animations")
+	TArray<FTraversalAnimationEntry> Entries;
+
+protected:
+	// Heights splitting the height range of the entries into buckets, sorted in ascending order.
+	UPROPERTY()
+	TArray<float> HeightBounds;
+
+	// Index of each bucket's first entry index in BucketEntries. Has one more element than there are buckets.
+	UPROPERTY()
+	TArray<int32> BucketStarts;
+
+	// Indices of the entries that cover each bucket, in priority order.
+	UPROPERTY()
+	TArray<int32> BucketEntries;
+
+	// Min height, depth, speed and approach angle of each entry.
+	UPROPERTY()
+	TArray<FVector4f> EntryMins;
+
+	// Max height, depth, speed and approach angle of each entry.
+	UPROPERTY()
+	TArray<FVector4f> EntryMaxs;
+
+	// Root motion of each entry's montage. Only serialized in cooked packages, so it is empty in the editor and can't go stale there.
+	TArray<FTraversalBakedRootMotion> BakedRootMotion;
+
+public:
+	virtual void PostLoad() override;
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+	virtual void Serialize(FArchive& Ar) override;
+
+#if WITH_EDITOR
+	virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+
+	/**
+	* Sample the root motion, warp windows and exit window of every entry's montage. Loads the montages. Called before the table is cooked.
+	*/
+	void BakeRootMotion();
+#endif
+
+	/**
+	* Replace the entries with animations selected by height only, and compile them.
+	*
+	* @param Settings Property settings of each animation.
+	*/
+	void InitializeFromSettings(const TArray<FAnimationPropertySettings>& Settings);
+
+	/**
+	* Build the lookup from the entries. Entries without an animation are left out.
+	*/
+	void Compile();
+
+	/**
+	* Find the animation to play.
+	*
+	* @param Query Conditions of the action.
+	* @return Entry to play, or nullptr if no entry matches.
+	*/
+	const FTraversalAnimationEntry* FindEntry(const FTraversalAnimationQuery& Query) const;
+
+	/**
+	* Find the animation to play and adjust its starting position to the ledge height.
+	*
+	* @param Query Conditions of the action.
+	* @return Animation properties to be used for the action. The animation is nullptr if no entry matches.
+	*/
+	FAnimationProperties SelectAnimation(const FTraversalAnimationQuery& Query) const;
+
+	/**
+	* Get the animation of an entry and adjust its starting position to the ledge height. Used to reconstruct an animation selected on another machine.
+	*
+	* @param EntryIndex Index of the entry.
+	* @param Height Height of the ledge above the character.
+	* @return Animation properties to be used for the action. The animation is nullptr if the index is invalid.
+	*/
+	FAnimationProperties MakeAnimationProperties(int32 EntryIndex, float Height) const;
+
+	/**
+	* Get the baked root motion of an entry's montage.
+	*
+	* @param EntryIndex Index of the entry.
+	* @return Baked root motion, or nullptr if the index is invalid or the montage has no root motion or wasn't baked.
+	*/
+	const FTraversalBakedRootMotion* GetBakedRootMotion(int32 EntryIndex) const;
+
+	/**
+	* Whether the root motion of every entry with an animation was baked, so none of the montages need to be played.
+	*
+	* @return Every entry can be followed without its montage.
+	*/
+	bool HasBakedRootMotion() const;
+
+	/**
+	* Get the animations of all entries, to load them.
+	*
+	* @param OutPaths Paths of the animations. Paths that are already in the array aren't added again.
+	*/
+	void GetAnimations(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/**
+	* Find pairs of entries whose conditions overlap. The later entry of a pair is never played where they overlap.
+	* Ranges that only share an endpoint, like adjacent height bands, don't overlap.
+	*
+	* @param OutOverlaps Indices of the overlapping entries.
+	*/
+	void FindOverlaps(TArray<TPair<int32, int32>>& OutOverlaps) const;
+};
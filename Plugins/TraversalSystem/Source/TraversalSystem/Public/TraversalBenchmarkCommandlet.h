@@ -0,0 +1,267 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TraversalComponent.h"
+#include "TraversalBenchmarkCommandlet.generated.h"
+
+class ACharacter;
+class AStaticMeshActor;
+
+/**
+* Measures the cost of the traversal checks on a procedurally generated obstacle course, without rendering.
+* Spawns a grid of boxes, ledges, walls and ramps, places characters in front of random obstacles and times each check.
+* Reports per-check p50/p99 time, traces per check, success rate and allocations as CSV, or JSON if the output file ends with .json.
+* Fails if a check repeated from the same pose still allocates once its scratch buffers have grown.
+*
+* With -Fuzz, generates a single obstacle per case instead, with dimensions and an approach close to the thresholds of the character's tuning, and runs the vault, mantle and wall climb checks against it.
+* Whether each check should pass is computed from the obstacle's box rather than traced, and the report adds the false positives and false negatives of every check.
+* Cases within a small tolerance of a threshold are counted as ambiguous instead.
+*
+* Usage: UnrealEditor-Cmd <Project> -run=TraversalBenchmark -nullrhi [-Characters=8] [-Iterations=200] [-Grid=10] [-Seed=0] [-WarmCache] [-Character=<class path>] [-Output=<file>]
+*        UnrealEditor-Cmd <Project> -run=TraversalBenchmark -nullrhi -Fuzz [-Cases=2000] [-Seed=0] [-WarmCache] [-Character=<class path>] [-Output=<file>]
+*/
+UCLASS()
+class TRAVERSALSYSTEM_API UTraversalBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+protected:
+	// Kind of obstacle placed in a grid cell.
+	enum class EObstacleType : uint8
+	{
+		Box,
+		Ledge,
+		Wall,
+		Ramp
+	};
+
+	// Obstacle placed on the course.
+	struct FObstacle
+	{
+		EObstacleType Type = EObstacleType::Box;
+
+		// Center of the face characters approach, at floor height. For ramps, a point on the upper half of the ramp's surface.
+		FVector Front = FVector::ZeroVector;
+
+		// Direction characters approach the obstacle in. For ramps, the uphill direction.
+		FVector Facing = FVector::ForwardVector;
+	};
+
+	// Measurement of a single check.
+	struct FSample
+	{
+		double Time = 0.0;
+		int32 NumTraces = 0;
+		int64 NumAllocations = 0;
+		bool bSucceeded = false;
+	};
+
+	// All measurements of one kind of check.
+	struct FCheckResults
+	{
+		FString Name;
+		TArray<FSample> Samples;
+
+		// Checks that passed or failed although the obstacle says otherwise. Only counted by fuzz runs.
+		int32 NumFalsePositives = 0;
+		int32 NumFalseNegatives = 0;
+
+		// Checks whose obstacle is too close to a threshold to tell whether they should pass.
+		int32 NumAmbiguous = 0;
+	};
+
+	// Obstacle and approach of a fuzz case. The character stands at the origin facing along ApproachAngle, and the obstacle's face is at X = Distance, facing -X.
+	struct FFuzzCase
+	{
+		// Height of the obstacle before it is sloped.
+		float Height = 0.0f;
+
+		// Size of the obstacle along X.
+		float Depth = 0.0f;
+
+		// Size of the obstacle along Y.
+		float Width = 0.0f;
+
+		// Offset of the obstacle's center along Y.
+		float Lateral = 0.0f;
+
+		// Distance along X from the character's center to the obstacle's face.
+		float Distance = 0.0f;
+
+		// Yaw of the character in degrees. 0 faces the obstacle head-on.
+		float ApproachAngle = 0.0f;
+
+		// Roll of the obstacle in degrees, sloping its top sideways.
+		float Slope = 0.0f;
+
+		// Distance from the far side of the obstacle to a wall behind it. Negative if there is no wall.
+		float LandingRoom = -1.0f;
+	};
+
+	/**
+	* Whether a check should pass, found by testing each of its conditions against the obstacle.
+	*/
+	struct FFuzzTruth
+	{
+		bool bFails = false;
+		bool bAmbiguous = false;
+
+		/**
+		* Add a condition of the check.
+		*
+		* @param Margin How far the obstacle is on the passing side of the condition's threshold. Negative if it is on the failing side.
+		* @param Tolerance Margin below which the condition is ambiguous.
+		*/
+		void Require(double Margin, double Tolerance)
+		{
+			bFails |= Margin <= -Tolerance;
+			bAmbiguous |= Margin > -Tolerance && Margin < Tolerance;
+		}
+
+		/**
+		* Add a condition of the check that is tested with a tolerance on either side.
+		*
+		* @param bPassesStrict Condition is met with the tolerance against it.
+		* @param bPassesLoose Condition is met with the tolerance in its favor.
+		*/
+		void RequireTest(bool bPassesStrict, bool bPassesLoose)
+		{
+			bFails |= !bPassesLoose;
+			bAmbiguous |= bPassesLoose && !bPassesStrict;
+		}
+
+		// A condition that clearly fails decides the outcome, even if others are ambiguous.
+		bool IsAmbiguous() const { return bAmbiguous && !bFails; }
+		bool ShouldPass() const { return !bFails && !bAmbiguous; }
+	};
+
+public:
+	UTraversalBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	/**
+	* Spawn the floor and a grid of obstacles with random dimensions.
+	*
+	* @param World World to spawn the course in.
+	* @param Random Random stream used to pick the obstacles.
+	* @param GridSize Number of cells along each side of the grid.
+	* @param OutObstacles Obstacles that were spawned.
+	*/
+	void SpawnCourse(UWorld* World, FRandomStream& Random, int32 GridSize, TArray<FObstacle>& OutObstacles) const;
+
+	/**
+	* Spawn a box from the 100 unit engine cube.
+	*
+	* @param World World to spawn the box in.
+	* @param Center Center of the box.
+	* @param Rotation Rotation of the box.
+	* @param Size Size of the box along each of its axes.
+	* @return The box.
+	*/
+	AStaticMeshActor* SpawnBox(UWorld* World, const FVector& Center, const FRotator& Rotation, const FVector& Size) const;
+
+	/**
+	* Move a box spawned by SpawnBox.
+	*
+	* @param Box Box to move.
+	* @param Center Center of the box.
+	* @param Rotation Rotation of the box.
+	* @param Size Size of the box along each of its axes.
+	*/
+	void MoveBox(AStaticMeshActor* Box, const FVector& Center, const FRotator& Rotation, const FVector& Size) const;
+
+	/**
+	* Place a character walking at max speed, with its last movement input along its facing.
+	*
+	* @param Character Character to place.
+	* @param Location Location of the character's capsule.
+	* @param Facing Direction the character faces and moves in.
+	*/
+	void PrepareCharacter(ACharacter* Character, const FVector& Location, const FVector& Facing) const;
+
+	/**
+	* Place a character in front of an obstacle, moving towards it.
+	*
+	* @param Character Character to place.
+	* @param Obstacle Obstacle to approach.
+	* @param Random Random stream used to vary the distance and approach angle.
+	*/
+	void PlaceCharacter(ACharacter* Character, const FObstacle& Obstacle, FRandomStream& Random) const;
+
+	/**
+	* Run a vault, mantle, unified or wall climb check without starting the action.
+	*
+	* @param TraversalComponent Component to run the check on.
+	* @param Action Action to check. None runs the unified vault and mantle check.
+	* @return Measurement of the check.
+	*/
+	FSample MeasureCheck(UTraversalComponent* TraversalComponent, ETraversalState Action) const;
+
+	/**
+	* Run every check twice in a row from the same pose and count the allocations of the second run.
+	* The first run grows the scratch buffers, so a steady-state check is expected not to allocate at all.
+	*
+	* @param TraversalComponent Component to run the checks on, placed in front of an obstacle.
+	* @return No check allocated on its second run.
+	*/
+	bool CheckSteadyStateAllocations(UTraversalComponent* TraversalComponent) const;
+
+	/**
+	* Start a slide and run one slide update.
+	* With the traversal movement component, the slide moves in its PhysSlide, which is what is measured. Otherwise the component's SlideUpdate is measured.
+	*
+	* @param TraversalComponent Component to slide with.
+	* @return Measurement of the update. Succeeded if the character is still sliding after it.
+	*/
+	FSample MeasureSlideUpdate(UTraversalComponent* TraversalComponent) const;
+
+	/**
+	* Generate obstacles close to the thresholds of a character's tuning, run the vault, mantle and wall climb checks against each and compare them with the obstacle.
+	*
+	* @param World World to spawn the floor and obstacles in.
+	* @param TraversalComponent Component to run the checks on.
+	* @param Random Random stream used to generate the cases.
+	* @param NumCases Number of cases generated for each check.
+	* @param OutResults Results of the vault, mantle and wall climb checks.
+	*/
+	void RunFuzz(UWorld* World, UTraversalComponent* TraversalComponent, FRandomStream& Random, int32 NumCases, TArray<FCheckResults>& OutResults) const;
+
+	/**
+	* Generate a case for a check, with dimensions spread around the thresholds that decide it.
+	*
+	* @param TraversalComponent Component whose tuning the thresholds are read from.
+	* @param Action Vaulting, Mantling or WallClimbing.
+	* @param Random Random stream used to generate the case.
+	* @return The case.
+	*/
+	FFuzzCase MakeFuzzCase(const UTraversalComponent* TraversalComponent, ETraversalState Action, FRandomStream& Random) const;
+
+	/**
+	* Find whether a check should pass against the obstacle of a fuzz case.
+	*
+	* @param TraversalComponent Component the check runs on, placed for the case.
+	* @param Action Vaulting, Mantling or WallClimbing.
+	* @param Case Case the obstacle was built from.
+	* @param Obstacle Transform of the obstacle box, including its size as scale.
+	* @param Surroundings Transforms of the other boxes: the floor, and the wall behind the obstacle if the case has one.
+	* @return Whether the check should pass.
+	*/
+	FFuzzTruth EvaluateFuzzCase(const UTraversalComponent* TraversalComponent, ETraversalState Action, const FFuzzCase& Case, const FTransform& Obstacle, TConstArrayView<FTransform> Surroundings) const;
+
+	/**
+	* Write the results to a CSV or JSON file and log a summary.
+	*
+	* @param Path File to write.
+	* @param Results Results of every kind of check.
+	* @return File was written.
+	*/
+	bool WriteReport(const FString& Path, const TArray<FCheckResults>& Results) const;
+
+	// Whether the check cache is kept between samples. Cold checks are measured by default.
+	bool bWarmCache = false;
+};
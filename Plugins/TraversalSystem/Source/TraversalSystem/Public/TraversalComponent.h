@@ -4,11 +4,25 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "CollisionShape.h"
+#include "WorldCollision.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/NetSerialization.h"
 #include "TraversalComponent.generated.h"
 
 class UCharacterMovementComponent;
 class UCapsuleComponent;
 class UAnimMontage;
+class UPrimitiveComponent;
+class UTraversalAnimationTable;
+class UTraversalConfig;
+class UTraversalMovementComponent;
+class UAnimSequenceBase;
+struct FStreamableHandle;
+class FTraversalWallGraph;
+struct FTraversalCheckCapture;
+struct FTraversalCaptureStep;
+struct FTraversalBakedRootMotion;
 
 UENUM(BlueprintType)
 enum class ETraversalState : uint8
@@ -20,32 +34,114 @@ enum class ETraversalState : uint8
 	WallClimbing	UMETA(DisplayName = "WallClimbing")
 };
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTraversalAsyncCheckCompleted, ETraversalState, Action, bool, bStarted);
+
+UENUM()
+enum class ETraversalTraceShape : uint8
+{
+	Line,
+	Sphere,
+	Capsule
+};
+
+/**
+* Stages a traversal check moves through. Every stage except the final ones issues exactly one trace.
+*/
+UENUM()
+enum class ETraversalCheckStage : uint8
+{
+	ObjectClimbable,
+	SurfaceWalkable,
+	VaultReach,
+	VaultDepth,
+	VaultRoom,
+	VaultLand,
+	CapsulePath,
+	WallForward,
+	WallRoomTop,
+	WallRoomBottom,
+	WallRoomRight,
+	WallRoomLeft,
+	Succeeded,
+	Failed
+};
+
+/**
+* Snapshot of the owning character taken when a check begins. All traces of a check are built from the same pose, even if they are resolved over several frames.
+*/
 USTRUCT()
-struct FIsObjectClimbableOut
+struct FTraversalPose
 {
 	GENERATED_BODY()
 
-	bool bIsNotWalkable = false;
-	FVector InitialImpactPoint = FVector::ZeroVector;
-	FVector InitialImpactNormal = FVector::ZeroVector;
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FVector ForwardVector = FVector::ForwardVector;
+	FVector RightVector = FVector::RightVector;
+	FVector UpVector = FVector::UpVector;
+	FVector MovementInput = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	FVector CapsuleBaseLocation = FVector::ZeroVector;
+	float CapsuleRadius = 0.0f;
+	float CapsuleHalfHeight = 0.0f;
 };
 
+/**
+* Single trace issued by a check stage.
+*/
 USTRUCT()
-struct FIsSurfaceWalkableOut
+struct FTraversalTraceQuery
 {
 	GENERATED_BODY()
 
-	bool bIsWalkable = false;
-	FVector WalkableImpactPoint = FVector::ZeroVector;
+	ETraversalTraceShape Shape = ETraversalTraceShape::Line;
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+
+	FCollisionShape GetCollisionShape() const
+	{
+		switch (Shape)
+		{
+		case ETraversalTraceShape::Sphere:
+			return FCollisionShape::MakeSphere(Radius);
+		case ETraversalTraceShape::Capsule:
+			return FCollisionShape::MakeCapsule(Radius, HalfHeight);
+		default:
+			return FCollisionShape();
+		}
+	}
 };
 
+/**
+* Everything the component's traces need that stays the same between traces. Built once in Initialize so a trace doesn't convert the trace channel, rebuild its query params or copy an ignore list.
+* Tracing through the context doesn't allocate and can be done from worker threads.
+*/
 USTRUCT()
-struct FCanVaultOverDepthOut
+struct FTraversalTraceContext
 {
 	GENERATED_BODY()
 
-	bool bCanVaultOverDepth = false;
-	FVector DepthImpactPoint = FVector::ZeroVector;
+	// World to trace in. Outlives the component, so it isn't tracked by the garbage collector.
+	UWorld* World = nullptr;
+
+	// Collision channel converted from the detection trace channel.
+	ECollisionChannel Channel = ECC_Visibility;
+
+	// Query params shared by all traces. The owning character is ignored.
+	FCollisionQueryParams QueryParams;
+
+	bool IsValid() const { return World != nullptr; }
+
+	/**
+	* Run a blocking trace.
+	*
+	* @param Query Trace to run.
+	* @param OutHit Hit result of the trace.
+	* @return Blocking hit found.
+	*/
+	bool TraceSingle(const FTraversalTraceQuery& Query, FHitResult& OutHit) const;
 };
 
 USTRUCT()
@@ -54,13 +150,343 @@ struct FAnimationProperties
 	GENERATED_BODY()
 
 	UPROPERTY()
-	UAnimMontage* Animation = nullptr;
+	TSoftObjectPtr<UAnimMontage> Animation;
+
+	// Index of the animation table entry the animation was selected from.
+	int32 EntryIndex = INDEX_NONE;
 
 	float AnimationHeightOffset = 0.0f;
 	double AnimationStartingPosition = 0.0;
 	float AnimationEndBlendTime = 0.0f;
 };
 
+/**
+* Movement settings of the owning character that the actions override, restored when they end.
+*/
+struct FTraversalMovementDefaults
+{
+	float GroundFriction = 0.0f;
+	float BrakingDeceleration = 0.0f;
+};
+
+/**
+* Settings of a traversal LOD level. Level 0 is used for the most significant characters.
+*/
+USTRUCT()
+struct FTraversalLODSettings
+{
+	GENERATED_BODY()
+
+	// Min distance from the closest viewer at which this level is used. Ignored for level 0.
+	UPROPERTY(EditAnywhere)
+	float MinDistance = 0.0f;
+
+	// Interval in seconds between look-ahead checks. The component's LookAheadInterval is used if it is longer.
+	// The component still ticks every frame, since slides, baked actions and exit windows are updated from its tick.
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"))
+	float LookAheadInterval = 0.0f;
+
+	// Multiplier applied to the check cache tolerances and lifetime. Larger values let more checks reuse a cached result.
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1.0"))
+	float CheckCacheToleranceScale = 1.0f;
+
+	// Skip the capsule sweep along the vault/mantle path.
+	UPROPERTY(EditAnywhere)
+	bool bSkipCapsulePathCheck = false;
+
+	// Move simulated proxies along the baked root motion of their vaults and mantles instead of playing the montages. Their meshes don't animate during the action.
+	UPROPERTY(EditAnywhere)
+	bool bUseBakedRootMotion = false;
+};
+
+/**
+* Flat face of a wall's simple box collision. While the character is on the face away from its edges, the wall normal is known without tracing.
+* Near its left and right edges, the corners to turn around are looked up in the wall graph of the component.
+*/
+USTRUCT()
+struct FTraversalWallPatch
+{
+	GENERATED_BODY()
+
+	// Component the face belongs to.
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	// Transform of Component when the face was extracted. The face is discarded once the component moves.
+	FTransform ComponentTransform;
+
+	// Center of the face.
+	FVector Center = FVector::ZeroVector;
+
+	// Normal of the face, pointing away from the wall.
+	FVector Normal = FVector::ForwardVector;
+
+	// Axis of the face closest to horizontal.
+	FVector TangentAxis = FVector::RightVector;
+
+	// Axis of the face closest to vertical.
+	FVector UpAxis = FVector::UpVector;
+
+	double HalfWidth = 0.0;
+	double HalfHeight = 0.0;
+
+	// Graph of the faces of Component. Only resolved on the game thread, the first time the patch is looked up for a corner.
+	TSharedPtr<const FTraversalWallGraph> Graph;
+
+	// Index of the face in Graph.
+	int32 GraphFace = INDEX_NONE;
+
+	/**
+	* Extract the face of the hit primitive's box collision that contains the hit. Convex elements are used if they are boxes.
+	*
+	* @param Hit Hit on the wall.
+	* @return A face was found. The patch is reset otherwise.
+	*/
+	bool Build(const FHitResult& Hit);
+
+	/**
+	* Whether a location is in front of the face, away from its edges, and the component hasn't moved.
+	*
+	* @param Location Location to test.
+	* @param EdgeMargin Min distance from the edges of the face.
+	* @param MaxDistance Max distance from the face.
+	* @return Location is on the patch.
+	*/
+	bool Contains(const FVector& Location, double EdgeMargin, double MaxDistance) const;
+
+	bool IsValid() const { return Component.IsValid(); }
+
+	void Reset()
+	{
+		Component.Reset();
+		Graph.Reset();
+		GraphFace = INDEX_NONE;
+	}
+};
+
+/**
+* Everything needed to start a traversal action once its check has passed.
+*/
+USTRUCT()
+struct FTraversalPlan
+{
+	GENERATED_BODY()
+
+	ETraversalState Action = ETraversalState::None;
+	FVector ObjectStartWarpTarget = FVector::ZeroVector;
+	FVector ObjectEndWarpTarget = FVector::ZeroVector;
+	FVector LandWarpTarget = FVector::ZeroVector;
+	float Height = 0.0f;
+
+	// Depth of the obstacle. Only set for vaults.
+	float Depth = 0.0f;
+
+	// Angle in degrees between the character's forward vector and the direction into the obstacle's face. 0 is head-on.
+	float ApproachAngle = 0.0f;
+
+	UPROPERTY()
+	FAnimationProperties AnimationProperties;
+
+	// Hit result of the forward wall trace. Only used by wall climbing.
+	FHitResult WallHit;
+
+	// Face of the wall that was hit, if it has box collision. Only used by wall climbing.
+	FTraversalWallPatch WallPatch;
+};
+
+/**
+* Vault or mantle plan sent over the network once, when the action starts. Simulated proxies play the motion warped montage from it locally.
+* Warp targets are quantized to 1 cm and the vault targets are sent relative to the object start, so a vault plan is about 20 bytes.
+* The size of each plan sent is counted by the Net Plan Bytes stat and CSV stat. To measure it, run a listen server and clients with -nullrhi and use stat Traversal or -csvCapture.
+*/
+USTRUCT()
+struct FTraversalNetPlan
+{
+	GENERATED_BODY()
+
+	// Vaulting or Mantling.
+	ETraversalState Action = ETraversalState::None;
+
+	// Index of the animation table entry to play.
+	int32 EntryIndex = INDEX_NONE;
+
+	// Server world time at which the action started.
+	float StartServerTime = 0.0f;
+
+	// Height of the ledge above the character, quantized to 1 cm.
+	float Height = 0.0f;
+
+	FVector ObjectStartWarpTarget = FVector::ZeroVector;
+
+	// Only sent for vaults.
+	FVector ObjectEndWarpTarget = FVector::ZeroVector;
+
+	// Only sent for vaults.
+	FVector LandWarpTarget = FVector::ZeroVector;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FTraversalNetPlan> : public TStructOpsTypeTraitsBase2<FTraversalNetPlan>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+* Ledge baked from static level collision by ATraversalLedgeIndex. The ledge is the top edge of an obstacle's face that can be vaulted or mantled over.
+*/
+USTRUCT()
+struct FTraversalLedge
+{
+	GENERATED_BODY()
+
+	// Start of the edge on top of the obstacle.
+	UPROPERTY()
+	FVector Start = FVector::ZeroVector;
+
+	// End of the edge on top of the obstacle.
+	UPROPERTY()
+	FVector End = FVector::ZeroVector;
+
+	// Horizontal normal of the face below the edge, pointing away from the obstacle.
+	UPROPERTY()
+	FVector3f Normal = FVector3f::ForwardVector;
+
+	// Depth of the obstacle's top surface, measured along the normal.
+	UPROPERTY()
+	float Depth = 0.0f;
+
+	// Height of the edge above the ground in front of the face.
+	UPROPERTY()
+	float Height = 0.0f;
+
+	// Z of the ground behind the obstacle. Only valid if bHasLandingRoom is set.
+	UPROPERTY()
+	float LandZ = 0.0f;
+
+	// Whether ground was found behind the obstacle and there is room for a capsule on it.
+	UPROPERTY()
+	bool bHasLandingRoom = false;
+
+	FVector GetCenter() const { return (Start + End) * 0.5; }
+};
+
+/**
+* In-flight state of a traversal check.
+*/
+USTRUCT()
+struct FTraversalCheck
+{
+	GENERATED_BODY()
+
+	ETraversalState Action = ETraversalState::None;
+	ETraversalCheckStage Stage = ETraversalCheckStage::Failed;
+	FTraversalPose Pose;
+	FTraversalPlan Plan;
+	FVector InitialImpactPoint = FVector::ZeroVector;
+	FVector InitialImpactNormal = FVector::ZeroVector;
+	FVector ReachImpactPoint = FVector::ZeroVector;
+
+	// Component hit by the first trace of the check. Used to key the check cache.
+	TWeakObjectPtr<UPrimitiveComponent> Obstacle;
+
+	// Transform of Obstacle when it was hit.
+	FTransform ObstacleTransform;
+
+	// Vault and mantle are evaluated together and Action is only picked once the ledge height is known.
+	bool bIsUnified = false;
+
+	// Whether a unified check can still vault.
+	bool bCanVault = false;
+
+	// Whether a unified check can still mantle.
+	bool bCanMantle = false;
+
+	// Baked ledge found by the first stage. The vault and mantle stages are resolved from it instead of tracing.
+	FTraversalLedge Ledge;
+
+	// Whether Ledge is set.
+	bool bUsesBakedLedge = false;
+
+	// Whether Ledge was computed from the box collision of the obstacle hit by the first stage. It has no landing, so the room and land stages are traced.
+	bool bUsesCollisionLedge = false;
+
+	// Number of traces issued for the check so far.
+	int32 NumTraces = 0;
+
+	// Whether the check runs ahead of the character to arm a plan. Its result is never committed directly.
+	bool bIsLookAhead = false;
+
+	// Pose, tuning and hits of the check, written to the capture file once the check finishes. Only set while traversal.Capture.Start is running.
+	TSharedPtr<FTraversalCheckCapture> Capture;
+
+	bool IsFinished() const { return Stage == ETraversalCheckStage::Succeeded || Stage == ETraversalCheckStage::Failed; }
+};
+
+/**
+* Pose of the owning character relative to an obstacle, quantized so that nearly identical checks share a key.
+*/
+USTRUCT()
+struct FTraversalCheckCacheKey
+{
+	GENERATED_BODY()
+
+	// Action that was checked. None for unified vault and mantle checks.
+	ETraversalState Action = ETraversalState::None;
+	FIntVector Location = FIntVector::ZeroValue;
+	int32 Yaw = 0;
+	int32 InputYaw = 0;
+	int32 CapsuleHalfHeight = 0;
+	bool bHasInput = false;
+	bool bIsFalling = false;
+
+	bool operator==(const FTraversalCheckCacheKey& Other) const
+	{
+		return Action == Other.Action && Location == Other.Location && Yaw == Other.Yaw && InputYaw == Other.InputYaw
+			&& CapsuleHalfHeight == Other.CapsuleHalfHeight && bHasInput == Other.bHasInput && bIsFalling == Other.bIsFalling;
+	}
+};
+
+/**
+* Result of a finished check against a specific obstacle. Both successful plans and rejections are stored.
+*/
+USTRUCT()
+struct FTraversalCheckCacheEntry
+{
+	GENERATED_BODY()
+
+	TWeakObjectPtr<UPrimitiveComponent> Obstacle;
+	FTransform ObstacleTransform;
+	FTraversalCheckCacheKey Key;
+	double Time = 0.0;
+	bool bSucceeded = false;
+	ETraversalState Action = ETraversalState::None;
+	FTraversalPlan Plan;
+};
+
+/**
+* Plan found by a look-ahead check, ready to be committed without tracing while the character stays close to the pose it was checked from.
+*/
+USTRUCT()
+struct FTraversalArmedPlan
+{
+	GENERATED_BODY()
+
+	FTraversalPlan Plan;
+
+	// Pose the plan was checked from, predicted along the character's velocity.
+	FTraversalPose Pose;
+
+	TWeakObjectPtr<UPrimitiveComponent> Obstacle;
+	FTransform ObstacleTransform;
+
+	// World time the plan was armed at.
+	double Time = 0.0;
+};
+
 /**
 * Animation properties that are used to adjust animation to conditions. Can be used to play different vault animation for different heights.
 */
@@ -69,9 +495,9 @@ struct FAnimationPropertySettings
 {
 	GENERATED_BODY()
 
-	// Animation to be played.
+	// Animation to be played. Loaded by the traversal component when the action may be needed.
 	UPROPERTY(EditAnywhere)
-	UAnimMontage* Animation = nullptr;
+	TSoftObjectPtr<UAnimMontage> Animation;
 
 	// Min height at which this animation should be played.
 	UPROPERTY(EditAnywhere)
@@ -106,11 +532,70 @@ struct FAnimationPropertySettings
 	float AnimationEndBlendTime = 0.0f;
 };
 
+/**
+* Vault or mantle in progress. Ends when its montage blends out, reaches its exit window or reaches ExitPosition.
+* Actions following baked root motion don't play their montage. They advance Position themselves and end the same way.
+*/
+USTRUCT()
+struct FTraversalActiveAction
+{
+	GENERATED_BODY()
+
+	ETraversalState Action = ETraversalState::None;
+
+	UPROPERTY()
+	TObjectPtr<UAnimMontage> Montage;
+
+	// Instance of the montage played for the action. Montage events of any other instance are stale and ignored.
+	int32 MontageInstanceID = INDEX_NONE;
+
+	// Montage position at which the action ends if the montage has no exit window.
+	float ExitPosition = 0.0f;
+
+	// Whether the montage has a UAnimNotifyState_TraversalExitWindow that ends the action.
+	bool bHasExitWindow = false;
+
+	// Whether the montage is inside its exit window, where movement input ends the action.
+	bool bInExitWindow = false;
+
+	// Blend out time in seconds of the montage when the action ends in its exit window.
+	float ExitWindowBlendOutTime = 0.0f;
+
+	// Baked root motion the character follows instead of playing the montage. Owned by the animation table of the config.
+	const FTraversalBakedRootMotion* BakedRootMotion = nullptr;
+
+	// Montage position the baked root motion was started at.
+	float StartPosition = 0.0f;
+
+	// Montage position the baked root motion has been followed to.
+	float Position = 0.0f;
+
+	// Maps the baked root translation to the world location of the root, as it was when the action started.
+	FTransform RootMotionToWorld;
+
+	// Rotation of the character when the action started.
+	FQuat StartRotation = FQuat::Identity;
+
+	// Offset each warp window of the baked root motion adds to the root by the end of the window, so the root reaches the window's warp target.
+	TArray<FVector, TInlineAllocator<4>> WarpCorrections;
+
+	// Whether the movement component moves the character along the baked root motion. Otherwise the traversal component moves it when it ticks.
+	bool bMovedByMovementComponent = false;
+
+	// Whether the mesh was ticking before the action stopped it.
+	bool bMeshTickWasEnabled = false;
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class TRAVERSALSYSTEM_API UTraversalComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
+	friend class UTraversalWorldSubsystem;
+	friend class UTraversalBenchmarkCommandlet;
+	friend class UTraversalReplayCommandlet;
+	friend class UTraversalMovementComponent;
+
 protected:
 	// Owning character reference.
 	UPROPERTY()
@@ -120,6 +605,10 @@ protected:
 	UPROPERTY()
 	UCharacterMovementComponent* PlayerCharacterMovement;
 
+	// Owning character movement component if it is a traversal movement component, which runs the actions as predicted movement modes.
+	UPROPERTY()
+	TObjectPtr<UTraversalMovementComponent> TraversalMovement;
+
 	// Owning character capsule component reference.
 	UPROPERTY()
 	UCapsuleComponent* PlayerCapsule;
@@ -132,14 +621,11 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Traversal")
 	TEnumAsByte<ETraceTypeQuery> DetectionTraceChannel;
 
-	// Default owning character gravity.
-	float DefaultGravity;
+	// Channel and query params used by every trace of the component.
+	FTraversalTraceContext TraceContext;
 
-	// Default owning character ground friction.
-	float DefaultGroundFriction;
-
-	// Default owning character braking deceleration.
-	float DefaultBrakingDeceleration;
+	// Movement settings of the owning character before any action changed them.
+	FTraversalMovementDefaults MovementDefaults;
 
 	// Warp target placed at the start of the object.
 	FVector ObjectStartWarpTarget;
@@ -152,310 +638,746 @@ protected:
 
 
 
-	// Z offset added to the capsule's starting position. Used for fine tuning when taking the height of the capsule component into account.
-	UPROPERTY(EditAnywhere, Category = "General")
-	float GlobalHeightOffsetZ;
+	// Tuning of the actions. Shared by every component of the same archetype and never changed at runtime.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Traversal")
+	TObjectPtr<UTraversalConfig> Config;
 
+	// Calculated height of the object to vault over. Will only be set after an attemp to vault.
+	UPROPERTY(BlueprintReadOnly, Category = "Vault")
+	float VaultHeight;
 
+	// Calculated height of the object to mantle on. Will only be set after an attempt to mantle.
+	UPROPERTY(BlueprintReadOnly, Category = "Mantle")
+	float MantleHeight;
 
-	// Max distance to object to initiate vault.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	float VaultReachDistance;
+#if WITH_EDITORONLY_DATA
+	// Tuning saved on the component before it moved into the config. Moved into a config by PostLoad.
+	UPROPERTY()
+	float GlobalHeightOffsetZ_DEPRECATED;
+	UPROPERTY()
+	float VaultReachDistance_DEPRECATED;
+	UPROPERTY()
+	float VaultMinLedgeHeight_DEPRECATED;
+	UPROPERTY()
+	float VaultMaxLedgeHeight_DEPRECATED;
+	UPROPERTY()
+	float VaultMinDepth_DEPRECATED;
+	UPROPERTY()
+	float VaultMaxDepth_DEPRECATED;
+	UPROPERTY()
+	int32 VaultMaxApproachAngle_DEPRECATED;
+	UPROPERTY()
+	float VaultLandDistance_DEPRECATED;
+	UPROPERTY()
+	float VaultMaxLandVerticalDistance_DEPRECATED;
+	UPROPERTY()
+	TObjectPtr<UTraversalAnimationTable> VaultAnimationTable_DEPRECATED;
+	UPROPERTY()
+	TArray<FAnimationPropertySettings> VaultAnimationPropertySettings_DEPRECATED;
+	UPROPERTY()
+	FName VaultObjectStartWarpTargetName_DEPRECATED;
+	UPROPERTY()
+	FName VaultObjectEndWarpTargetName_DEPRECATED;
+	UPROPERTY()
+	FName VaultLandWarpTargetName_DEPRECATED;
+	UPROPERTY()
+	float MantleReachDistance_DEPRECATED;
+	UPROPERTY()
+	float MantleMinLedgeHeight_DEPRECATED;
+	UPROPERTY()
+	float MantleMaxLedgeHeight_DEPRECATED;
+	UPROPERTY()
+	TObjectPtr<UTraversalAnimationTable> MantleAnimationTable_DEPRECATED;
+	UPROPERTY()
+	TArray<FAnimationPropertySettings> MantleAnimationPropertySettings_DEPRECATED;
+	UPROPERTY()
+	FName MantleWarpTargetName_DEPRECATED;
+	UPROPERTY()
+	float SlidePower_DEPRECATED;
+	UPROPERTY()
+	float SlideFloorMultiplier_DEPRECATED;
+	UPROPERTY()
+	float SlideGroundFriction_DEPRECATED;
+	UPROPERTY()
+	float SlideBrakingPower_DEPRECATED;
+	UPROPERTY()
+	float SlideMinSpeed_DEPRECATED;
+	UPROPERTY()
+	float SlideMaxSpeed_DEPRECATED;
+	UPROPERTY()
+	float SlideSubstepTime_DEPRECATED = 1.0f / 240.0f;
+	UPROPERTY()
+	int32 SlideMaxSubsteps_DEPRECATED = 32;
+	UPROPERTY()
+	float WallDetectionDistance_DEPRECATED;
+	UPROPERTY()
+	float WallClimbSpeed_DEPRECATED;
+	UPROPERTY()
+	float WallClimbBrakingDeceleration_DEPRECATED = 2048.0f;
+	UPROPERTY()
+	float InwardTurnDetectionDistance_DEPRECATED;
+	UPROPERTY()
+	float MaxInwardTurnAngle_DEPRECATED;
+	UPROPERTY()
+	TSoftObjectPtr<UAnimMontage> LeftInwardTurnAnimation_DEPRECATED;
+	UPROPERTY()
+	TSoftObjectPtr<UAnimMontage> RightInwardTurnAnimation_DEPRECATED;
+	UPROPERTY()
+	float DirectionalTraceDistance_DEPRECATED;
+	UPROPERTY()
+	float OutwardTurnDetectionDistance_DEPRECATED;
+	UPROPERTY()
+	float MaxOutwardTurnAngle_DEPRECATED;
+	UPROPERTY()
+	TSoftObjectPtr<UAnimMontage> LeftOutwardTurnAnimation_DEPRECATED;
+	UPROPERTY()
+	TSoftObjectPtr<UAnimMontage> RightOutwardTurnAnimation_DEPRECATED;
+#endif
+
+	UPROPERTY(BlueprintReadOnly, Category = "Wall Climb")
+	float WallClimbHorizontalInput;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Wall Climb")
+	float WallClimbVerticalInput;
 
-	// Min ledge height that can be vaulted over.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	float VaultMinLedgeHeight;
+	bool bWallClimbIsTurning = false;
 
-	// Max ledge height that can be vaulted over.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	float VaultMaxLedgeHeight;
+	// Instance of the turn montage being played.
+	int32 WallClimbTurnMontageInstanceID = INDEX_NONE;
 
-	// Min obstacle depth that can be vaulted over.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	float VaultMinDepth;
+	// Face of the wall being climbed. The wall is only traced again near its edges or once it moves.
+	FTraversalWallPatch WallPatch;
 
-	// Max obstacle depth that can be vaulted over.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	float VaultMaxDepth;
 
-	// Max angle between the owning character's forward vector and obstacle's normal that allows vaulting.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	int32 VaultMaxApproachAngle;
 
-	// Distance behind obstacle that will be landed at.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	float VaultLandDistance;
+	// Blend out time in seconds of a vault or mantle montage when the action ends before the montage does.
+	UPROPERTY(EditAnywhere, Category = "Traversal", meta = (ClampMin = "0.0"))
+	float ActionBlendOutTime = 0.2f;
 
-	// Distance that will detect the ground behind the obstacle.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	float VaultMaxLandVerticalDistance;
+	// Vault or mantle in progress.
+	UPROPERTY()
+	FTraversalActiveAction ActiveAction;
 
-	// Animation properties that are used to adjust animation to conditions. Can be used to play different vault animation for different heights.
-	UPROPERTY(EditAnywhere, Category = "Vault|Animations")
-	TArray<FAnimationPropertySettings> VaultAnimationPropertySettings;
+	// Whether vaults and mantles are replicated as a single plan that simulated proxies play locally. Movement replication of the character is paused on the server while the action plays.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Replication")
+	bool bReplicatePlans = true;
 
-	// Warp target name specified in the vault montage.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	FName VaultObjectStartWarpTargetName;
+	// Max distance from the character to the object start of a plan sent by its owning client. Plans farther away are rejected by the server.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Replication", meta = (EditCondition = "bReplicatePlans", ClampMin = "0.0"))
+	float NetPlanMaxDistance = 300.0f;
 
-	// Warp target name specified in the vault montage.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	FName VaultObjectEndWarpTargetName;
+	// Distance by which the height and warp targets of a plan sent by the owning client may exceed the limits of the config. Covers quantization and the movement of the client since the plan was made.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Replication", meta = (EditCondition = "bReplicatePlans", ClampMin = "0.0"))
+	float NetPlanTolerance = 25.0f;
 
-	// Warp target name specified in the vault montage.
-	UPROPERTY(EditAnywhere, Category = "Vault")
-	FName VaultLandWarpTargetName;
+	// Whether movement replication was paused for the action in progress.
+	bool bMovementReplicationPaused = false;
 
-	// Calculated height of the object to vault over. Will only be set after an attemp to vault.
-	UPROPERTY(BlueprintReadOnly, Category = "Vault")
-	float VaultHeight;
+	// Whether dedicated servers move characters along the baked root motion of their vaults and mantles instead of playing the montages. Requires the traversal movement component and a cooked animation table.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Baked Root Motion")
+	bool bUseBakedRootMotionOnServer = true;
 
 
 
-	// Max distance to object to initiate mantle.
-	UPROPERTY(EditAnywhere, Category = "Mantle")
-	float MantleReachDistance;
+	// Whether check results are cached and reused while the character stays in nearly the same pose relative to the same obstacle.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Check Cache")
+	bool bUseCheckCache = true;
 
-	// Min ledge height that can be mantled on.
-	UPROPERTY(EditAnywhere, Category = "Mantle")
-	float MantleMinLedgeHeight;
+	// Grid size used to quantize the character's location relative to the obstacle. Checks within the same cell share a result.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Check Cache", meta = (EditCondition = "bUseCheckCache", ClampMin = "0.1"))
+	float CheckCacheLocationTolerance = 5.0f;
 
-	// Max ledge height that can be mantled on.
-	UPROPERTY(EditAnywhere, Category = "Mantle")
-	float MantleMaxLedgeHeight;
+	// Step in degrees used to quantize the character's rotation and movement input relative to the obstacle.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Check Cache", meta = (EditCondition = "bUseCheckCache", ClampMin = "0.1"))
+	float CheckCacheAngleTolerance = 5.0f;
 
-	// Animation properties that are used to adjust animation to conditions.
-	UPROPERTY(EditAnywhere, Category = "Mantle|Animations")
-	TArray<FAnimationPropertySettings> MantleAnimationPropertySettings;
+	// Time in seconds after which a cached result is discarded. Limits how long changes to the surroundings of an obstacle can go unnoticed.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Check Cache", meta = (EditCondition = "bUseCheckCache"))
+	float CheckCacheLifetime = 0.5f;
 
-	// Warp target name specified in the mantle montage.
-	UPROPERTY(EditAnywhere, Category = "Mantle")
-	FName MantleWarpTargetName;
+	// Max number of cached results. The oldest result is replaced once full.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Check Cache", meta = (EditCondition = "bUseCheckCache", ClampMin = "1"))
+	int32 CheckCacheSize = 8;
 
-	// Calculated height of the object to mantle on. Will only be set after an attempt to mantle.
-	UPROPERTY(BlueprintReadOnly, Category = "Mantle")
-	float MantleHeight;
+	// Cached check results.
+	TArray<FTraversalCheckCacheEntry> CheckCache;
+
+
+
+	// Whether vault, mantle and wall climb checks run in the background ahead of the character, so a plan is armed before the action is requested.
+	// Requesting the action then commits the armed plan without tracing. Look-ahead checks are batched with the traversal world subsystem and never run on simulated proxies.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Look Ahead")
+	bool bUseLookAhead = false;
+
+	// Interval in seconds between look-ahead checks.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Look Ahead", meta = (EditCondition = "bUseLookAhead", ClampMin = "0.02"))
+	float LookAheadInterval = 0.1f;
+
+	// Time in seconds the character is moved along its velocity to predict the pose a look-ahead check is run from.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Look Ahead", meta = (EditCondition = "bUseLookAhead", ClampMin = "0.0"))
+	float LookAheadTime = 0.1f;
+
+	// Max distance between the character and the predicted pose of an armed plan for the plan to be committed.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Look Ahead", meta = (EditCondition = "bUseLookAhead", ClampMin = "0.0"))
+	float ArmedPlanLocationTolerance = 30.0f;
+
+	// Max angle in degrees between the character's rotation and movement input and those of the predicted pose of an armed plan for the plan to be committed.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Look Ahead", meta = (EditCondition = "bUseLookAhead", ClampMin = "0.0", ClampMax = "180.0"))
+	float ArmedPlanAngleTolerance = 15.0f;
+
+	// Time in seconds after which an armed plan is discarded.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Look Ahead", meta = (EditCondition = "bUseLookAhead", ClampMin = "0.0"))
+	float ArmedPlanLifetime = 0.3f;
+
+	// Plans armed by look-ahead checks for each action.
+	TMap<ETraversalState, FTraversalArmedPlan> ArmedPlans;
+
+	// Timer running the look-ahead checks.
+	FTimerHandle LookAheadTimerHandle;
+
+
+
+	// Whether async checks are queued with the traversal world subsystem and evaluated together with the checks of all other characters once per frame, instead of issuing async traces.
+	UPROPERTY(EditAnywhere, Category = "Traversal")
+	bool bUseBatchedChecks = false;
+
+	// Whether blocking checks trace stages that don't depend on each other concurrently as tasks, like the vault depth traces and the walkable trace, or the wall climb room traces and the forward trace.
+	// Lowers the time a check takes to its longest chain of dependent traces. Stages traced ahead are wasted when an earlier stage rejects the check after they started.
+	UPROPERTY(EditAnywhere, Category = "Traversal")
+	bool bUseParallelStages = false;
+
+	// Whether vault and mantle checks look up ledges baked by ATraversalLedgeIndex before tracing. Obstacles that weren't baked are still traced.
+	// The capsule path is always traced so dynamic objects blocking it are detected.
+	UPROPERTY(EditAnywhere, Category = "Traversal")
+	bool bUseLedgeIndex = true;
+
+	// Whether vault and mantle checks compute the top and far side of obstacles whose simple collision is a single box, instead of tracing them.
+	// Obstacles with other collision, like ramps, chamfered boxes and capsules, are still traced.
+	UPROPERTY(EditAnywhere, Category = "Traversal")
+	bool bUseCollisionLedges = true;
+
+	// Distance to a baked ledge within which the vault and mantle montages are loaded. 0 loads them in Initialize and keeps them loaded.
+	// Without any ledge index in the level, the montages are loaded right away.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Montage Streaming", meta = (ClampMin = "0.0"))
+	float MontagePreloadDistance = 800.0f;
+
+	// Interval in seconds between checks for ledges near the character.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Montage Streaming", meta = (ClampMin = "0.05"))
+	float MontagePreloadInterval = 0.5f;
+
+	// Time in seconds without a ledge near the character after which the vault and mantle montages are released.
+	UPROPERTY(EditAnywhere, Category = "Traversal|Montage Streaming", meta = (ClampMin = "0.0"))
+	float MontageReleaseDelay = 15.0f;
+
+	// Handles keeping the montages of each action loaded.
+	TMap<ETraversalState, TSharedPtr<FStreamableHandle>> MontageHandles;
+
+	// Timer checking for ledges near the character.
+	FTimerHandle MontagePreloadTimerHandle;
+
+	// World time at which a ledge was last near the character.
+	double LastLedgeNearTime = 0.0;
+
+	// World time of the last memory trim. Montages aren't preloaded for the release delay after it.
+	double LastMemoryTrimTime = -UE_BIG_NUMBER;
+
+	// Handle of the OnMemoryTrim binding.
+	FDelegateHandle MemoryTrimDelegateHandle;
+
+	// LOD levels selected through the significance manager, ordered from most to least significant.
+	// The traversal world subsystem updates the significance manager with the views of the local players unless traversal.Significance.Update is disabled.
+	UPROPERTY(EditAnywhere, Category = "Traversal|LOD")
+	TArray<FTraversalLODSettings> LODSettings;
+
+	// Multiplier applied to the distance of characters behind the viewer when picking the LOD level.
+	UPROPERTY(EditAnywhere, Category = "Traversal|LOD", meta = (ClampMin = "1.0"))
+	float OffScreenDistanceScale = 2.0f;
+
+	// Current LOD level. Index into LODSettings.
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Traversal|LOD")
+	int32 CurrentLOD = 0;
+
+
+
+	// Check currently resolved through asynchronous traces.
+	FTraversalCheck AsyncCheck;
+
+	// Whether AsyncCheck is waiting for a trace result.
+	bool bAsyncCheckPending = false;
+
+	// Handle of the async trace in flight. Results for any other handle are stale and ignored.
+	FTraceHandle AsyncTraceHandle;
+
+	// Delegate bound to OnAsyncCheckTraceCompleted.
+	FTraceDelegate AsyncTraceDelegate;
+
+public:
+	// Sets default values for this component's properties.
+	UTraversalComponent();
+
+	// Called every frame
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	virtual void PostLoad() override;
+
+	/**
+	* Initialize the component and set default values.
+	* 
+	* @param Character Owning character.
+	*/
+	UFUNCTION(BlueprintCallable)
+	void Initialize(ACharacter* Character);
+
+	/**
+	* Get the tuning of the actions.
+	*
+	* @return Config of the component. Set by Initialize if the component has none.
+	*/
+	const UTraversalConfig* GetConfig() const;
+
+	/**
+	* Check if the character meets the requirements to vault.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vault")
+	bool VaultCheck();
+
+	/**
+	* Check if the character meets the requirements to mantle.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Mantle")
+	bool MantleCheck();
+
+	/**
+	* Check if the character meets the requirements to slide.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Slide")
+	bool SlideCheck();
+
+	/**
+	* Check if the character meets the requirements to wall climb.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Wall Climb")
+	bool WallClimbCheck();
+
+	/**
+	* Check vault and mantle together on the same ledge and start whichever applies. Vaulting is preferred over mantling.
+	* The forward and downward traces are shared, so this is cheaper than calling VaultCheck and MantleCheck one after the other.
+	* 
+	* @return Action that was started, or None.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal")
+	ETraversalState EvaluateTraversal();
+
+	/**
+	* Same as EvaluateTraversal, but the traces are resolved asynchronously and the action is started a frame or more later.
+	* OnAsyncCheckCompleted is broadcast once the check has finished.
+	*
+	* @return Whether the check was submitted. Only one async check can be in flight at a time.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal")
+	bool EvaluateTraversalAsync();
+
+	/**
+	* Same as VaultCheck, but the traces are resolved asynchronously and the vault is started a frame or more later.
+	* OnAsyncCheckCompleted is broadcast once the check has finished.
+	*
+	* @return Whether the check was submitted. Only one async check can be in flight at a time.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Vault")
+	bool VaultCheckAsync();
+
+	/**
+	* Same as MantleCheck, but the traces are resolved asynchronously and the mantle is started a frame or more later.
+	* OnAsyncCheckCompleted is broadcast once the check has finished.
+	*
+	* @return Whether the check was submitted. Only one async check can be in flight at a time.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Mantle")
+	bool MantleCheckAsync();
+
+	/**
+	* Same as WallClimbCheck, but the traces are resolved asynchronously and the wall climb is started a frame or more later.
+	* OnAsyncCheckCompleted is broadcast once the check has finished.
+	*
+	* @return Whether the check was submitted. Only one async check can be in flight at a time.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Wall Climb")
+	bool WallClimbCheckAsync();
+
+	/**
+	* Discard all cached check results.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal")
+	void InvalidateCheckCache();
+
+	/**
+	* Set the LOD level used for checks. Changing the level discards the cached check results.
+	* 
+	* @param LOD Index into LODSettings.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal|LOD")
+	void SetLOD(int32 LOD);
 
+	/**
+	* Cancel the async check in flight, if any. OnAsyncCheckCompleted will not be broadcast for it.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal")
+	void CancelAsyncCheck();
 
+	/**
+	* Start loading the montages of an action, so they are resident when the action starts. Call when entering a mode the action is expected in.
+	* 
+	* @param Action Vaulting, Mantling or WallClimbing.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal|Montage Streaming")
+	void PreloadMontages(ETraversalState Action);
 
-	// Base slide power.
-	UPROPERTY(EditAnywhere, Category = "Slide")
-	float SlidePower;
+	/**
+	* Release the montages of an action. They are unloaded once nothing else references them.
+	* 
+	* @param Action Vaulting, Mantling or WallClimbing.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal|Montage Streaming")
+	void ReleaseMontages(ETraversalState Action);
 
-	// Determines how much influence the floor's normal has.
-	UPROPERTY(EditAnywhere, Category = "Slide")
-	float SlideFloorMultiplier;
+	/**
+	* Stop the vault or mantle in progress, if any. Movement mode is reset to walking and traversal state to none.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal")
+	void CancelAction();
 
-	// Ground friction during slide.
-	UPROPERTY(EditAnywhere, Category = "Slide")
-	float SlideGroundFriction;
+	/**
+	* Open the exit window of the vault or mantle in progress. The action then ends as soon as the character has movement input, which is polled when the component ticks.
+	* Called by UAnimNotifyState_TraversalExitWindow. Simulated proxies have no input, so they end the action when the server does, or at the end of the window.
+	*
+	* @param Montage Montage the exit window belongs to. Nothing happens if it isn't the montage of the action in progress.
+	* @param BlendOutTime Blend out time of the montage in seconds when the action ends in the window.
+	*/
+	void BeginExitWindow(const UAnimSequenceBase* Montage, float BlendOutTime);
 
-	// Braking power during slide.
-	UPROPERTY(EditAnywhere, Category = "Slide")
-	float SlideBrakingPower;
+	/**
+	* End the vault or mantle in progress before its montage ends. Called by UAnimNotifyState_TraversalExitWindow at the end of the window.
+	* 
+	* @param Montage Montage the exit window belongs to. Nothing happens if it isn't the montage of the action in progress.
+	* @param bRequireInput Only exit if the character has movement input. Never exits on simulated proxies. The server sends the exit to them.
+	* @param BlendOutTime Blend out time of the montage in seconds.
+	* @return Action was ended.
+	*/
+	bool TryExitAction(const UAnimSequenceBase* Montage, bool bRequireInput, float BlendOutTime);
 
-	// Min speed while sliding. Slide will be stopped if the owning character's speed gets below this value.
-	UPROPERTY(EditAnywhere, Category = "Slide")
-	float SlideMinSpeed;
+	// Called when an async check has finished. bStarted is true if the action was started.
+	UPROPERTY(BlueprintAssignable, Category = "Traversal")
+	FOnTraversalAsyncCheckCompleted OnAsyncCheckCompleted;
 
-	// Max speed while sliding. Used to clamp owning character's speed to this value while sliding.
-	UPROPERTY(EditAnywhere, Category = "Slide")
-	float SlideMaxSpeed;
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
 
-	
+	// Called when the game ends
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-	// Froward distance used to detect wall.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb")
-	float WallDetectionDistance;
+	/**
+	* Get the most bottom point of the capsule component.
+	* 
+	* @return Most bottom point of the capsule component.
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	FVector GetCapsuleBaseLocation();
 
-	// Speed while wall climbing.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb")
-	float WallClimbSpeed;
+	/**
+	* Place capsule collision on top of a given point.
+	* 
+	* @param BaseLocation Location to place capsule collision on.
+	* @return Most bottom point of the capsule component.
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	FVector GetCapsuleLocationFromBaseLocation(FVector BaseLocation);
 
-	// Distance used to detect wall for inward turns.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
-	float InwardTurnDetectionDistance;
+	/**
+	* Get the location of the capsule placed on top of a given point using the captured pose's capsule dimensions.
+	* 
+	* @param Pose Pose captured at the start of the check.
+	* @param BaseLocation Location to place capsule collision on.
+	* @return Location of the capsule component.
+	*/
+	FVector GetPoseCapsuleLocation(const FTraversalPose& Pose, FVector BaseLocation) const;
+
+	/**
+	* Take a snapshot of the owning character that the traces of a check are built from.
+	* 
+	* @return Current pose of the owning character.
+	*/
+	FTraversalPose CapturePose() const;
 
-	// Max angle for inward turns.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
-	float MaxInwardTurnAngle;
+	/**
+	* Check if the owning character is in a state that allows the given action to start.
+	* 
+	* @param Action Vaulting, Mantling or WallClimbing. None checks whether any action can start.
+	* @return Action can start.
+	*/
+	bool CanStartCheck(ETraversalState Action) const;
 
-	// Left inward turn animation.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
-	UAnimMontage* LeftInwardTurnAnimation;
+	/**
+	* Create a check for the given action from the owning character's current pose.
+	* 
+	* @param Action Vaulting, Mantling or WallClimbing. None evaluates vault and mantle together.
+	* @return Check positioned at its first stage.
+	*/
+	FTraversalCheck BeginCheck(ETraversalState Action) const;
 
-	// Right inward turn animation.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
-	UAnimMontage* RightInwardTurnAnimation;
+	/**
+	* Build the trace the check's current stage needs.
+	* 
+	* @param Check Unfinished check.
+	* @return Trace to run for the current stage.
+	*/
+	FTraversalTraceQuery GetCheckQuery(const FTraversalCheck& Check) const;
 
-	// Distance used to detect wall at direction of input.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb")
-	float DirectionalTraceDistance;
-	
-	// Distance used to detect wall for outward turns.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
-	float OutwardTurnDetectionDistance;
+	/**
+	* Evaluate the hit of the current stage's trace and move the check to its next stage, or finish it.
+	* 
+	* @param Check Unfinished check.
+	* @param Hit Result of the trace returned by GetCheckQuery.
+	* @param ReplayStep Captured step the hit comes from when replaying. Its results are used instead of reading the collision of the hit component, which isn't captured.
+	*/
+	void AdvanceCheck(FTraversalCheck& Check, const FHitResult& Hit, const FTraversalCaptureStep* ReplayStep = nullptr) const;
 
-	// Max angle for outward turns.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
-	float MaxOutwardTurnAngle;
+	/**
+	* Run the stages of a captured check again, advancing it with the captured hits instead of tracing. Used to replay checks without a world.
+	* 
+	* @param Check Check as it was created by BeginCheck.
+	* @param Steps Captured stages of the check, with the query and hit of each.
+	* @return The check reached every captured stage in order and built the same query for it.
+	*/
+	bool ReplayCheck(FTraversalCheck& Check, TConstArrayView<FTraversalCaptureStep> Steps) const;
 
-	// Left outward turn animation.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
-	UAnimMontage* LeftOutwardTurnAnimation;
+	/**
+	* Move the check to the capsule path stage, or complete it right away if the current LOD level skips the path check.
+	* 
+	* @param Check Unfinished vault or mantle check.
+	*/
+	void EnterCapsulePathStage(FTraversalCheck& Check) const;
 
-	// Right outward turn animation.
-	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
-	UAnimMontage* RightOutwardTurnAnimation;
+	/**
+	* Pick the animation for the checked action and finish the check. Fails if no animation fits the height.
+	* 
+	* @param Check Unfinished vault or mantle check.
+	*/
+	void CompletePlan(FTraversalCheck& Check) const;
 
-	UPROPERTY(BlueprintReadOnly, Category = "Wall Climb")
-	float WallClimbHorizontalInput;
+	/**
+	* Finish the check as failed. A unified check that fails to vault falls back to mantling onto the same ledge instead.
+	* 
+	* @param Check Unfinished check.
+	*/
+	void FailCheck(FTraversalCheck& Check) const;
 
-	UPROPERTY(BlueprintReadOnly, Category = "Wall Climb")
-	float WallClimbVerticalInput;
+	/**
+	* Check if the angle between the owning character's forward vector and the obstacle's normal allows vaulting.
+	* 
+	* @param Pose Pose captured at the start of the check.
+	* @param ImpactNormal Impact normal of the initial trace.
+	* @return Approach angle allows vaulting.
+	*/
+	bool IsApproachAngleVaultable(const FTraversalPose& Pose, FVector ImpactNormal) const;
 
-	bool bWallClimbIsTurning = false;
+	/**
+	* Get the reach distance and ledge height band of the check's action. Unified checks use the union of the vault and mantle values.
+	*
+	* @param Check Vault, mantle or unified check.
+	* @param OutReachDistance Max distance to the obstacle.
+	* @param OutMinLedgeHeight Min height of the ledge.
+	* @param OutMaxLedgeHeight Max height of the ledge.
+	*/
+	void GetLedgeBand(const FTraversalCheck& Check, float& OutReachDistance, float& OutMinLedgeHeight, float& OutMaxLedgeHeight) const;
 
-	FTimerHandle WallClimbTurnMontageCompletedHandle;
+	/**
+	* Resolve the check's current stage from a ledge baked by ATraversalLedgeIndex, or computed from the obstacle's box collision, instead of tracing.
+	* The first stage looks the baked ledge up, later vault and mantle stages are derived from it. Ledges computed from collision only resolve the walkable, reach and depth stages.
+	* The capsule path and wall climb stages are never resolved.
+	* Can be called from worker threads.
+	*
+	* @param Check Unfinished check.
+	* @param OutHit Hit result the trace of the current stage would have returned.
+	* @return Stage was resolved. The stage needs to be traced if false.
+	*/
+	bool ResolveFromLedge(FTraversalCheck& Check, FHitResult& OutHit) const;
 
-public:
-	// Sets default values for this component's properties.
-	UTraversalComponent();
+	/**
+	* Run every remaining stage of a check with blocking traces.
+	* 
+	* @param Check Check to run.
+	* @return Check succeeded.
+	*/
+	bool RunCheck(FTraversalCheck& Check);
 
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	/**
+	* Run every remaining stage of a check, tracing the current stage and the later stages that don't depend on it together as tasks.
+	* The hits are fed to the check in stage order. Once the check rejects or takes another path, the stages that haven't been traced yet are cancelled.
+	* 
+	* @param Check Check to run.
+	*/
+	void RunCheckParallel(FTraversalCheck& Check);
 
 	/**
-	* Initialize the component and set default values.
+	* Get the current stage of a check followed by the later stages whose traces don't depend on the result of any stage in between.
 	* 
-	* @param Character Owning character.
+	* @param Check Unfinished check.
+	* @param OutStages Stages to trace together, in the order the check reaches them.
 	*/
-	UFUNCTION(BlueprintCallable)
-	void Initialize(ACharacter* Character);
+	void GetParallelStages(const FTraversalCheck& Check, TArray<ETraversalCheckStage, TInlineAllocator<5>>& OutStages) const;
 
 	/**
-	* Check if the character meets the requirements to vault.
+	* Quantize the check's pose relative to the obstacle.
+	* 
+	* @param Check Check to build the key for.
+	* @param ObstacleTransform Transform of the obstacle.
+	* @return Cache key.
 	*/
-	UFUNCTION(BlueprintCallable, Category = "Vault")
-	bool VaultCheck();
+	FTraversalCheckCacheKey MakeCheckCacheKey(const FTraversalCheck& Check, const FTransform& ObstacleTransform) const;
 
 	/**
-	* Check if the character meets the requirements to mantle.
+	* Look for a cached result of a check with the same key against an obstacle that hasn't moved since.
+	* If one is found, the check is finished with the cached plan or rejection.
+	* 
+	* @param Check Check positioned at its first stage.
+	* @return Cached result was found.
 	*/
-	UFUNCTION(BlueprintCallable, Category = "Mantle")
-	bool MantleCheck();
+	bool FindCachedCheck(FTraversalCheck& Check);
 
 	/**
-	* Check if the character meets the requirements to slide.
+	* Store the result of a finished check. Checks that didn't hit an obstacle aren't cached.
+	* 
+	* @param Check Finished check.
 	*/
-	UFUNCTION(BlueprintCallable, Category = "Slide")
-	bool SlideCheck();
+	void CacheCheck(const FTraversalCheck& Check);
 
 	/**
-	* Check if the character meets the requirements to wall climb.
+	* Run a blocking trace against the detection trace channel from the game thread.
+	* 
+	* @param Query Trace to run.
+	* @param OutHit Hit result of the trace.
+	* @return Blocking hit found.
 	*/
-	UFUNCTION(BlueprintCallable, Category = "Wall Climb")
-	bool WallClimbCheck();
+	bool TraceSingle(const FTraversalTraceQuery& Query, FHitResult& OutHit);
 
-protected:
-	// Called when the game starts
-	virtual void BeginPlay() override;
+	/**
+	* Run a blocking trace against the detection trace channel.
+	* Can be called from worker threads.
+	* 
+	* @param Query Trace to run.
+	* @param OutHit Hit result of the trace.
+	* @return Blocking hit found.
+	*/
+	bool TraceSingleThreadSafe(const FTraversalTraceQuery& Query, FHitResult& OutHit) const;
 
 	/**
-	* Get the most bottom point of the capsule component.
+	* Run every remaining stage of a check with TraceSingleThreadSafe. Doesn't use the check cache.
+	* Can be called from worker threads.
 	* 
-	* @return Most bottom point of the capsule component.
+	* @param Check Check to run.
 	*/
-	UFUNCTION(BlueprintCallable, BlueprintPure)
-	FVector GetCapsuleBaseLocation();
+	void RunCheckThreadSafe(FTraversalCheck& Check) const;
 
 	/**
-	* Place capsule collision on top of a given point.
+	* Copy the plan's warp targets to the component and start the planned action.
+	* The selected montage is loaded synchronously if it hasn't streamed in yet, like for received plans, so the action is never dropped.
 	* 
-	* @param BaseLocation Location to place capsule collision on.
-	* @return Most bottom point of the capsule component.
+	* @param Plan Plan of a succeeded check.
+	* @return Action was started. False only if the montage couldn't be loaded at all.
 	*/
-	UFUNCTION(BlueprintCallable, BlueprintPure)
-	FVector GetCapsuleLocationFromBaseLocation(FVector BaseLocation);
+	bool CommitPlan(const FTraversalPlan& Plan);
 
 	/**
 	* Trace a sphere to check whether the capsule will collide with anything at the given location.
+	* The location has room for the capsule if nothing is hit.
 	* 
+	* @param Pose Pose captured at the start of the check.
 	* @param Location Location to check.
-	* @returns Room for capsule.
+	* @return Trace to run.
 	*/
-	bool IsRoomForCapsule(FVector Location);
+	FTraversalTraceQuery MakeRoomForCapsuleQuery(const FTraversalPose& Pose, FVector Location) const;
 
 	/**
 	* Check if the object is within reach.
 	* Check if the object's height is between the min and max ledge height.
-	* Check if there is room for the capsule component.
+	* The object is climbable if the hit isn't walkable.
 	* 
+	* @param Pose Pose captured at the start of the check.
 	* @param ReachDistance Distance from the character within which the object needs to be.
 	* @param MinLedgeHeight Min height of the ledge.
 	* @param MaxLedgeHeight Max height of the ledge.
-	* @return Whether the top of the object is walkable, the impact location on top of the object, and the impact normal of the top of the object.
+	* @return Trace to run.
 	*/
-	FIsObjectClimbableOut IsObjectClimbable(float ReachDistance, float MinLedgeHeight, float MaxLedgeHeight);
+	FTraversalTraceQuery MakeObjectClimbableQuery(const FTraversalPose& Pose, float ReachDistance, float MinLedgeHeight, float MaxLedgeHeight) const;
 
 	/**
-	* Trace downward from the initial trace's impact point and determine if the hit location is walkable.
-	* If it is, set the impact point of this trace as object start sync point.
+	* Trace downward from the initial trace's impact point to determine if the top of the object is walkable.
+	* If it is, the impact point of this trace is used as object start sync point.
 	* 
+	* @param Pose Pose captured at the start of the check.
 	* @param MaxLedgeHeight Max height of the ledge.
 	* @param InitialImpactPoint Impact point of the initial trace.
-	* @param InitialImpactNormal Impact normal of the initial trace.
-	* @return Whether the top of the object is walkable and the impact point of the trace. 
+	* @return Trace to run.
 	*/
-	FIsSurfaceWalkableOut IsSurfaceWalkable(float MaxLedgeHeight, FVector InitialImpactPoint, FVector InitialImpactNormal);
+	FTraversalTraceQuery MakeSurfaceWalkableQuery(const FTraversalPose& Pose, float MaxLedgeHeight, FVector InitialImpactPoint) const;
 
 	/**
-	* Check if nothing is blocking the path by sweeping a capsule along the path.
+	* Sweep a capsule along the path to check if nothing is blocking it.
 	* 
+	* @param Pose Pose captured at the start of the check.
 	* @param Height Height of the ledge.
 	* @param EndTargetLocation Target location of the vault or target.
-	* @return Path is clear.
+	* @return Trace to run.
 	*/
-	bool IsCapsulePathClear(float Height, FVector EndTargetLocation);
+	FTraversalTraceQuery MakeCapsulePathQuery(const FTraversalPose& Pose, float Height, FVector EndTargetLocation) const;
 
 	/**
-	* Determine the correct vault/mantle animation based on the ledge height in FAnimationPropertySettings.
+	* Select the vault or mantle animation from the animation table of the plan's action.
 	* Adjust the starting position for the mantle montage.
 	* 
-	* @param Height Ledge height.
-	* @param AnimationPropertySettings Property settings of each vault and mantle animation.
+	* @param Plan Plan to select the animation for.
+	* @param Pose Pose the action starts from.
 	* @return Animation properties to be used for the action.
 	*/
-	FAnimationProperties DetermineAnimationProperties(float Height, const TArray<FAnimationPropertySettings>& AnimationPropertySettings);
+	FAnimationProperties SelectAnimation(const FTraversalPlan& Plan, const FTraversalPose& Pose) const;
+
 
 
+	/**
+	* Trace forward from the character to find the front of the object to vault over.
+	* 
+	* @param Pose Pose captured at the start of the check.
+	* @return Trace to run.
+	*/
+	FTraversalTraceQuery MakeVaultReachQuery(const FTraversalPose& Pose) const;
 
 	/**
-	* Check if the depth of the actor can be vaulted over and if the character capsule fits after vault.
+	* Trace back from the max vault depth towards the front of the object to find the end of the object.
 	* 
-	* @return Whether object is in range and there is room for the capsule component and the impact point of the object depth check.
+	* @param Pose Pose captured at the start of the check.
+	* @param ReachImpactPoint Impact point of the reach trace.
+	* @return Trace to run.
 	*/
-	FCanVaultOverDepthOut CanVaultOverDepth();
+	FTraversalTraceQuery MakeVaultDepthQuery(const FTraversalPose& Pose, FVector ReachImpactPoint) const;
 
 	/**
 	* Trace down from the object end point + the specified vault land distance to get the target landing point.
 	* 
+	* @param Pose Pose captured at the start of the check.
 	* @param ObjectEndPoint End point of the object to be vaulted over.
-	* @return Target location to land on.
+	* @return Trace to run.
 	*/
-	FVector GetVaultLandPoint(FVector ObjectEndPoint);
+	FTraversalTraceQuery MakeVaultLandQuery(const FTraversalPose& Pose, FVector ObjectEndPoint) const;
 
 	/**
 	* Prepare character and motion warping component for the vault.
 	* 
 	* @param VaultAnimation Vault animation to play.
+	* @param AnimationEndBlendTime Time in seconds cut off from the end of the animation if it has no exit window.
+	* @param BakedRootMotion Baked root motion of the animation to follow instead of playing it, or nullptr to play it.
 	*/
-	void VaultStart(UAnimMontage* VaultAnimation, float AnimationEndBlendTime);
-
-	/**
-	* Reset movement mode to walking and traversal state to none.
-	*/
-	void OnVaultMontageCompleted(float AnimationEndBlendTime);
+	void VaultStart(UAnimMontage* VaultAnimation, float AnimationEndBlendTime, const FTraversalBakedRootMotion* BakedRootMotion = nullptr);
 
 
 	/**
@@ -473,19 +1395,15 @@ protected:
 	* @param MantleAnimation Mantle animation to play.
 	* @param HeightOffset Offset added to the warp target location's Z axis.
 	* @param StartingPosition Starting position/time of the mantle animation.
+	* @param BakedRootMotion Baked root motion of the animation to follow instead of playing it, or nullptr to play it.
 	*/
-	void MantleStart(const FAnimationProperties& AnimationProperties);
-
-	/**
-	* Reset movement mode to walking and traversal state to none.
-	*/
-	void OnMantleMontageCompleted(float AnimationEndBlendTime);
+	void MantleStart(const FAnimationProperties& AnimationProperties, const FTraversalBakedRootMotion* BakedRootMotion = nullptr);
 
 
 	// Start slide
 	void SlideStart();
 
-	// Slide update
+	// Slide update. Called every frame while sliding without the traversal movement component
 	void SlideUpdate();
 
 	// Calculate the force applied while sliding
@@ -504,12 +1422,21 @@ protected:
 	*/
 	FHitResult ForwardTrace(FVector Offset);
 
+	/**
+	* Build a trace forward from the character's location taking into account the offset.
+	* 
+	* @param Pose Pose captured at the start of the check.
+	* @param Offset Offset to be added to the trace's start location.
+	* @return Trace to run.
+	*/
+	FTraversalTraceQuery MakeForwardQuery(const FTraversalPose& Pose, FVector Offset) const;
+
 	/**
 	* Prepare the character for the wall climb and move and rotate the character against the wall.
 	* 
 	* @param ForwardTraceHit Hit result of the forward trace.
 	*/
-	void WallClimbStart(FHitResult& ForwardTraceHit);
+	void WallClimbStart(const FHitResult& ForwardTraceHit);
 
 	/**
 	* Reset the traversal state and character movement component to walking state.
@@ -518,75 +1445,348 @@ protected:
 	void WallClimbStop();
 
 	/**
-	* Check in each direction whether there is enough room to hold onto the wall by using the player capsule component's size.
+	* Trace forward from the top, bottom, right or left of the character to check whether there is enough room to hold onto the wall.
+	*
+	* @param Pose Pose captured at the start of the check.
+	* @param Direction Direction from the character to offset the trace by.
+	* @return Trace to run.
+	*/
+	FTraversalTraceQuery MakeWallClimbRoomQuery(const FTraversalPose& Pose, FVector Direction) const;
+
+	/**
+	* Look up the corner of the wall patch in the direction of the horizontal input, and turn around it once close enough.
+	* Only walls with box collision have corners. Turns on other walls aren't detected.
+	*
+	* @param AxisValue Horizontal input movement value of the character. Negative values move left.
+	* @param Direction Horizontal input movement direction on the wall.
+	* @return A turn was started.
+	*/
+	bool WallClimbCornerTurn(float AxisValue, const FVector& Direction);
+
+	/**
+	* Play the correct inward turn animation.
+	* 
+	* @param AxisValue Input movement value of the character. Used to check the turn direction.
+	*/
+	void WallClimbInwardTurn(float AxisValue);
+
+	/**
+	* Play the correct outward turn animation.
 	*
-	* @returns Whether there is room on each side of the character to start the wall climb.
+	* @param AxisValue Input movement value of the character. Used to check the turn direction.
+	*/
+	void WallClimbOutwardTurn(float AxisValue);
+
+	/**
+	* Handle movement during wall climb. Move the character towards the input direction.
+	* 
+	* @param Direction Input movement direction of the character. Used to determine the movement direction.
+	* @param AxisValue Input movement value of the character. Used to determine the movement direction.
 	*/
-	bool IsRoomToStartWallClimb();
+	UFUNCTION(BlueprintCallable)
+	void WallClimbMovement(FVector2D Direction);
+
+	void SetWallClimbAnimationMovementDirections(FVector Direction);
 
 	/**
-	* Check if the target wall can be climbed onto based on the angle between the current wall and the target wall.
+	* Allow wall climb movement again once the turn montage blends out or ends.
 	* 
-	* @param CurrentWallNormal Normal of the wall the character is currently on.
-	* @param TargetWallNormal Normal of the wall the character wants to climb onto.
-	* @param MaxTurnAngle The max angle between the current wall and the target wall onto which the character can climb.
-	* @return Target wall can be climbed onto.
+	* @param Montage Turn montage.
+	* @param bInterrupted Montage was interrupted by another montage or stopped.
+	* @param InstanceID Instance of the montage the event is for.
 	*/
-	bool IsTurnAngleClimbable(FVector CurrentWallNormal, FVector TargetWallNormal, float MaxTurnAngle);
+	void OnWallClimbTurnMontageCompleted(UAnimMontage* Montage, bool bInterrupted, int32 InstanceID);
+
+
 
 	/**
-	* Shoot a trace towards the input movement direction to detect a wall for an inward trace.
+	* Play a montage and bind its blending out and ended events.
 	* 
-	* @param Direction Input movement direction of the character.
-	* @param AxisValue Input movement value of the character.
-	* @param CurrentWallNormal Normal of the wall the character is currently on.
+	* @param Montage Montage to play.
+	* @param StartingPosition Starting position of the montage in seconds.
+	* @param OnCompleted Called with the montage instance ID when the montage starts blending out and when it ends.
+	* @return Instance ID of the montage, or INDEX_NONE if it couldn't be played.
 	*/
-	void WallClimbInwardTurnTrace(FVector Direction, float AxisValue, FVector CurrentWallNormal);
+	int32 PlayMontage(UAnimMontage* Montage, float StartingPosition, void (UTraversalComponent::*OnCompleted)(UAnimMontage*, bool, int32));
 
 	/**
-	* Play the correct inward turn animation.
+	* Play the montage of the vault or mantle that was just started and track it as the action in progress.
 	* 
-	* @param AxisValue Input movement value of the character. Used to check the turn direction.
+	* @param Montage Montage to play.
+	* @param StartingPosition Starting position of the montage in seconds.
+	* @param AnimationEndBlendTime Time in seconds cut off from the end of the montage if it has no exit window.
 	*/
-	void WallClimbInwardTurn(float AxisValue);
+	void StartActionMontage(UAnimMontage* Montage, float StartingPosition, float AnimationEndBlendTime);
+
+	/**
+	* Get the baked root motion a plan follows instead of playing its montage. Used on dedicated servers and by simulated proxies at LOD levels that allow it.
+	* 
+	* @param Plan Vault or mantle plan.
+	* @return Baked root motion of the plan's animation, or nullptr if the montage is played.
+	*/
+	const FTraversalBakedRootMotion* FindBakedRootMotion(const FTraversalPlan& Plan) const;
+
+	/**
+	* Track the vault or mantle that was just started as the action in progress, and follow its baked root motion instead of playing its montage.
+	* The mesh stops ticking until the action ends.
+	* 
+	* @param BakedRootMotion Baked root motion of the action's montage.
+	* @param StartingPosition Montage position to start at.
+	* @param AnimationEndBlendTime Time in seconds cut off from the end of the montage if it has no exit window.
+	* @param WarpTargets Location of each warp target by name. The root reaches a target at the end of its warp windows.
+	*/
+	void StartBakedAction(const FTraversalBakedRootMotion& BakedRootMotion, float StartingPosition, float AnimationEndBlendTime, TConstArrayView<TPair<FName, FVector>> WarpTargets);
+
+	/**
+	* Advance the baked root motion of the action in progress. An action the server ends in its exit window is also ended on the simulated proxies.
+	* 
+	* @param DeltaTime Time to advance by.
+	* @param OutLocation Location of the character at the new position.
+	* @param OutRotation Rotation of the character at the new position.
+	* @return Action continues. False once it reached its exit position, or its exit window with movement input.
+	*/
+	bool AdvanceBakedAction(float DeltaTime, FVector& OutLocation, FQuat& OutRotation);
+
+	/**
+	* Get the transform of the character at a position of the baked root motion of the action in progress, with the warp corrections applied.
+	* 
+	* @param Position Montage position.
+	* @param OutLocation Location of the character.
+	* @param OutRotation Rotation of the character.
+	*/
+	void GetBakedActionTransform(float Position, FVector& OutLocation, FQuat& OutRotation) const;
+
+	/**
+	* Move the character along the baked root motion of the action in progress, and end the action once it is done or the character is blocked. The move is swept. Called every tick when the movement component doesn't move the character.
+	* 
+	* @param DeltaTime Time since the last update.
+	*/
+	void UpdateBakedAction(float DeltaTime);
+
+	/**
+	* End the vault or mantle in progress once its montage is past the exit position, or once there is movement input in its open exit window.
+	* Called every frame while the action is in progress and its montage has no exit window, or its exit window is open.
+	*/
+	void UpdateActionExit();
+
+	/**
+	* End the vault or mantle in progress and blend its montage out.
+	* 
+	* @param BlendOutTime Blend out time of the montage in seconds.
+	* @param bInterrupted Action was cancelled rather than completed.
+	*/
+	void ExitAction(float BlendOutTime, bool bInterrupted);
+
+	/**
+	* End the vault or mantle in progress once its montage starts blending out or ends.
+	* 
+	* @param Montage Montage of the action.
+	* @param bInterrupted Montage was interrupted by another montage or stopped.
+	* @param InstanceID Instance of the montage the event is for.
+	*/
+	void OnActionMontageCompleted(UAnimMontage* Montage, bool bInterrupted, int32 InstanceID);
+
+	/**
+	* Reset movement mode to walking and traversal state to none, and stop tracking the action in progress.
+	* 
+	* @param bInterrupted Action was cancelled or its montage interrupted.
+	*/
+	void FinishAction(bool bInterrupted);
+
+
+
+	/**
+	* Set the movement mode of an action. The traversal movement component enters its custom mode for the action, other movement components fly.
+	* 
+	* @param Action Vaulting, Mantling or WallClimbing. None returns to walking.
+	*/
+	void SetActionMovementMode(ETraversalState Action);
+
+	/**
+	* Whether the server follows a remote client into a traversal mode it requested in its moves. Vaults and mantles need the server to have accepted the client's plan.
+	* Wall climbs are checked on the server and started if the check passes.
+	* 
+	* @param Mode Vaulting, Mantling or WallClimbing.
+	* @return Mode can be entered.
+	*/
+	bool CanEnterClientTraversalMode(ETraversalState Mode);
+
+	/**
+	* Keep the traversal state in sync with slides started or stopped by the traversal movement component, and with actions whose mode was left without them.
+	*/
+	UFUNCTION()
+	void OnMovementModeChanged(ACharacter* Character, EMovementMode PrevMovementMode, uint8 PreviousCustomMode);
+
+
+
+	/**
+	* Send a vault or mantle plan that was just started. The server sends it to the simulated proxies, the owning client sends it to the server.
+	* 
+	* @param Plan Plan that was started.
+	*/
+	void ReplicatePlan(const FTraversalPlan& Plan);
 
 	/**
-	* Shoot a forward trace from the top, right, bottom, or left of the character to check if there is space on the wall so the character can move in that direction.
+	* Rebuild a plan received over the network and start it.
 	* 
-	* @param Direction Input movement direction of the character.
-	* @param AxisValue Input movement value of the character.
-	* @return Hit result of the forward trace.
+	* @param NetPlan Received plan.
+	* @param bCatchUp Skip the part of the montage that played on the server before the plan arrived.
 	*/
-	FHitResult WallClimbDirectionalTrace(FVector Direction, float AxisValue);
+	void ApplyNetPlan(const FTraversalNetPlan& NetPlan, bool bCatchUp);
 
 	/**
-	* Shoot a trace inward to the left or right of the character depending on the input direction to detect walls for an outward turn.
-	* Gets called if the wall movement trace didn't hit anything.
+	* Whether a plan sent by the owning client is one the server's own check could have made. The height, animation entry and warp targets must be within the limits of the config,
+	* and the capsule path from the server's pose to the end of the plan must be clear.
+	* 
+	* @param NetPlan Plan started by the client.
+	* @return Plan can be started on the server.
+	*/
+	bool IsClientNetPlanValid(const FTraversalNetPlan& NetPlan);
+
+	/**
+	* Start the plan of a vault or mantle the owning client has started, and send it to the simulated proxies.
+	* 
+	* @param NetPlan Plan started by the client.
+	*/
+	UFUNCTION(Server, Reliable)
+	void ServerTraversalPlan(const FTraversalNetPlan& NetPlan);
+
+	/**
+	* Start a vault or mantle on simulated proxies. Ignored by the server and the owning client, which have started it already.
+	* Reliable because movement replication of the character is paused until the action ends. A proxy that missed the plan would stand still for the whole action and then snap to where it ended.
+	* 
+	* @param NetPlan Plan started by the server.
+	*/
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastTraversalPlan(const FTraversalNetPlan& NetPlan);
+
+	/**
+	* End a vault or mantle on simulated proxies, which the server ended in its exit window because of movement input. Ignored by the server and the owning client.
+	* Reliable so it arrives after the plan of the action, and because movement replication of the character only resumes once the action ends on the server.
 	*
-	* @param Direction Input movement direction of the character. Used to determine the traces' directions.
-	* @param AxisValue Input movement value of the character. Used to determine the traces' directions.
-	* @param CurrentWallNormal Normal of the wall the character is currently on.
-	* @param DirectionalTraceEnd The end of the wall movement trace. Used as the starting point of this trace.
+	* @param Action Action that was ended. Nothing happens if the proxy has since started another one.
+	* @param BlendOutTime Blend out time of the montage in seconds.
 	*/
-	void WallClimbOutwardTurnTrace(FVector Direction, float AxisValue, FVector CurrentWallNormal, FVector DirectionalTraceEnd);
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastExitAction(ETraversalState Action, float BlendOutTime);
+
+
 
 	/**
-	* Play the correct outward turn animation.
+	* Get the settings of the current LOD level.
+	* 
+	* @return Current LOD settings, or defaults if no LOD levels are set.
+	*/
+	const FTraversalLODSettings& GetLODSettings() const;
+
+	/**
+	* Get the interval between look-ahead checks at the current LOD level.
 	*
-	* @param AxisValue Input movement value of the character. Used to check the turn direction.
+	* @return Longest of LookAheadInterval and the look-ahead interval of the LOD level.
 	*/
-	void WallClimbOutwardTurn(float AxisValue);
+	float GetLookAheadInterval() const;
 
 	/**
-	* Handle movement during wall climb. Move the character towards the input direction.
+	* Significance of the owning character for a viewpoint. Called by the significance manager, possibly off the game thread.
 	* 
-	* @param Direction Input movement direction of the character. Used to determine the movement direction.
-	* @param AxisValue Input movement value of the character. Used to determine the movement direction.
+	* @param ViewTransform Transform of the viewpoint.
+	* @return Negative distance to the viewpoint, scaled up when the character is behind it.
 	*/
-	UFUNCTION(BlueprintCallable)
-	void WallClimbMovement(FVector2D Direction);
+	float CalculateSignificance(const FTransform& ViewTransform) const;
 
-	void SetWallClimbAnimationMovementDirections(FVector Direction);
+	/**
+	* Pick the LOD level whose min distance matches the significance.
+	* 
+	* @param Significance Highest significance across all viewpoints.
+	*/
+	void SetLODFromSignificance(float Significance);
+
+
+
+	/**
+	* Get the montages an action can play.
+	* 
+	* @param Action Vaulting, Mantling or WallClimbing.
+	* @param OutPaths Paths of the montages.
+	*/
+	void GetActionMontages(ETraversalState Action, TArray<FSoftObjectPath>& OutPaths) const;
+
+	/**
+	* Preload the vault and mantle montages while a baked ledge is near the character, and release them once none has been near for a while.
+	*/
+	void UpdateMontagePreloading();
+
+	/**
+	* Release the montages of actions that aren't active. Called when the platform runs low on memory.
+	* Actions that are checked before the montages are preloaded again load them on demand.
+	*/
+	void OnMemoryTrim();
+
+
+
+	/**
+	* Start a check for the given action that is resolved through async traces.
+	* 
+	* @param Action Vaulting, Mantling or WallClimbing. None evaluates vault and mantle together.
+	* @return Check was submitted.
+	*/
+	bool StartAsyncCheck(ETraversalState Action);
 
-	void OnWallClimbTurnMontageCompleted();
+	/**
+	* Resolve the async check's stages that don't need a trace, then submit the trace of the next stage or finish the check.
+	*/
+	void ContinueAsyncCheck();
+
+	/**
+	* Submit the trace of the async check's current stage.
+	*/
+	void SubmitAsyncCheckTrace();
+
+	/**
+	* Take the result of a check evaluated by the traversal world subsystem and finish the async check with it.
+	* 
+	* @param Check Finished check.
+	*/
+	void OnBatchedCheckCompleted(const FTraversalCheck& Check);
+
+	/**
+	* Commit the finished async check's plan if the action can still start, and broadcast OnAsyncCheckCompleted.
+	*/
+	void FinishAsyncCheck();
+
+	/**
+	* Advance the async check with the trace result and submit the next stage, or finish the check.
+	*/
+	void OnAsyncCheckTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+
+
+	/**
+	* Queue the look-ahead checks of vault and mantle and of wall climbing with the traversal world subsystem. Called on a timer.
+	*/
+	void UpdateLookAhead();
+
+	/**
+	* Begin a check from the pose the character is predicted to be in once the check has been evaluated.
+	*
+	* @param Action Action to check. None evaluates vault and mantle together.
+	* @return Look-ahead check positioned at its first stage.
+	*/
+	FTraversalCheck BeginLookAheadCheck(ETraversalState Action) const;
+
+	/**
+	* Arm the plan of a finished look-ahead check, or disarm the plans of its actions if it failed.
+	*
+	* @param Check Finished look-ahead check.
+	*/
+	void OnLookAheadCheckCompleted(const FTraversalCheck& Check);
+
+	/**
+	* Commit the armed plan of an action if the character is still close to the pose it was checked from and its obstacle hasn't moved.
+	* Only the animation is selected again, for the current speed. Plans that are no longer valid are disarmed.
+	*
+	* @param Action Action to commit. None commits a vault, or a mantle if no vault is armed.
+	* @return Action that was started, or None if no armed plan could be committed.
+	*/
+	ETraversalState CommitArmedPlan(ETraversalState Action);
 };
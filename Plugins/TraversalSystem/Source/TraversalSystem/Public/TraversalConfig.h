@@ -0,0 +1,221 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "TraversalComponent.h"
+#include "TraversalConfig.generated.h"
+
+class UTraversalAnimationTable;
+
+/**
+* Tuning of the vault, mantle, slide and wall climb actions, shared by every traversal component of a character archetype.
+* Components only reference the config, so crowds of the same archetype carry one copy of the distances, warp target names and animations instead of one per character.
+* Never changed at runtime. Components read it from worker threads while checks are batched or traced as tasks.
+*/
+UCLASS(BlueprintType)
+class TRAVERSALSYSTEM_API UTraversalConfig : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Z offset added to the capsule's starting position. Used for fine tuning when taking the height of the capsule component into account.
+	UPROPERTY(EditAnywhere, Category = "General")
+	float GlobalHeightOffsetZ;
+
+
+
+	// Max distance to object to initiate vault.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	float VaultReachDistance;
+
+	// Min ledge height that can be vaulted over.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	float VaultMinLedgeHeight;
+
+	// Max ledge height that can be vaulted over.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	float VaultMaxLedgeHeight;
+
+	// Min obstacle depth that can be vaulted over.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	float VaultMinDepth;
+
+	// Max obstacle depth that can be vaulted over.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	float VaultMaxDepth;
+
+	// Max angle between the owning character's forward vector and obstacle's normal that allows vaulting.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	int32 VaultMaxApproachAngle;
+
+	// Distance behind obstacle that will be landed at.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	float VaultLandDistance;
+
+	// Distance that will detect the ground behind the obstacle.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	float VaultMaxLandVerticalDistance;
+
+	// Vault animations selected by ledge height, obstacle depth, approach speed and approach angle.
+	UPROPERTY(EditAnywhere, Category = "Vault|Animations")
+	TObjectPtr<UTraversalAnimationTable> VaultAnimationTable;
+
+	// Animation properties that are used to adjust animation to conditions. Can be used to play different vault animation for different heights. Only used when no vault animation table is set.
+	UPROPERTY(EditAnywhere, Category = "Vault|Animations")
+	TArray<FAnimationPropertySettings> VaultAnimationPropertySettings;
+
+	// Warp target name specified in the vault montage.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	FName VaultObjectStartWarpTargetName;
+
+	// Warp target name specified in the vault montage.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	FName VaultObjectEndWarpTargetName;
+
+	// Warp target name specified in the vault montage.
+	UPROPERTY(EditAnywhere, Category = "Vault")
+	FName VaultLandWarpTargetName;
+
+
+
+	// Max distance to object to initiate mantle.
+	UPROPERTY(EditAnywhere, Category = "Mantle")
+	float MantleReachDistance;
+
+	// Min ledge height that can be mantled on.
+	UPROPERTY(EditAnywhere, Category = "Mantle")
+	float MantleMinLedgeHeight;
+
+	// Max ledge height that can be mantled on.
+	UPROPERTY(EditAnywhere, Category = "Mantle")
+	float MantleMaxLedgeHeight;
+
+	// Mantle animations selected by ledge height, approach speed and approach angle.
+	UPROPERTY(EditAnywhere, Category = "Mantle|Animations")
+	TObjectPtr<UTraversalAnimationTable> MantleAnimationTable;
+
+	// Animation properties that are used to adjust animation to conditions. Only used when no mantle animation table is set.
+	UPROPERTY(EditAnywhere, Category = "Mantle|Animations")
+	TArray<FAnimationPropertySettings> MantleAnimationPropertySettings;
+
+	// Warp target name specified in the mantle montage.
+	UPROPERTY(EditAnywhere, Category = "Mantle")
+	FName MantleWarpTargetName;
+
+
+
+	// Base slide power.
+	UPROPERTY(EditAnywhere, Category = "Slide")
+	float SlidePower;
+
+	// Determines how much influence the floor's normal has.
+	UPROPERTY(EditAnywhere, Category = "Slide")
+	float SlideFloorMultiplier;
+
+	// Ground friction during slide.
+	UPROPERTY(EditAnywhere, Category = "Slide")
+	float SlideGroundFriction;
+
+	// Braking power during slide.
+	UPROPERTY(EditAnywhere, Category = "Slide")
+	float SlideBrakingPower;
+
+	// Min speed while sliding. Slide will be stopped if the owning character's speed gets below this value.
+	UPROPERTY(EditAnywhere, Category = "Slide")
+	float SlideMinSpeed;
+
+	// Max speed while sliding. Used to clamp owning character's speed to this value while sliding.
+	UPROPERTY(EditAnywhere, Category = "Slide")
+	float SlideMaxSpeed;
+
+	// Fixed time step in seconds the slide velocity is integrated with by UTraversalMovementComponent. Slides cover the same distance at any frame rate.
+	UPROPERTY(EditAnywhere, Category = "Slide", meta = (ClampMin = "0.001", Units = "s"))
+	float SlideSubstepTime = 1.0f / 240.0f;
+
+	// Max number of slide steps per movement update. Time beyond it is dropped, so long hitches don't stall the update.
+	UPROPERTY(EditAnywhere, Category = "Slide", meta = (ClampMin = "1"))
+	int32 SlideMaxSubsteps = 32;
+
+
+
+	// Forward distance used to detect wall.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb")
+	float WallDetectionDistance;
+
+	// Speed while wall climbing.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb")
+	float WallClimbSpeed;
+
+	// Braking deceleration while wall climbing without movement input.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb")
+	float WallClimbBrakingDeceleration = 2048.0f;
+
+	// Distance used to detect wall for inward turns.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
+	float InwardTurnDetectionDistance;
+
+	// Max angle in radians between the walls for inward turns.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
+	float MaxInwardTurnAngle;
+
+	// Left inward turn animation.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
+	TSoftObjectPtr<UAnimMontage> LeftInwardTurnAnimation;
+
+	// Right inward turn animation.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Inward Turn")
+	TSoftObjectPtr<UAnimMontage> RightInwardTurnAnimation;
+
+	// Distance used to detect wall at direction of input.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb")
+	float DirectionalTraceDistance;
+
+	// Distance used to detect wall for outward turns.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
+	float OutwardTurnDetectionDistance;
+
+	// Max angle in radians between the walls for outward turns.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
+	float MaxOutwardTurnAngle;
+
+	// Left outward turn animation.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
+	TSoftObjectPtr<UAnimMontage> LeftOutwardTurnAnimation;
+
+	// Right outward turn animation.
+	UPROPERTY(EditAnywhere, Category = "Wall Climb|Outward Turn")
+	TSoftObjectPtr<UAnimMontage> RightOutwardTurnAnimation;
+
+protected:
+	// Vault animation table in use. Compiled from the vault animation property settings when no table is set.
+	UPROPERTY(Transient)
+	TObjectPtr<UTraversalAnimationTable> VaultAnimations;
+
+	// Mantle animation table in use. Compiled from the mantle animation property settings when no table is set.
+	UPROPERTY(Transient)
+	TObjectPtr<UTraversalAnimationTable> MantleAnimations;
+
+public:
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	* Use the vault and mantle animation tables, or compile tables from the animation property settings of configs that don't use them.
+	* Called when the config is created, loaded or edited. Configs are shared, so components never compile them.
+	*/
+	void CompileAnimationTables();
+
+	/**
+	* Get the animation table in use for an action.
+	*
+	* @param Action Vaulting or Mantling.
+	* @return Compiled table of the action, or nullptr for other actions or before the tables are compiled.
+	*/
+	const UTraversalAnimationTable* GetAnimations(ETraversalState Action) const;
+};
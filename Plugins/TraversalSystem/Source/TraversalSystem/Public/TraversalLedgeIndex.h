@@ -0,0 +1,138 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TraversalComponent.h"
+#include "TraversalLedgeIndex.generated.h"
+
+class UBoxComponent;
+
+/**
+* Ledges baked from the static collision inside the actor's bounds.
+* Place one per area of the level. With World Partition the actor is loaded together with the cell it is in, so the baked ledges stream in and out with the geometry they were baked from.
+* Traversal components look ledges up through the traversal world subsystem and only trace obstacles that weren't baked.
+*/
+UCLASS()
+class TRAVERSALSYSTEM_API ATraversalLedgeIndex : public AActor
+{
+	GENERATED_BODY()
+
+protected:
+	// Area to bake ledges in.
+	UPROPERTY(VisibleAnywhere, Category = "Ledge Index")
+	UBoxComponent* BoundsComponent;
+
+	// Trace channel used to detect objects. Should match the traversal component's detection trace channel.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	TEnumAsByte<ETraceTypeQuery> DetectionTraceChannel;
+
+	// Min ledge height that is baked. Should be at most the lowest min ledge height of the traversal configs.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	float MinLedgeHeight = 30.0f;
+
+	// Max ledge height that is baked. Should be at least the highest max ledge height of the traversal configs.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	float MaxLedgeHeight = 300.0f;
+
+	// Min Z of the top surface's normal. Tops that are steeper aren't baked.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float MinTopNormalZ = 0.71f;
+
+	// Distance in front of the edge at which the ground is probed to measure the ledge height.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	float EdgeProbeDistance = 30.0f;
+
+	// Distance behind the obstacle that will be landed at. Should match the traversal config's vault land distance.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	float LandDistance = 50.0f;
+
+	// Distance below the top of the obstacle that will detect the ground behind it.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	float MaxLandVerticalDistance = 300.0f;
+
+	// Radius of the capsule used to test for room on top of and behind the obstacle.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	float CapsuleRadius = 34.0f;
+
+	// Half height of the capsule used to test for room on top of and behind the obstacle.
+	UPROPERTY(EditAnywhere, Category = "Ledge Index|Bake")
+	float CapsuleHalfHeight = 88.0f;
+
+	// Baked ledges, sorted by the X of their center.
+	UPROPERTY(VisibleAnywhere, Category = "Ledge Index")
+	TArray<FTraversalLedge> Ledges;
+
+	// Largest distance along X between the center and the ends of a ledge. Widens the range searched around a query.
+	UPROPERTY()
+	double MaxHalfLengthX = 0.0;
+
+	// Bounds of all baked ledges.
+	UPROPERTY()
+	FBox LedgeBounds = FBox(ForceInit);
+
+public:
+	ATraversalLedgeIndex();
+
+	/**
+	* Find the closest ledge a horizontal ray crosses from the front.
+	* Can be called from worker threads.
+	*
+	* @param Origin Start of the ray.
+	* @param Direction Direction of the ray. Only X and Y are used.
+	* @param MaxDistance Length of the ray.
+	* @param MinZ Min Z of the ledge where the ray crosses it.
+	* @param MaxZ Max Z of the ledge where the ray crosses it.
+	* @param OutLedge Ledge that was found.
+	* @param OutDistance Distance from the origin to the ledge.
+	* @return Ledge was found.
+	*/
+	bool FindLedge(const FVector& Origin, const FVector& Direction, float MaxDistance, float MinZ, float MaxZ, FTraversalLedge& OutLedge, float& OutDistance) const;
+
+	/**
+	* Check if any baked ledge is within a distance of a location.
+	*
+	* @param Location Location to search around.
+	* @param Radius Max distance from the location to the ledge.
+	* @return A ledge is within the distance.
+	*/
+	bool HasLedgeNear(const FVector& Location, float Radius) const;
+
+	/**
+	* Get the bounds of all baked ledges.
+	*/
+	const FBox& GetLedgeBounds() const { return LedgeBounds; }
+
+	/**
+	* Get the number of baked ledges.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Ledge Index")
+	int32 GetNumLedges() const { return Ledges.Num(); }
+
+#if WITH_EDITOR
+	/**
+	* Scan the static collision inside the bounds and bake the ledges found on it.
+	* Box and convex collision is baked. Convex collision is approximated by its bounding box.
+	*/
+	UFUNCTION(CallInEditor, Category = "Ledge Index")
+	void Bake();
+#endif
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#if WITH_EDITOR
+	/**
+	* Measure an edge of an obstacle's top surface and add it as a ledge if it can be vaulted or mantled over.
+	*
+	* @param World World to trace in.
+	* @param Start Start of the edge.
+	* @param End End of the edge.
+	* @param Normal Horizontal normal of the face below the edge.
+	* @param Depth Depth of the top surface along the normal.
+	*/
+	void BakeEdge(UWorld* World, const FVector& Start, const FVector& End, const FVector& Normal, float Depth);
+#endif
+};
@@ -0,0 +1,125 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "TraversalComponent.h"
+#include "TraversalMovementComponent.generated.h"
+
+/**
+* Saved move that records the traversal mode the client was in, so the server simulates the move in the same mode and replays run in it.
+*/
+class TRAVERSALSYSTEM_API FSavedMove_Traversal : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	// Traversal mode requested for the move.
+	ETraversalState SavedTraversalMode = ETraversalState::None;
+
+	// Slide time left over from the previous move.
+	float SavedSlideTimeRemainder = 0.0f;
+};
+
+/**
+* Client prediction data that allocates FSavedMove_Traversal.
+*/
+class TRAVERSALSYSTEM_API FNetworkPredictionData_Client_Traversal : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Traversal(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+* Character movement component that runs vaults, mantles, slides and wall climbs as MOVE_Custom modes. The custom mode is the ETraversalState value, so custom modes 1 to 4 are reserved.
+* The requested traversal mode is packed into FLAG_Custom_0 to FLAG_Custom_2 of every saved move. The server enters and leaves the modes on the same moves as the client, so traversal is predicted instead of corrected.
+* Vault, mantle and wall climb move like flying. Vaults and mantles following baked root motion move along it instead. Slides move along the floor with the slide force, friction and braking of the traversal component.
+* Used by UTraversalComponent when the owning character is created with it. Without it, the traversal component falls back to flying and walking.
+*/
+UCLASS()
+class TRAVERSALSYSTEM_API UTraversalMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class UTraversalComponent;
+	friend class UTraversalBenchmarkCommandlet;
+
+protected:
+	// Traversal component of the owning character. Set by UTraversalComponent::Initialize.
+	UPROPERTY(Transient)
+	TObjectPtr<UTraversalComponent> TraversalComponent;
+
+	// Traversal mode requested by the local client, or by the client move being simulated on the server.
+	ETraversalState RequestedTraversalMode = ETraversalState::None;
+
+	// Whether rotation was oriented to movement before the wall climb started.
+	bool bWallClimbOrientedRotationToMovement = true;
+
+	// Slide time not integrated yet because it is shorter than a slide step. Carried over to the next update.
+	float SlideTimeRemainder = 0.0f;
+
+public:
+	/**
+	* Enter a traversal mode, or leave the current one for walking.
+	*
+	* @param Mode Vaulting, Mantling, Sliding or WallClimbing. None returns to walking.
+	*/
+	void SetTraversalMode(ETraversalState Mode);
+
+	/**
+	* Get the traversal mode the character is moving in.
+	*
+	* @return Current traversal mode, or None if not in one.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Traversal")
+	ETraversalState GetTraversalMode() const;
+
+	virtual float GetMaxSpeed() const override;
+	virtual float GetMaxBrakingDeceleration() const override;
+	virtual bool IsMovingOnGround() const override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+protected:
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void PhysCustom(float DeltaTime, int32 Iterations) override;
+
+	/**
+	* Whether a requested traversal mode can be entered. The server only enters vaults and mantles of remote clients whose plan it accepted, and wall climbs its own wall check confirms.
+	*
+	* @param Mode Requested mode.
+	* @return Mode can be entered.
+	*/
+	virtual bool CanEnterTraversalMode(ETraversalState Mode);
+
+	/**
+	* Move along the floor with the slide force applied, and return to walking once too slow or off the floor.
+	* The velocity is integrated in fixed steps of the traversal config's SlideSubstepTime. The floor is sampled once per update.
+	*
+	* @param DeltaTime Time to move for.
+	* @param Iterations Number of physics iterations this frame.
+	*/
+	void PhysSlide(float DeltaTime, int32 Iterations);
+
+	/**
+	* Move along the baked root motion of the vault or mantle in progress, and return to walking once the action ends or the capsule is blocked.
+	* The move is swept and slides along what it hits.
+	* Used on dedicated servers, which don't play the montages.
+	*
+	* @param DeltaTime Time to move for.
+	* @param Iterations Number of physics iterations this frame.
+	*/
+	void PhysBakedRootMotion(float DeltaTime, int32 Iterations);
+};
@@ -0,0 +1,62 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TraversalComponent.h"
+#include "TraversalReplayCommandlet.generated.h"
+
+class UCharacterMovementComponent;
+struct FTraversalCaptureTuning;
+struct FTraversalCheckCapture;
+
+/**
+* Replays traversal checks captured with traversal.Capture.Start, without a world. Each check is advanced with its captured hits instead of tracing, so only the decision code runs.
+* Reports the checks whose stages, queries or outcome differ from the capture, and the time spent replaying each kind of check.
+* The collision of the hit components isn't captured. The collision ledges and wall patches the checks found on it are captured with their steps and used instead.
+*
+* Usage: UnrealEditor-Cmd <Project> -run=TraversalReplay -nullrhi -Capture=<file> [-Repeat=100]
+*/
+UCLASS()
+class TRAVERSALSYSTEM_API UTraversalReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+protected:
+	// Replays of one kind of check.
+	struct FReplayResults
+	{
+		FString Name;
+
+		// Time of each replayed check, averaged over its repeats.
+		TArray<double> Times;
+
+		int32 NumMatched = 0;
+		int32 NumDiverged = 0;
+	};
+
+public:
+	UTraversalReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	/**
+	* Create a component outside of any world with a captured tuning.
+	*
+	* @param Tuning Captured tuning.
+	* @param Movement Movement component the component tests walkable hits with.
+	* @return The component, or nullptr if the captured component or config class can't be loaded.
+	*/
+	UTraversalComponent* CreateComponent(const FTraversalCaptureTuning& Tuning, UCharacterMovementComponent* Movement) const;
+
+	/**
+	* Whether a replayed check finished the same way as when it was captured.
+	*
+	* @param Capture Captured check.
+	* @param Check Replayed check.
+	* @return Both finished in the same stage with the same plan.
+	*/
+	bool DoesOutcomeMatch(const FTraversalCheckCapture& Capture, const FTraversalCheck& Check) const;
+};
@@ -0,0 +1,147 @@
+// Copyright 2023 devran. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "TraversalComponent.h"
+#include "TraversalWorldSubsystem.generated.h"
+
+class ATraversalLedgeIndex;
+class FTraversalWallGraph;
+
+/**
+* Collects the checks traversal components queue during a frame and evaluates them together once per frame.
+* The checks run in parallel under a single physics scene read lock and their results are handed back to each component on the game thread.
+* Also keeps track of the ledge indices that are currently streamed in, and of the wall graphs of the primitives that have been climbed.
+* Updates the significance manager with the views of the local players every frame, which picks the LOD level of the traversal components.
+* Disable traversal.Significance.Update if the game already updates the significance manager itself.
+*/
+UCLASS()
+class TRAVERSALSYSTEM_API UTraversalWorldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	// Check waiting to be evaluated with the next batch.
+	struct FPendingCheck
+	{
+		TWeakObjectPtr<UTraversalComponent> Component;
+		FTraversalCheck Check;
+	};
+
+	// Checks queued since the last batch.
+	TArray<FPendingCheck> PendingChecks;
+
+	// Checks of the batch being evaluated. Swapped with PendingChecks every frame so neither buffer is reallocated.
+	TArray<FPendingCheck> BatchChecks;
+
+	// Components of the batch being evaluated, resolved on the game thread.
+	TArray<UTraversalComponent*> BatchComponents;
+
+	// Number of checks evaluated in the last batch.
+	int32 LastBatchSize = 0;
+
+	// Wall time in milliseconds the last batch took, including dispatching the results.
+	float LastBatchTime = 0.0f;
+
+	// Ledge indices that have begun play.
+	TArray<TWeakObjectPtr<ATraversalLedgeIndex>> LedgeIndices;
+
+	// Wall graph of each primitive that has been climbed.
+	TMap<TObjectKey<UPrimitiveComponent>, TSharedPtr<const FTraversalWallGraph>> WallGraphs;
+
+	// Views of the local players the significance manager was last updated with. Kept so updating doesn't allocate.
+	TArray<FTransform> Viewpoints;
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	* Queue a check to be evaluated with the next batch. The result is passed to the component's OnBatchedCheckCompleted.
+	*
+	* @param Component Component that owns the check.
+	* @param Check Check positioned at its first stage.
+	*/
+	void EnqueueCheck(UTraversalComponent* Component, const FTraversalCheck& Check);
+
+	/**
+	* Remove all queued checks of a component.
+	*
+	* @param Component Component whose checks should be removed.
+	*/
+	void CancelChecks(const UTraversalComponent* Component);
+
+	/**
+	* Make the ledges of an index available to FindLedge.
+	*
+	* @param LedgeIndex Index that began play.
+	*/
+	void RegisterLedgeIndex(ATraversalLedgeIndex* LedgeIndex);
+
+	/**
+	* Remove the ledges of an index from FindLedge.
+	*
+	* @param LedgeIndex Index that ended play.
+	*/
+	void UnregisterLedgeIndex(ATraversalLedgeIndex* LedgeIndex);
+
+	/**
+	* Find the closest baked ledge a horizontal ray crosses from the front, across all registered ledge indices.
+	* Can be called from worker threads.
+	*
+	* @param Origin Start of the ray.
+	* @param Direction Direction of the ray. Only X and Y are used.
+	* @param MaxDistance Length of the ray.
+	* @param MinZ Min Z of the ledge where the ray crosses it.
+	* @param MaxZ Max Z of the ledge where the ray crosses it.
+	* @param OutLedge Ledge that was found.
+	* @param OutDistance Distance from the origin to the ledge.
+	* @return Ledge was found.
+	*/
+	bool FindLedge(const FVector& Origin, const FVector& Direction, float MaxDistance, float MinZ, float MaxZ, FTraversalLedge& OutLedge, float& OutDistance) const;
+
+	/**
+	* Check if any baked ledge of the registered ledge indices is within a distance of a location.
+	*
+	* @param Location Location to search around.
+	* @param Radius Max distance from the location to the ledge.
+	* @return A ledge is within the distance.
+	*/
+	bool HasLedgeNear(const FVector& Location, float Radius) const;
+
+	/**
+	* Get the graph of the faces and corners of a primitive's box collision. Built the first time it is requested, and again once the primitive has moved.
+	*
+	* @param Primitive Primitive being climbed.
+	* @return Graph of the primitive. Has no faces if the primitive has no exact box collision.
+	*/
+	TSharedPtr<const FTraversalWallGraph> GetWallGraph(const UPrimitiveComponent* Primitive);
+
+	/**
+	* Check if any ledge index is registered.
+	*/
+	bool HasLedgeIndices() const { return !LedgeIndices.IsEmpty(); }
+
+	/**
+	* Get the number of checks evaluated in the last batch.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal")
+	int32 GetLastBatchSize() const { return LastBatchSize; }
+
+	/**
+	* Get the wall time in milliseconds the last batch took.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Traversal")
+	float GetLastBatchTime() const { return LastBatchTime; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/**
+	* Update the significance manager with the views of the local players. Does nothing on dedicated servers, which have none.
+	*/
+	void UpdateSignificance();
+};
@@ -39,6 +39,7 @@ public class TraversalSystem : ModuleRules
 				"Slate",
 				"SlateCore",
 				"MotionWarping",
+				"SignificanceManager",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);